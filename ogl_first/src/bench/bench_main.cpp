@@ -0,0 +1,241 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// headless physics benchmark, runs without a window or a GL context -->
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "bench/scenarios.h"
+#include "core/asset_archive.h"
+#include "core/job_system.h"
+#include "core/stopwatch.h"
+#include "physics/body_archive.h"
+#include "physics/integrator.h"
+#include "physics/world.h"
+
+namespace {
+
+	struct BenchOptions {
+		const char* scenario = "all";
+		int steps = 600;
+		std::size_t scale = 0;	// 0 keeps the default of the scenario
+		int threads = 0;		// 0 uses every core
+		bool broadphaseSet = false;
+		psix::BroadphaseType broadphase = psix::BroadphaseType::HashGrid;
+		const char* scene = nullptr;	// archive the built bodies are written to and loaded back from
+	};
+
+	struct PhaseSamples {
+		const char* name;
+		std::vector<double> samples;
+	};
+
+	void printUsage() {
+		std::printf("usage: psix_bench [scenario|all] [--steps N] [--scale N] [--threads N] [--broadphase grid|sap|tree] [--scene file] [--list]\n");
+	}
+
+	void printScenarios() {
+		for (std::size_t i = 0; i < psix::scenarioCount(); i++) {
+			const psix::Scenario& scenario = psix::scenarioList()[i];
+			std::printf("  %-14s %s (scale %zu)\n", scenario.name, scenario.description, scenario.defaultScale);
+		}
+	}
+
+	bool parseBroadphase(const char* text, psix::BroadphaseType& type) {
+		if (std::strcmp(text, "grid") == 0) {
+			type = psix::BroadphaseType::HashGrid;
+		}
+		else if (std::strcmp(text, "sap") == 0) {
+			type = psix::BroadphaseType::SweepAndPrune;
+		}
+		else if (std::strcmp(text, "tree") == 0) {
+			type = psix::BroadphaseType::AabbTree;
+		}
+		else {
+			return false;
+		}
+		return true;
+	}
+
+	// returns false (after printing why) when the arguments are not usable
+	bool parseOptions(int argc, char** argv, BenchOptions& options) {
+		for (int i = 1; i < argc; i++) {
+			const char* arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+			if (std::strcmp(arg, "--list") == 0) {
+				printScenarios();
+				std::exit(0);
+			}
+			else if (std::strcmp(arg, "--steps") == 0 && hasValue) {
+				options.steps = std::atoi(argv[++i]);
+			}
+			else if (std::strcmp(arg, "--scale") == 0 && hasValue) {
+				options.scale = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+			}
+			else if (std::strcmp(arg, "--threads") == 0 && hasValue) {
+				options.threads = std::atoi(argv[++i]);
+			}
+			else if (std::strcmp(arg, "--broadphase") == 0 && hasValue) {
+				if (!parseBroadphase(argv[++i], options.broadphase)) {
+					std::fprintf(stderr, "unknown broadphase %s\n", argv[i]);
+					return false;
+				}
+				options.broadphaseSet = true;
+			}
+			else if (std::strcmp(arg, "--scene") == 0 && hasValue) {
+				options.scene = argv[++i];
+			}
+			else if (arg[0] != '-') {
+				options.scenario = arg;
+			}
+			else {
+				printUsage();
+				return false;
+			}
+		}
+		if (options.steps <= 0) {
+			std::fprintf(stderr, "--steps has to be positive\n");
+			return false;
+		}
+		return true;
+	}
+
+	// value below which the given fraction of the sorted samples lies
+	double percentile(const std::vector<double>& sorted, double fraction) {
+		std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+		return sorted[std::min(index, sorted.size() - 1)];
+	}
+
+	// fnv-1a over the final positions, equal runs give equal checksums
+	std::uint64_t positionChecksum(const psix::BodyStore& bodies) {
+		std::uint64_t hash = 1469598103934665603ull;
+		for (std::size_t i = 0; i < bodies.size(); i++) {
+			std::uint32_t bits[2];
+			std::memcpy(&bits[0], &bodies.positionX[i], sizeof(float));
+			std::memcpy(&bits[1], &bodies.positionY[i], sizeof(float));
+			for (std::uint32_t word : bits) {
+				hash = (hash ^ word) * 1099511628211ull;
+			}
+		}
+		return hash;
+	}
+
+	// writes the bodies of the world to an archive and times mapping it and
+	// creating the same bodies in a fresh world from it
+	void measureSceneArchive(const psix::World& built, const psix::WorldSettings& settings, const char* path) {
+		psix::Stopwatch writeWatch;
+		psix::ArchiveWriter writer;
+		if (!psix::addBodySections(writer, built.bodies()) || !writer.write(path)) {
+			std::printf("  scene: can not write %s\n", path);
+			return;
+		}
+		const double writeMs = writeWatch.elapsedMs();
+		psix::Stopwatch loadWatch;
+		psix::AssetArchive archive;
+		if (!archive.open(path)) {
+			std::printf("  scene: %s\n", archive.error().c_str());
+			return;
+		}
+		const double mapMs = loadWatch.elapsedMs();
+		psix::BodyColumns columns;
+		std::size_t count = 0;
+		if (!psix::bodyColumns(archive, columns, count)) {
+			std::printf("  scene: no bodies in %s\n", path);
+			return;
+		}
+		psix::World loaded(settings);
+		loaded.createBodies(columns, count);
+		const double loadMs = loadWatch.elapsedMs();
+		const bool same = positionChecksum(loaded.bodies()) == positionChecksum(built.bodies());
+		std::printf("  scene: %.1f MB, write %.1f ms, map %.3f ms, load %zu bodies %.1f ms%s\n",
+			static_cast<double>(archive.size()) / (1024.0 * 1024.0), writeMs, mapMs, count, loadMs, same ? "" : ", positions differ");
+	}
+
+	void runScenario(const psix::Scenario& scenario, const BenchOptions& options, psix::JobSystem* jobs) {
+		psix::WorldSettings settings;
+		settings.gravity = psix::Vec2(0.0f, -9.81f);
+		scenario.configure(settings);
+		if (options.broadphaseSet) {
+			settings.broadphase.type = options.broadphase;
+		}
+		const std::size_t scale = options.scale > 0 ? options.scale : scenario.defaultScale;
+		psix::World world(settings);
+		if (jobs != nullptr) {
+			world.setJobSystem(jobs);
+		}
+		psix::Stopwatch buildWatch;
+		scenario.build(world, scale);
+		const double buildMs = buildWatch.elapsedMs();
+		std::printf("%s: %zu bodies, %zu constraints, %d steps, %s, %s solver, %d threads, %s integrator (build %.1f ms)\n",
+			scenario.name, world.bodies().size(), world.constraintSolver().constraintCount(), options.steps,
+			world.activeBroadphase().name(), settings.solver == psix::SolverType::Xpbd ? "xpbd" : "impulse",
+			jobs != nullptr ? jobs->workerCount() : 1, psix::integratorPathName(psix::activeIntegratorPath()), buildMs);
+		if (options.scene != nullptr) {
+			measureSceneArchive(world, settings, options.scene);
+		}
+		PhaseSamples phases[] = {
+			{ "broadphase", {} }, { "narrowphase", {} }, { "solve", {} }, { "integrate", {} }, { "step", {} }
+		};
+		for (PhaseSamples& phase : phases) {
+			phase.samples.reserve(static_cast<std::size_t>(options.steps));
+		}
+		// a fixed dt, the benchmark must not depend on the wall clock
+		const float dt = static_cast<float>(settings.stepper.fixedDt);
+		std::size_t manifolds = 0;
+		std::size_t awake = 0;
+		for (int i = 0; i < options.steps; i++) {
+			psix::Stopwatch stepWatch;
+			world.step(dt);
+			const double stepMs = stepWatch.elapsedMs();
+			const psix::StepTimings& timings = world.lastStepStats().timings;
+			phases[0].samples.push_back(timings.broadphase);
+			phases[1].samples.push_back(timings.narrowphase);
+			phases[2].samples.push_back(timings.solve);
+			phases[3].samples.push_back(timings.integrate);
+			phases[4].samples.push_back(stepMs);
+			manifolds += world.lastStepStats().manifolds;
+			awake += world.lastStepStats().awakeBodies;
+		}
+		std::printf("  %-12s %10s %10s %10s %10s\n", "phase (ms)", "min", "median", "p99", "total");
+		for (PhaseSamples& phase : phases) {
+			double total = 0.0;
+			for (double sample : phase.samples) {
+				total += sample;
+			}
+			std::sort(phase.samples.begin(), phase.samples.end());
+			std::printf("  %-12s %10.3f %10.3f %10.3f %10.1f\n", phase.name, phase.samples.front(), percentile(phase.samples, 0.5), percentile(phase.samples, 0.99), total);
+		}
+		std::printf("  contacts/step %zu, awake/step %zu, checksum %016llx\n\n",
+			manifolds / static_cast<std::size_t>(options.steps), awake / static_cast<std::size_t>(options.steps),
+			static_cast<unsigned long long>(positionChecksum(world.bodies())));
+	}
+
+}
+
+int main(int argc, char** argv) {
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		return 1;
+	}
+	std::unique_ptr<psix::JobSystem> jobs;
+	if (options.threads != 1) {
+		jobs.reset(new psix::JobSystem(options.threads > 1 ? options.threads - 1 : -1));
+	}
+	if (std::strcmp(options.scenario, "all") == 0) {
+		for (std::size_t i = 0; i < psix::scenarioCount(); i++) {
+			runScenario(psix::scenarioList()[i], options, jobs.get());
+		}
+		return 0;
+	}
+	const psix::Scenario* scenario = psix::findScenario(options.scenario);
+	if (scenario == nullptr) {
+		std::fprintf(stderr, "unknown scenario %s, available:\n", options.scenario);
+		printScenarios();
+		return 1;
+	}
+	runScenario(*scenario, options, jobs.get());
+	return 0;
+}
@@ -0,0 +1,149 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// deterministic benchmark scenarios for the headless benchmark -->
+
+#include "bench/scenarios.h"
+#include <cmath>
+#include <cstring>
+
+namespace psix {
+
+	// open container: floor and two walls, inner width and height
+	static void addContainer(World& world, float width, float height) {
+		const float half = width * 0.5f;
+		world.addStaticBox(Aabb(Vec2(-half - 1.0f, -1.0f), Vec2(half + 1.0f, 0.0f)));
+		world.addStaticBox(Aabb(Vec2(-half - 1.0f, 0.0f), Vec2(-half, height)));
+		world.addStaticBox(Aabb(Vec2(half, 0.0f), Vec2(half + 1.0f, height)));
+	}
+
+	// falling pile: bodies of mixed sizes dropped in a loose grid into a container
+
+	static void configurePile(WorldSettings& settings) {
+		settings.solver = SolverType::SequentialImpulse;
+	}
+
+	static void buildPile(World& world, std::size_t scale) {
+		BenchRandom random(0x9e3779b9u);
+		const float width = 12.0f;
+		const float spacing = 0.18f;
+		const std::size_t columns = static_cast<std::size_t>(width / spacing) - 1;
+		world.bodies().reserve(scale);
+		addContainer(world, width, 1000.0f);
+		for (std::size_t i = 0; i < scale; i++) {
+			BodyDesc body;
+			body.radius = random.range(0.04f, 0.08f);
+			body.inverseMass = 1.0f / (body.radius * body.radius * 400.0f);
+			float x = -width * 0.5f + spacing * static_cast<float>(i % columns + 1);
+			float y = 0.5f + spacing * static_cast<float>(i / columns);
+			body.position = Vec2(x + random.range(-0.01f, 0.01f), y);
+			body.friction = 0.5f;
+			world.createBody(body);
+		}
+	}
+
+	// dense particle box: small equal particles packed into a closed box with random velocities
+
+	static void configureParticleBox(WorldSettings& settings) {
+		settings.solver = SolverType::SequentialImpulse;
+		settings.broadphase.type = BroadphaseType::HashGrid;
+		settings.sleep.enabled = false;
+	}
+
+	static void buildParticleBox(World& world, std::size_t scale) {
+		BenchRandom random(0x85ebca6bu);
+		const float radius = 0.02f;
+		const float spacing = 2.2f * radius;
+		// roughly square block filling the lower half of the box
+		const std::size_t columns = static_cast<std::size_t>(std::sqrt(static_cast<float>(scale))) + 1;
+		const float width = spacing * static_cast<float>(columns) * 1.5f;
+		addContainer(world, width, width * 2.0f);
+		world.addStaticBox(Aabb(Vec2(-width, width * 2.0f), Vec2(width, width * 2.0f + 1.0f)));
+		world.bodies().reserve(scale);
+		for (std::size_t i = 0; i < scale; i++) {
+			BodyDesc body;
+			body.radius = radius;
+			float x = -width * 0.5f + spacing * static_cast<float>(i % columns + 1);
+			float y = spacing * static_cast<float>(i / columns + 1);
+			body.position = Vec2(x, y);
+			body.velocity = Vec2(random.range(-1.0f, 1.0f), random.range(-1.0f, 1.0f));
+			body.restitution = 0.5f;
+			body.friction = 0.1f;
+			world.createBody(body);
+		}
+	}
+
+	// ragdoll stack: chains of particles held by distance and bending constraints, stacked in columns
+
+	static void configureRagdolls(WorldSettings& settings) {
+		settings.solver = SolverType::Xpbd;
+		settings.broadphase.type = BroadphaseType::AabbTree;
+	}
+
+	static void buildRagdolls(World& world, std::size_t scale) {
+		// joints of one ragdoll, standing on y = 0
+		static const Vec2 joints[] = {
+			Vec2(0.0f, 1.65f),								// head
+			Vec2(0.0f, 1.45f),								// neck
+			Vec2(-0.2f, 1.4f), Vec2(0.2f, 1.4f),			// shoulders
+			Vec2(-0.45f, 1.4f), Vec2(0.45f, 1.4f),			// elbows
+			Vec2(-0.7f, 1.4f), Vec2(0.7f, 1.4f),			// hands
+			Vec2(-0.12f, 0.9f), Vec2(0.12f, 0.9f),			// hips
+			Vec2(-0.12f, 0.5f), Vec2(0.12f, 0.5f),			// knees
+			Vec2(-0.12f, 0.08f), Vec2(0.12f, 0.08f)		// feet
+		};
+		static const int bones[][2] = {
+			{ 0, 1 }, { 1, 2 }, { 1, 3 }, { 2, 3 }, { 2, 4 }, { 4, 6 }, { 3, 5 }, { 5, 7 },
+			{ 1, 8 }, { 1, 9 }, { 8, 9 }, { 2, 8 }, { 3, 9 }, { 8, 10 }, { 10, 12 }, { 9, 11 }, { 11, 13 }
+		};
+		static const int limbs[][3] = { { 2, 4, 6 }, { 3, 5, 7 }, { 8, 10, 12 }, { 9, 11, 13 } };
+		const std::size_t jointCount = sizeof(joints) / sizeof(joints[0]);
+		const float size = 0.6f;
+		const std::size_t columns = 20;
+		const float width = static_cast<float>(columns) * 1.0f + 2.0f;
+		addContainer(world, width, 1000.0f);
+		world.bodies().reserve(scale * jointCount);
+		BenchRandom random(0xc2b2ae35u);
+		for (std::size_t r = 0; r < scale; r++) {
+			Vec2 origin(-width * 0.5f + 1.5f + static_cast<float>(r % columns) * 1.0f + random.range(-0.05f, 0.05f),
+				0.05f + static_cast<float>(r / columns) * 1.15f);
+			BodyId ids[jointCount];
+			for (std::size_t j = 0; j < jointCount; j++) {
+				BodyDesc body;
+				body.position = origin + joints[j] * size;
+				body.radius = 0.045f;
+				body.friction = 0.6f;
+				ids[j] = world.createBody(body);
+			}
+			for (const auto& bone : bones) {
+				world.addDistanceConstraint(ids[bone[0]], ids[bone[1]]);
+			}
+			for (const auto& limb : limbs) {
+				world.addBendingConstraint(ids[limb[0]], ids[limb[1]], ids[limb[2]], 1e-4f);
+			}
+		}
+	}
+
+	static const Scenario scenarios[] = {
+		{ "falling_pile", "mixed size bodies dropped into a container", 8000, configurePile, buildPile },
+		{ "particle_box", "dense equal particles bouncing in a closed box", 20000, configureParticleBox, buildParticleBox },
+		{ "ragdoll_stack", "xpbd ragdolls stacked in columns", 200, configureRagdolls, buildRagdolls }
+	};
+
+	const Scenario* scenarioList() {
+		return scenarios;
+	}
+
+	std::size_t scenarioCount() {
+		return sizeof(scenarios) / sizeof(scenarios[0]);
+	}
+
+	const Scenario* findScenario(const char* name) {
+		for (const Scenario& scenario : scenarios) {
+			if (std::strcmp(scenario.name, name) == 0) {
+				return &scenario;
+			}
+		}
+		return nullptr;
+	}
+
+}
@@ -0,0 +1,46 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// deterministic benchmark scenarios for the headless benchmark -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "physics/world.h"
+
+namespace psix {
+
+	// a scenario sets up a world the same way on every run and platform, the
+	// scale is the number of bodies (or ragdolls) it creates
+
+	struct Scenario {
+		const char* name;
+		const char* description;
+		std::size_t defaultScale;
+		void (*configure)(WorldSettings& settings);
+		void (*build)(World& world, std::size_t scale);
+	};
+
+	const Scenario* scenarioList();
+	std::size_t scenarioCount();
+	// nullptr when there is no scenario with that name
+	const Scenario* findScenario(const char* name);
+
+	// xorshift, the standard distributions differ between library implementations
+	class BenchRandom {
+	public:
+		explicit BenchRandom(std::uint32_t seed) : state(seed != 0 ? seed : 1u) {}
+		std::uint32_t next() {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+		float range(float low, float high) {
+			return low + (high - low) * static_cast<float>(next() >> 8) * (1.0f / 16777216.0f);
+		}
+	private:
+		std::uint32_t state;
+	};
+
+}
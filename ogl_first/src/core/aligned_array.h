@@ -0,0 +1,139 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// growable array of trivially copyable values with cache line aligned storage -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace psix {
+
+	// alignment of every aligned array, one cache line (covers 32 byte AVX loads)
+	constexpr std::size_t SIMD_ALIGNMENT = 64;
+
+	inline void* alignedAlloc(std::size_t bytes) {
+		if (bytes == 0) {
+			return nullptr;
+		}
+#if defined(_MSC_VER)
+		void* memory = _aligned_malloc(bytes, SIMD_ALIGNMENT);
+#else
+		void* memory = nullptr;
+		if (posix_memalign(&memory, SIMD_ALIGNMENT, bytes) != 0) {
+			memory = nullptr;
+		}
+#endif
+		if (memory == nullptr) {
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+
+	inline void alignedFree(void* memory) {
+#if defined(_MSC_VER)
+		_aligned_free(memory);
+#else
+		free(memory);
+#endif
+	}
+
+	// capacity is always rounded to a multiple of 16 elements, so SIMD kernels
+	// can safely read whole lanes past the end of the live range
+
+	template <typename T>
+	class AlignedArray {
+		static_assert(std::is_trivially_copyable<T>::value, "AlignedArray only holds trivially copyable types");
+	public:
+		AlignedArray() = default;
+		~AlignedArray() { alignedFree(items); }
+		AlignedArray(const AlignedArray& other) { *this = other; }
+		AlignedArray& operator=(const AlignedArray& other) {
+			if (this != &other) {
+				resize(other.count);
+				if (other.count > 0) {
+					std::memcpy(items, other.items, other.count * sizeof(T));
+				}
+			}
+			return *this;
+		}
+		AlignedArray(AlignedArray&& other) noexcept { swap(other); }
+		AlignedArray& operator=(AlignedArray&& other) noexcept {
+			swap(other);
+			return *this;
+		}
+		void swap(AlignedArray& other) noexcept {
+			std::swap(items, other.items);
+			std::swap(count, other.count);
+			std::swap(capacity, other.capacity);
+		}
+		void reserve(std::size_t newCapacity) {
+			if (newCapacity <= capacity) {
+				return;
+			}
+			reallocate(newCapacity, count);
+		}
+		void resize(std::size_t newCount) {
+			if (newCount > capacity) {
+				reserve(newCount > capacity * 2 ? newCount : capacity * 2);
+			}
+			if (newCount > count) {
+				std::memset(static_cast<void*>(items + count), 0, (newCount - count) * sizeof(T));
+			}
+			count = newCount;
+		}
+		// copies count values to the end in one go
+		void append(const T* values, std::size_t valueCount) {
+			if (count + valueCount > capacity) {
+				// the appended range is written right after, only the rest is zeroed
+				reallocate(count + valueCount > capacity * 2 ? count + valueCount : capacity * 2, count + valueCount);
+			}
+			if (valueCount > 0) {
+				std::memcpy(static_cast<void*>(items + count), values, valueCount * sizeof(T));
+			}
+			count += valueCount;
+		}
+		void push_back(const T& value) {
+			if (count == capacity) {
+				reserve(capacity == 0 ? 16 : capacity * 2);
+			}
+			items[count++] = value;
+		}
+		void pop_back() { count--; }
+		void clear() { count = 0; }
+		T* data() { return items; }
+		const T* data() const { return items; }
+		std::size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		T& operator[](std::size_t index) { return items[index]; }
+		const T& operator[](std::size_t index) const { return items[index]; }
+		T& back() { return items[count - 1]; }
+		T* begin() { return items; }
+		T* end() { return items + count; }
+		const T* begin() const { return items; }
+		const T* end() const { return items + count; }
+	private:
+		// keeps the live elements and zeroes everything from zeroFrom on, so
+		// SIMD tails never read garbage
+		void reallocate(std::size_t newCapacity, std::size_t zeroFrom) {
+			newCapacity = (newCapacity + 15) & ~static_cast<std::size_t>(15);
+			T* newItems = static_cast<T*>(alignedAlloc(newCapacity * sizeof(T)));
+			if (count > 0) {
+				std::memcpy(static_cast<void*>(newItems), items, count * sizeof(T));
+			}
+			std::memset(static_cast<void*>(newItems + zeroFrom), 0, (newCapacity - zeroFrom) * sizeof(T));
+			alignedFree(items);
+			items = newItems;
+			capacity = newCapacity;
+		}
+
+		T* items = nullptr;
+		std::size_t count = 0;
+		std::size_t capacity = 0;
+	};
+
+}
@@ -0,0 +1,157 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// memory mapped archive of named arrays that are used in place, without parsing -->
+
+#include "core/asset_archive.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "core/hash.h"
+
+namespace psix {
+
+	namespace {
+
+		std::uint64_t alignOffset(std::uint64_t offset) {
+			return (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+		}
+
+	}
+
+	bool AssetArchive::open(const std::string& path) {
+		close();
+		if (!file.open(path)) {
+			return fail(file.error());
+		}
+		const std::size_t fileSize = file.size();
+		if (fileSize < sizeof(ArchiveHeader)) {
+			return fail("not an archive " + path);
+		}
+		ArchiveHeader header;
+		std::memcpy(&header, file.data(), sizeof(header));
+		if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION || header.alignment != ARCHIVE_ALIGNMENT) {
+			return fail("not an archive or an other version " + path);
+		}
+		if (header.fileSize != fileSize) {
+			return fail("truncated archive " + path);
+		}
+		if (header.sectionCount > (fileSize - sizeof(ArchiveHeader)) / sizeof(ArchiveSection)) {
+			return fail("broken section table in " + path);
+		}
+		// the table follows the 32 byte header, the mapping is page aligned
+		const ArchiveSection* table = reinterpret_cast<const ArchiveSection*>(file.data() + sizeof(ArchiveHeader));
+		for (std::uint32_t i = 0; i < header.sectionCount; i++) {
+			const ArchiveSection& entry = table[i];
+			const bool named = std::memchr(entry.name, '\0', ARCHIVE_NAME_LENGTH) != nullptr;
+			const bool sorted = i == 0 || table[i - 1].nameHash < entry.nameHash;
+			// no overflow, the element count is checked against the file size first
+			const bool inside = entry.offset % ARCHIVE_ALIGNMENT == 0 && entry.offset <= fileSize && entry.elementSize > 0
+				&& entry.count <= (fileSize - entry.offset) / entry.elementSize;
+			if (!named || !sorted || !inside || entry.nameHash != hashString(entry.name)) {
+				return fail("broken section " + std::to_string(i) + " in " + path);
+			}
+		}
+		sections = table;
+		sectionTotal = header.sectionCount;
+		errorText.clear();
+		return true;
+	}
+
+	void AssetArchive::close() {
+		file.close();
+		sections = nullptr;
+		sectionTotal = 0;
+	}
+
+	bool AssetArchive::fail(const std::string& text) {
+		close();
+		errorText = text;
+		return false;
+	}
+
+	const ArchiveSection* AssetArchive::find(const char* name) const {
+		const std::uint64_t hash = hashString(name);
+		const ArchiveSection* end = sections + sectionTotal;
+		const ArchiveSection* found = std::lower_bound(sections, end, hash,
+			[](const ArchiveSection& section, std::uint64_t key) { return section.nameHash < key; });
+		if (found == end || found->nameHash != hash || std::strcmp(found->name, name) != 0) {
+			return nullptr;
+		}
+		return found;
+	}
+
+	void AssetArchive::prefetch(const ArchiveSection& section) const {
+		file.prefetch(static_cast<std::size_t>(section.offset), static_cast<std::size_t>(section.count * section.elementSize));
+	}
+
+	bool ArchiveWriter::add(const std::string& name, const void* data, std::size_t elementSize, std::size_t count) {
+		if (name.empty() || name.size() >= ARCHIVE_NAME_LENGTH || elementSize == 0 || (data == nullptr && count > 0)) {
+			return false;
+		}
+		const std::uint64_t hash = hashString(name);
+		for (const PendingSection& section : pending) {
+			// equal hashes would make the lookup ambiguous
+			if (hashString(section.name) == hash) {
+				return false;
+			}
+		}
+		pending.push_back(PendingSection{ name, data, elementSize, count });
+		return true;
+	}
+
+	bool ArchiveWriter::write(const std::string& path) const {
+		std::vector<ArchiveSection> table(pending.size());
+		std::vector<const PendingSection*> order;
+		for (const PendingSection& section : pending) {
+			order.push_back(&section);
+		}
+		std::sort(order.begin(), order.end(),
+			[](const PendingSection* a, const PendingSection* b) { return hashString(a->name) < hashString(b->name); });
+		std::uint64_t offset = alignOffset(sizeof(ArchiveHeader) + table.size() * sizeof(ArchiveSection));
+		for (std::size_t i = 0; i < order.size(); i++) {
+			ArchiveSection& entry = table[i];
+			std::memset(&entry, 0, sizeof(entry));
+			entry.nameHash = hashString(order[i]->name);
+			entry.offset = offset;
+			entry.count = order[i]->count;
+			entry.elementSize = static_cast<std::uint32_t>(order[i]->elementSize);
+			std::memcpy(entry.name, order[i]->name.c_str(), order[i]->name.size());
+			offset = alignOffset(offset + entry.count * entry.elementSize);
+		}
+		ArchiveHeader header = { ARCHIVE_MAGIC, ARCHIVE_VERSION, static_cast<std::uint32_t>(table.size()),
+			static_cast<std::uint32_t>(ARCHIVE_ALIGNMENT), offset, 0 };
+		const std::string temporary = path + ".tmp";
+		{
+			std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+			if (!stream.is_open()) {
+				return false;
+			}
+			const char padding[ARCHIVE_ALIGNMENT] = {};
+			stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			stream.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(ArchiveSection)));
+			std::uint64_t written = sizeof(header) + table.size() * sizeof(ArchiveSection);
+			for (std::size_t i = 0; i < order.size(); i++) {
+				stream.write(padding, static_cast<std::streamsize>(table[i].offset - written));
+				const std::uint64_t bytes = table[i].count * table[i].elementSize;
+				stream.write(static_cast<const char*>(order[i]->data), static_cast<std::streamsize>(bytes));
+				written = table[i].offset + bytes;
+			}
+			stream.write(padding, static_cast<std::streamsize>(offset - written));
+			if (!stream) {
+				stream.close();
+				std::error_code error;
+				std::filesystem::remove(temporary, error);
+				return false;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(temporary, path, error);
+		if (error) {
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+		return true;
+	}
+
+}
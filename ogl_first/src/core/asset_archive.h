@@ -0,0 +1,127 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// memory mapped archive of named arrays that are used in place, without parsing -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/mapped_file.h"
+
+namespace psix {
+
+	// layout on disk, little endian:
+	//   ArchiveHeader
+	//   ArchiveSection[sectionCount], sorted by nameHash
+	//   section data, every section starts ARCHIVE_ALIGNMENT aligned
+	// everything is addressed by offsets from the start of the file, a mapped
+	// archive needs no fix-ups
+
+	constexpr std::uint32_t ARCHIVE_MAGIC = 0x41585350;	// "PSXA"
+	constexpr std::uint32_t ARCHIVE_VERSION = 1;
+	// one cache line, the same as AlignedArray, so the arrays can be streamed
+	// by the simd kernels and uploaded as they are
+	constexpr std::size_t ARCHIVE_ALIGNMENT = 64;
+	constexpr std::size_t ARCHIVE_NAME_LENGTH = 56;
+
+	struct ArchiveHeader {
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t sectionCount;
+		std::uint32_t alignment;
+		std::uint64_t fileSize;
+		std::uint64_t reserved;
+	};
+
+	struct ArchiveSection {
+		std::uint64_t nameHash;		// hashString() of the name
+		std::uint64_t offset;
+		std::uint64_t count;		// elements
+		std::uint32_t elementSize;	// bytes of one element, checked against the type read
+		std::uint32_t reserved;
+		char name[ARCHIVE_NAME_LENGTH];	// 0 terminated
+	};
+
+	static_assert(sizeof(ArchiveHeader) == 32, "archive header layout");
+	static_assert(sizeof(ArchiveSection) == 88, "archive section layout");
+
+	// elements of one section, pointing into the mapping
+	template <typename T>
+	struct ArchiveArray {
+		const T* data = nullptr;
+		std::size_t count = 0;
+		explicit operator bool() const { return data != nullptr; }
+		std::size_t bytes() const { return count * sizeof(T); }
+		const T& operator[](std::size_t index) const { return data[index]; }
+		const T* begin() const { return data; }
+		const T* end() const { return data + count; }
+	};
+
+	// open() maps the file and checks the header and the section table, the
+	// data is not touched, it is paged in when it is first read. the arrays
+	// point into the mapping and can go straight to glBufferData or a memcpy
+	// into the body store, they stay valid until close()
+
+	class AssetArchive {
+	public:
+		// false when the file can not be mapped or is not a valid archive
+		bool open(const std::string& path);
+		void close();
+		bool isOpen() const { return file.isOpen(); }
+		std::size_t sectionCount() const { return sectionTotal; }
+		const ArchiveSection& section(std::size_t index) const { return sections[index]; }
+		// null when there is no section with that name
+		const ArchiveSection* find(const char* name) const;
+		const void* data(const ArchiveSection& section) const { return file.data() + section.offset; }
+		// an empty array when the section is missing or its elements are not T sized
+		template <typename T>
+		ArchiveArray<T> array(const char* name) const {
+			ArchiveArray<T> result;
+			const ArchiveSection* found = find(name);
+			if (found != nullptr && found->elementSize == sizeof(T)) {
+				result.data = static_cast<const T*>(data(*found));
+				result.count = static_cast<std::size_t>(found->count);
+			}
+			return result;
+		}
+		// reads the section ahead of use, see MappedFile::prefetch
+		void prefetch(const ArchiveSection& section) const;
+		std::size_t size() const { return file.size(); }
+		const std::string& error() const { return errorText; }
+	private:
+		bool fail(const std::string& text);
+
+		MappedFile file;
+		const ArchiveSection* sections = nullptr;
+		std::size_t sectionTotal = 0;
+		std::string errorText;
+	};
+
+	// collects arrays and writes them as one archive. add() keeps the pointer,
+	// the data has to stay alive until write() returns
+
+	class ArchiveWriter {
+	public:
+		// false when the name is too long or already added
+		bool add(const std::string& name, const void* data, std::size_t elementSize, std::size_t count);
+		template <typename T>
+		bool add(const std::string& name, const T* data, std::size_t count) {
+			return add(name, data, sizeof(T), count);
+		}
+		// written next to the final name and renamed, readers never map half an archive
+		bool write(const std::string& path) const;
+		void clear() { pending.clear(); }
+	private:
+		struct PendingSection {
+			std::string name;
+			const void* data;
+			std::size_t elementSize;
+			std::size_t count;
+		};
+
+		std::vector<PendingSection> pending;
+	};
+
+}
@@ -0,0 +1,93 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// assets embedded in the executable, looked up through a hashed table at compile time -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "core/hash.h"
+
+namespace psix {
+
+	struct AssetEntry {
+		std::uint64_t hash;		// hashString() of the name
+		std::uint32_t offset;	// into the blob, 16 byte aligned
+		std::uint32_t size;		// without the 0 that follows every asset
+		const char* name;
+	};
+
+}
+
+// BLOB and TOC, written by tools/pack_assets.cpp (cmake target psix_assets)
+#include "generated/embedded_assets.inc"
+
+namespace psix {
+
+	struct AssetView {
+		const unsigned char* data = nullptr;
+		std::size_t size = 0;
+		constexpr explicit operator bool() const { return data != nullptr; }
+		// followed by a 0, usable as a c string
+		const char* text() const { return reinterpret_cast<const char*>(data); }
+		std::string_view view() const { return std::string_view(text(), size); }
+	};
+
+	namespace detail {
+
+		constexpr bool sameName(const char* a, const char* b) {
+			for (; *a != '\0' && *a == *b; a++, b++) {
+			}
+			return *a == *b;
+		}
+
+	}
+
+	// binary search over the sorted table, -1 when the name is not packed.
+	// with a literal name it runs at compile time:
+	//   static_assert(findEmbeddedAsset("shaders/shape.vert") >= 0);
+	constexpr int findEmbeddedAsset(const char* name) {
+		const std::uint64_t hash = hashString(name);
+		int low = 0;
+		int high = static_cast<int>(embedded::ASSET_COUNT) - 1;
+		while (low <= high) {
+			const int middle = low + (high - low) / 2;
+			const AssetEntry& entry = embedded::TOC[middle];
+			if (entry.hash == hash) {
+				// a name that is not packed can still hit the hash of another one
+				return detail::sameName(entry.name, name) ? middle : -1;
+			}
+			if (entry.hash < hash) {
+				low = middle + 1;
+			}
+			else {
+				high = middle - 1;
+			}
+		}
+		return -1;
+	}
+
+	constexpr AssetView embeddedAsset(int index) {
+		AssetView asset;
+		if (index >= 0 && static_cast<std::size_t>(index) < embedded::ASSET_COUNT) {
+			asset.data = embedded::BLOB + embedded::TOC[index].offset;
+			asset.size = embedded::TOC[index].size;
+		}
+		return asset;
+	}
+
+	constexpr AssetView embeddedAsset(const char* name) {
+		return embeddedAsset(findEmbeddedAsset(name));
+	}
+
+	inline AssetView embeddedAsset(const std::string& name) {
+		return embeddedAsset(findEmbeddedAsset(name.c_str()));
+	}
+
+	constexpr std::size_t embeddedAssetCount() {
+		return embedded::ASSET_COUNT;
+	}
+
+}
@@ -0,0 +1,79 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// runtime detection of the SIMD instruction sets the CPU and OS support -->
+
+#include "core/cpu_features.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PSIX_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace psix {
+
+#if defined(PSIX_X86)
+
+	static void cpuid(int leaf, int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+		int out[4];
+		__cpuidex(out, leaf, subleaf);
+		for (int i = 0; i < 4; i++) {
+			regs[i] = static_cast<unsigned int>(out[i]);
+		}
+#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	static unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned int eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	}
+
+	static CpuFeatures detectCpuFeatures() {
+		CpuFeatures features;
+		unsigned int regs[4];
+		cpuid(0, 0, regs);
+		unsigned int maxLeaf = regs[0];
+		if (maxLeaf < 1) {
+			return features;
+		}
+		cpuid(1, 0, regs);
+		features.sse41 = (regs[2] & (1u << 19)) != 0;
+		bool osxsave = (regs[2] & (1u << 27)) != 0;
+		bool cpuAvx = (regs[2] & (1u << 28)) != 0;
+		bool cpuFma = (regs[2] & (1u << 12)) != 0;
+		// the OS has to save the YMM state on context switches (XCR0 bits 1 and 2)
+		bool osYmm = osxsave && (xgetbv0() & 0x6) == 0x6;
+		features.avx = cpuAvx && osYmm;
+		features.fma = cpuFma && osYmm;
+		if (maxLeaf >= 7) {
+			cpuid(7, 0, regs);
+			features.avx2 = features.avx && (regs[1] & (1u << 5)) != 0;
+		}
+		return features;
+	}
+
+#else
+
+	static CpuFeatures detectCpuFeatures() {
+		return CpuFeatures();
+	}
+
+#endif
+
+	const CpuFeatures& cpuFeatures() {
+		static const CpuFeatures features = detectCpuFeatures();
+		return features;
+	}
+
+}
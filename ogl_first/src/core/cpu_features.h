@@ -0,0 +1,19 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// runtime detection of the SIMD instruction sets the CPU and OS support -->
+
+#pragma once
+
+namespace psix {
+
+	struct CpuFeatures {
+		bool sse41 = false;
+		bool avx = false;
+		bool avx2 = false;
+		bool fma = false;
+	};
+
+	// queried once via CPUID (and XGETBV for OS support of the YMM registers)
+	const CpuFeatures& cpuFeatures();
+
+}
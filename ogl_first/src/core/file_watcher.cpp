@@ -0,0 +1,105 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// notices files written on disk, inotify on linux and modification times elsewhere -->
+
+#include "core/file_watcher.h"
+#include <algorithm>
+#include <system_error>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define PSIX_INOTIFY 1
+#endif
+
+namespace psix {
+
+	namespace {
+
+		std::filesystem::file_time_type writeTimeOf(const std::filesystem::path& path) {
+			std::error_code error;
+			std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+			return error ? std::filesystem::file_time_type::min() : time;
+		}
+
+		void addChanged(std::vector<int>& changed, int id) {
+			if (std::find(changed.begin(), changed.end(), id) == changed.end()) {
+				changed.push_back(id);
+			}
+		}
+
+	}
+
+	FileWatcher::FileWatcher() {
+#if defined(PSIX_INOTIFY)
+		notifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+	}
+
+	FileWatcher::~FileWatcher() {
+#if defined(PSIX_INOTIFY)
+		if (notifyHandle >= 0) {
+			close(notifyHandle);
+		}
+#endif
+	}
+
+	int FileWatcher::watch(const std::string& path) {
+		WatchedFile file;
+		file.path = std::filesystem::path(path);
+		file.name = file.path.filename().string();
+		file.writeTime = writeTimeOf(file.path);
+#if defined(PSIX_INOTIFY)
+		if (notifyHandle >= 0) {
+			// watching the same directory twice returns the same descriptor
+			std::filesystem::path directory = file.path.has_parent_path() ? file.path.parent_path() : std::filesystem::path(".");
+			file.directoryHandle = inotify_add_watch(notifyHandle, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+			if (file.directoryHandle < 0) {
+				return -1;
+			}
+		}
+#endif
+		files.push_back(file);
+		return static_cast<int>(files.size() - 1);
+	}
+
+	void FileWatcher::poll(std::vector<int>& changed) {
+		changed.clear();
+#if defined(PSIX_INOTIFY)
+		if (notifyHandle >= 0) {
+			alignas(inotify_event) char buffer[4096];
+			for (;;) {
+				ssize_t length = read(notifyHandle, buffer, sizeof(buffer));
+				if (length <= 0) {
+					break;
+				}
+				for (ssize_t offset = 0; offset < length;) {
+					const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+					offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+					if (event->len == 0) {
+						continue;
+					}
+					for (std::size_t i = 0; i < files.size(); i++) {
+						if (files[i].directoryHandle == event->wd && files[i].name == event->name) {
+							addChanged(changed, static_cast<int>(i));
+						}
+					}
+				}
+			}
+			return;
+		}
+#endif
+		if (sincePoll.elapsedMs() < pollIntervalMs) {
+			return;
+		}
+		sincePoll.restart();
+		for (std::size_t i = 0; i < files.size(); i++) {
+			std::filesystem::file_time_type time = writeTimeOf(files[i].path);
+			if (time != files[i].writeTime) {
+				files[i].writeTime = time;
+				addChanged(changed, static_cast<int>(i));
+			}
+		}
+	}
+
+}
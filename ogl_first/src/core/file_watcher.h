@@ -0,0 +1,46 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// notices files written on disk, inotify on linux and modification times elsewhere -->
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "core/stopwatch.h"
+
+namespace psix {
+
+	// on linux the directories of the watched files are watched with inotify,
+	// editors that save through a temporary file and a rename are caught too.
+	// other platforms compare modification times, at most every pollIntervalMs.
+	// poll() never blocks, it is meant to run once per frame
+
+	class FileWatcher {
+	public:
+		FileWatcher();
+		~FileWatcher();
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+		// id reported by poll(), -1 when the file can not be watched
+		int watch(const std::string& path);
+		// ids of the files written since the last call, each at most once
+		void poll(std::vector<int>& changed);
+		// false when modification times are polled
+		bool usesNotifications() const { return notifyHandle >= 0; }
+		double pollIntervalMs = 250.0;
+	private:
+		struct WatchedFile {
+			std::filesystem::path path;
+			std::string name;			// file name inside the directory
+			int directoryHandle = -1;	// inotify watch descriptor
+			std::filesystem::file_time_type writeTime;
+		};
+
+		std::vector<WatchedFile> files;
+		int notifyHandle = -1;
+		Stopwatch sincePoll;
+	};
+
+}
@@ -0,0 +1,37 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// 64 bit fnv-1a hash, usable at compile time -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace psix {
+
+	constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+	constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+	// continue a running hash by passing it as the seed
+	constexpr std::uint64_t hashBytes(const char* data, std::size_t size, std::uint64_t seed = FNV_OFFSET) {
+		std::uint64_t hash = seed;
+		for (std::size_t i = 0; i < size; i++) {
+			hash = (hash ^ static_cast<std::uint8_t>(data[i])) * FNV_PRIME;
+		}
+		return hash;
+	}
+
+	constexpr std::uint64_t hashString(const char* text, std::uint64_t seed = FNV_OFFSET) {
+		std::uint64_t hash = seed;
+		for (; *text != '\0'; text++) {
+			hash = (hash ^ static_cast<std::uint8_t>(*text)) * FNV_PRIME;
+		}
+		return hash;
+	}
+
+	inline std::uint64_t hashString(const std::string& text, std::uint64_t seed = FNV_OFFSET) {
+		return hashBytes(text.data(), text.size(), seed);
+	}
+
+}
@@ -0,0 +1,311 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// work stealing job system (chase-lev deques, parallel for, continuations) -->
+
+#include "core/job_system.h"
+
+namespace psix {
+
+	// ---------------------------------------- chase-lev deque ----------------------------------------
+
+	bool JobDeque::push(Job* job) {
+		std::int64_t b = bottom.load(std::memory_order_relaxed);
+		std::int64_t t = top.load(std::memory_order_acquire);
+		if (b - t >= CAPACITY) {
+			return false;
+		}
+		slots[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	Job* JobDeque::pop() {
+		std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t t = top.load(std::memory_order_relaxed);
+		if (t > b) {
+			// empty, restore
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		Job* job = slots[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (t == b) {
+			// last item, race against thieves for it
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* JobDeque::steal() {
+		std::int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b) {
+			return nullptr;
+		}
+		Job* job = slots[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+
+	std::int64_t JobDeque::approximateSize() const {
+		std::int64_t size = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+		return size > 0 ? size : 0;
+	}
+
+	// ---------------------------------------- job system ----------------------------------------
+
+	struct WorkerIdentity {
+		const JobSystem* owner = nullptr;
+		int index = 0;
+	};
+
+	static thread_local WorkerIdentity currentIdentity;
+
+	JobSystem::JobSystem(int workerThreads) {
+		if (workerThreads < 0) {
+			unsigned int cores = std::thread::hardware_concurrency();
+			workerThreads = cores > 1 ? static_cast<int>(cores) - 1 : 0;
+		}
+		const int total = workerThreads + 1;
+		for (int i = 0; i < total; i++) {
+			WorkerQueue* queue = new WorkerQueue();
+			queue->pool.reset(new Job[JobDeque::CAPACITY]);
+			queue->stealSeed = 0x9e3779b9u * static_cast<std::uint32_t>(i + 1);
+			queues.push_back(queue);
+		}
+		externalPool.reset(new Job[JobDeque::CAPACITY]);
+		currentIdentity.owner = this;
+		currentIdentity.index = 0;
+		for (int i = 1; i < total; i++) {
+			threads.emplace_back([this, i]() { workerLoop(i); });
+		}
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(parkMutex);
+			stopping.store(true);
+		}
+		parkCondition.notify_all();
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		for (WorkerQueue* queue : queues) {
+			delete queue;
+		}
+		if (currentIdentity.owner == this) {
+			currentIdentity.owner = nullptr;
+		}
+	}
+
+	int JobSystem::currentWorker() const {
+		return currentIdentity.owner == this ? currentIdentity.index : -1;
+	}
+
+	std::size_t JobSystem::chunkCount(std::size_t count, std::size_t grain) const {
+		if (grain == 0) {
+			grain = 1;
+		}
+		std::size_t byGrain = (count + grain - 1) / grain;
+		// a few chunks per worker balances uneven chunks without flooding the pools
+		std::size_t byWorkers = static_cast<std::size_t>(workerCount()) * 4;
+		return byGrain < byWorkers ? byGrain : byWorkers;
+	}
+
+	Job* JobSystem::allocateJob() {
+		// ring pool, a slot is reused after CAPACITY more jobs were created on this thread
+		const int worker = currentWorker();
+		Job* job = nullptr;
+		if (worker >= 0) {
+			WorkerQueue* queue = queues[worker];
+			job = &queue->pool[queue->poolCursor++ & (JobDeque::CAPACITY - 1)];
+		}
+		else {
+			// other threads share one ring under the injection lock
+			std::lock_guard<std::mutex> lock(injectMutex);
+			job = &externalPool[externalCursor++ & (JobDeque::CAPACITY - 1)];
+		}
+		job->function = nullptr;
+		job->parent = nullptr;
+		job->unfinished.store(1, std::memory_order_relaxed);
+		job->continuationCount.store(0, std::memory_order_relaxed);
+		return job;
+	}
+
+	Job* JobSystem::createJob(JobFunction function) {
+		Job* job = allocateJob();
+		job->function = function;
+		return job;
+	}
+
+	Job* JobSystem::createChild(Job* parent, JobFunction function) {
+		parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+		Job* job = allocateJob();
+		job->function = function;
+		job->parent = parent;
+		return job;
+	}
+
+	void JobSystem::addContinuation(Job* ancestor, Job* continuation) {
+		std::int32_t slot = ancestor->continuationCount.fetch_add(1, std::memory_order_relaxed);
+		ancestor->continuations[slot] = continuation;
+	}
+
+	void JobSystem::run(Job* job) {
+		const int worker = currentWorker();
+		if (worker >= 0) {
+			if (!queues[worker]->deque.push(job)) {
+				// deque full, run inline instead of failing
+				execute(job);
+				return;
+			}
+		}
+		else {
+			std::lock_guard<std::mutex> lock(injectMutex);
+			injected.push_back(job);
+			injectedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		notifyWorker();
+	}
+
+	void JobSystem::notifyWorker() {
+		// seq_cst pairs with the parking worker: either it sees the queued job
+		// in its wait predicate or this thread sees it sleeping and wakes it
+		queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+		if (sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+			std::lock_guard<std::mutex> lock(parkMutex);
+			parkCondition.notify_one();
+		}
+	}
+
+	Job* JobSystem::takeInjected() {
+		if (injectedCount.load(std::memory_order_relaxed) <= 0) {
+			return nullptr;
+		}
+		std::lock_guard<std::mutex> lock(injectMutex);
+		if (injected.empty()) {
+			return nullptr;
+		}
+		Job* job = injected.front();
+		injected.pop_front();
+		injectedCount.fetch_sub(1, std::memory_order_relaxed);
+		queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		return job;
+	}
+
+	Job* JobSystem::findJob(int worker) {
+		// worker is -1 for threads outside the system, they may only steal
+		Job* job = nullptr;
+		if (worker >= 0) {
+			job = queues[worker]->deque.pop();
+			if (job != nullptr) {
+				queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		job = takeInjected();
+		if (job != nullptr) {
+			return job;
+		}
+		// steal from a random victim, then sweep the rest once
+		const int total = workerCount();
+		if (worker >= 0 && total <= 1) {
+			return nullptr;
+		}
+		int start = 0;
+		if (worker >= 0) {
+			WorkerQueue* queue = queues[worker];
+			queue->stealSeed ^= queue->stealSeed << 13;
+			queue->stealSeed ^= queue->stealSeed >> 17;
+			queue->stealSeed ^= queue->stealSeed << 5;
+			start = static_cast<int>(queue->stealSeed % static_cast<std::uint32_t>(total));
+		}
+		for (int i = 0; i < total; i++) {
+			int victim = (start + i) % total;
+			if (victim == worker) {
+				continue;
+			}
+			job = queues[victim]->deque.steal();
+			if (job != nullptr) {
+				queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+				stolenJobs.fetch_add(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		return nullptr;
+	}
+
+	void JobSystem::execute(Job* job) {
+		if (job->function != nullptr) {
+			job->function(job);
+		}
+		executedJobs.fetch_add(1, std::memory_order_relaxed);
+		finish(job);
+	}
+
+	void JobSystem::finish(Job* job) {
+		if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+			return;
+		}
+		// read the continuations before the parent can be reused
+		std::int32_t count = job->continuationCount.load(std::memory_order_acquire);
+		Job* parent = job->parent;
+		for (std::int32_t i = 0; i < count; i++) {
+			run(job->continuations[i]);
+		}
+		if (parent != nullptr) {
+			finish(parent);
+		}
+	}
+
+	void JobSystem::wait(const Job* job) {
+		const int worker = currentWorker();
+		while (job->unfinished.load(std::memory_order_acquire) > 0) {
+			Job* next = findJob(worker);
+			if (next != nullptr) {
+				execute(next);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::workerLoop(int worker) {
+		currentIdentity.owner = this;
+		currentIdentity.index = worker;
+		int idleSpins = 0;
+		while (!stopping.load(std::memory_order_acquire)) {
+			Job* job = findJob(worker);
+			if (job != nullptr) {
+				execute(job);
+				idleSpins = 0;
+				continue;
+			}
+			// spin briefly for tight fork/join phases, then park so idle workers
+			// do not take cpu time from the render thread
+			if (++idleSpins < 64) {
+				std::this_thread::yield();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(parkMutex);
+			// seq_cst so the sleeping count and the queued count cannot both be
+			// missed, see notifyWorker
+			sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+			parkCondition.wait(lock, [this]() {
+				return stopping.load(std::memory_order_acquire) || queuedJobs.load(std::memory_order_seq_cst) > 0;
+			});
+			sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+			idleSpins = 0;
+		}
+	}
+
+}
@@ -0,0 +1,161 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// work stealing job system (chase-lev deques, parallel for, continuations) -->
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace psix {
+
+	struct Job;
+	using JobFunction = void (*)(Job* job);
+
+	// jobs are fixed size and come from a per thread ring pool, small lambdas
+	// are stored inline in the payload. a job is finished once it and all of
+	// its children have run, then its continuations are scheduled
+
+	struct alignas(64) Job {
+		static constexpr std::size_t PAYLOAD_SIZE = 80;
+		static constexpr int MAX_CONTINUATIONS = 4;
+		JobFunction function;
+		Job* parent;
+		std::atomic<std::int32_t> unfinished;
+		std::atomic<std::int32_t> continuationCount;
+		Job* continuations[MAX_CONTINUATIONS];
+		alignas(16) unsigned char payload[PAYLOAD_SIZE];
+	};
+
+	// single owner, multiple thief deque (Chase and Lev, "Dynamic Circular Work-Stealing Deque").
+	// the owner pushes and pops at the bottom, other workers steal from the top
+
+	class JobDeque {
+	public:
+		static constexpr std::int64_t CAPACITY = 4096;
+		bool push(Job* job);
+		Job* pop();
+		Job* steal();
+		std::int64_t approximateSize() const;
+	private:
+		alignas(64) std::atomic<std::int64_t> top{ 0 };
+		alignas(64) std::atomic<std::int64_t> bottom{ 0 };
+		std::atomic<Job*> slots[CAPACITY] = {};
+	};
+
+	class JobSystem {
+	public:
+		// workerThreads extra threads are started, the creating thread is worker 0.
+		// a negative count uses one thread per hardware core minus the caller
+		explicit JobSystem(int workerThreads = -1);
+		~JobSystem();
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		Job* createJob(JobFunction function);
+		Job* createChild(Job* parent, JobFunction function);
+		// store a trivially copyable callable in the job payload, it is called as f()
+		template <typename F>
+		Job* createJob(const F& function) { return makeLambdaJob(nullptr, function); }
+		template <typename F>
+		Job* createChild(Job* parent, const F& function) { return makeLambdaJob(parent, function); }
+		// schedule continuation once ancestor (and its children) has finished,
+		// the continuation must not be run by hand
+		void addContinuation(Job* ancestor, Job* continuation);
+		void run(Job* job);
+		// help executing jobs until the job has finished
+		void wait(const Job* job);
+		// calls body(begin, end) on chunks of [begin, end), chunk sizes are
+		// multiples of the grain size. returns when every chunk has run, the
+		// calling thread executes jobs while it waits
+		template <typename F>
+		void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const F& body);
+		int workerCount() const { return static_cast<int>(queues.size()); }
+		// index of the calling worker, 0 for the thread that created the system and
+		// -1 for any other thread. jobs created or run from other threads go
+		// through a locked injection queue instead of a worker deque
+		int currentWorker() const;
+		std::uint64_t executedCount() const { return executedJobs.load(std::memory_order_relaxed); }
+		std::uint64_t stolenCount() const { return stolenJobs.load(std::memory_order_relaxed); }
+	private:
+		struct WorkerQueue {
+			JobDeque deque;
+			std::unique_ptr<Job[]> pool;
+			std::uint32_t poolCursor = 0;
+			std::uint32_t stealSeed = 0;
+		};
+		Job* allocateJob();
+		Job* findJob(int worker);
+		Job* takeInjected();
+		void notifyWorker();
+		void execute(Job* job);
+		void finish(Job* job);
+		void workerLoop(int worker);
+		std::size_t chunkCount(std::size_t count, std::size_t grain) const;
+		template <typename F>
+		Job* makeLambdaJob(Job* parent, const F& function);
+
+		std::vector<WorkerQueue*> queues;
+		std::vector<std::thread> threads;
+		std::atomic<bool> stopping{ false };
+		// external submitters never touch the worker deques or pools, the owner
+		// thread of a chase-lev deque must be the only one pushing to it
+		std::mutex injectMutex;
+		std::deque<Job*> injected;
+		std::atomic<std::int64_t> injectedCount{ 0 };
+		std::unique_ptr<Job[]> externalPool;
+		std::uint32_t externalCursor = 0;
+		// parking: idle workers sleep on the condition variable until work is pushed
+		std::mutex parkMutex;
+		std::condition_variable parkCondition;
+		std::atomic<int> sleepingWorkers{ 0 };
+		std::atomic<std::int64_t> queuedJobs{ 0 };
+		std::atomic<std::uint64_t> executedJobs{ 0 };
+		std::atomic<std::uint64_t> stolenJobs{ 0 };
+	};
+
+	template <typename F>
+	Job* JobSystem::makeLambdaJob(Job* parent, const F& function) {
+		static_assert(sizeof(F) <= Job::PAYLOAD_SIZE, "job lambda captures too much, capture a pointer to a struct instead");
+		static_assert(std::is_trivially_copyable<F>::value && std::is_trivially_destructible<F>::value, "job lambdas must be trivially copyable");
+		Job* job = parent != nullptr ? createChild(parent, JobFunction(nullptr)) : createJob(JobFunction(nullptr));
+		new (job->payload) F(function);
+		job->function = [](Job* self) {
+			(*reinterpret_cast<F*>(self->payload))();
+		};
+		return job;
+	}
+
+	template <typename F>
+	void JobSystem::parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const F& body) {
+		if (end <= begin) {
+			return;
+		}
+		const std::size_t chunks = chunkCount(end - begin, grain);
+		if (chunks <= 1) {
+			body(begin, end);
+			return;
+		}
+		// chunk size rounded up to the grain so SIMD kernels keep their alignment
+		std::size_t chunkSize = ((end - begin) + chunks - 1) / chunks;
+		chunkSize = ((chunkSize + grain - 1) / grain) * grain;
+		const F* bodyPtr = &body;
+		Job* root = createJob(JobFunction(nullptr));
+		for (std::size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize) {
+			std::size_t chunkEnd = chunkBegin + chunkSize < end ? chunkBegin + chunkSize : end;
+			run(createChild(root, [bodyPtr, chunkBegin, chunkEnd]() { (*bodyPtr)(chunkBegin, chunkEnd); }));
+		}
+		run(root);
+		wait(root);
+	}
+
+}
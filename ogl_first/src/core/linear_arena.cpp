@@ -0,0 +1,72 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// linear (bump) allocator that is reset as a whole, used for per step data -->
+
+#include "core/linear_arena.h"
+#include "core/aligned_array.h"
+
+namespace psix {
+
+	LinearArena::LinearArena(std::size_t blockSize) : blockSize(blockSize) {
+	}
+
+	LinearArena::~LinearArena() {
+		for (Block& block : blocks) {
+			alignedFree(block.memory);
+		}
+	}
+
+	void LinearArena::addBlock(std::size_t minimumSize) {
+		std::size_t size = minimumSize > blockSize ? minimumSize : blockSize;
+		Block block;
+		block.memory = static_cast<unsigned char*>(alignedAlloc(size));
+		block.size = size;
+		blocks.push_back(block);
+	}
+
+	void* LinearArena::allocate(std::size_t bytes, std::size_t alignment) {
+		if (bytes == 0) {
+			bytes = 1;
+		}
+		while (current < blocks.size()) {
+			std::size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+			if (aligned + bytes <= blocks[current].size) {
+				offset = aligned + bytes;
+				usedBytes += bytes;
+				return blocks[current].memory + aligned;
+			}
+			current++;
+			offset = 0;
+		}
+		// blocks start cache line aligned, so any alignment up to that fits at offset 0
+		addBlock(bytes);
+		current = blocks.size() - 1;
+		offset = bytes;
+		usedBytes += bytes;
+		return blocks[current].memory;
+	}
+
+	void LinearArena::reset() {
+		if (blocks.size() > 1) {
+			// merge into one block big enough for the whole last step
+			std::size_t total = capacity();
+			for (Block& block : blocks) {
+				alignedFree(block.memory);
+			}
+			blocks.clear();
+			addBlock(total);
+		}
+		current = 0;
+		offset = 0;
+		usedBytes = 0;
+	}
+
+	std::size_t LinearArena::capacity() const {
+		std::size_t total = 0;
+		for (const Block& block : blocks) {
+			total += block.size;
+		}
+		return total;
+	}
+
+}
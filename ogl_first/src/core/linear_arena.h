@@ -0,0 +1,94 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// linear (bump) allocator that is reset as a whole, used for per step data -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace psix {
+
+	// allocations are carved out of large blocks and never freed one by one.
+	// reset() makes all memory reusable; if a step needed more than one block
+	// they are merged into a single block so later steps stay in one block
+
+	class LinearArena {
+	public:
+		explicit LinearArena(std::size_t blockSize = 1 << 20);
+		~LinearArena();
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+		void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+		// uninitialized storage for count objects, only for trivial types
+		template <typename T>
+		T* allocateArray(std::size_t count) {
+			static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+			return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+		}
+		void reset();
+		std::size_t bytesUsed() const { return usedBytes; }
+		std::size_t capacity() const;
+	private:
+		struct Block {
+			unsigned char* memory;
+			std::size_t size;
+		};
+		void addBlock(std::size_t minimumSize);
+
+		std::vector<Block> blocks;
+		std::size_t blockSize;
+		std::size_t current = 0;	// block being carved
+		std::size_t offset = 0;		// first free byte of the current block
+		std::size_t usedBytes = 0;
+	};
+
+	// growable array inside an arena, growing copies into a new arena range and
+	// leaves the old range behind until the arena is reset
+
+	template <typename T>
+	class ArenaArray {
+		static_assert(std::is_trivially_copyable<T>::value, "arena arrays only hold trivially copyable types");
+	public:
+		explicit ArenaArray(LinearArena& arena, std::size_t initialCapacity = 64) : arena(&arena) {
+			reserve(initialCapacity);
+		}
+		void reserve(std::size_t newCapacity) {
+			if (newCapacity <= capacity) {
+				return;
+			}
+			T* newItems = arena->allocateArray<T>(newCapacity);
+			if (count > 0) {
+				std::memcpy(static_cast<void*>(newItems), items, count * sizeof(T));
+			}
+			items = newItems;
+			capacity = newCapacity;
+		}
+		T& push_back(const T& value) {
+			if (count == capacity) {
+				reserve(capacity * 2);
+			}
+			items[count] = value;
+			return items[count++];
+		}
+		void resize(std::size_t newCount) {
+			reserve(newCount);
+			count = newCount;
+		}
+		T* data() { return items; }
+		const T* data() const { return items; }
+		std::size_t size() const { return count; }
+		T& operator[](std::size_t index) { return items[index]; }
+		const T& operator[](std::size_t index) const { return items[index]; }
+		T* begin() { return items; }
+		T* end() { return items + count; }
+	private:
+		LinearArena* arena;
+		T* items = nullptr;
+		std::size_t count = 0;
+		std::size_t capacity = 0;
+	};
+
+}
@@ -0,0 +1,125 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// read-only memory mapping of a whole file, mmap on posix and file mappings on windows -->
+
+#include "core/mapped_file.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace psix {
+
+#if defined(_WIN32)
+
+	bool MappedFile::open(const std::string& path) {
+		close();
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			errorText = "can not open " + path;
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			CloseHandle(file);
+			errorText = "empty file " + path;
+			return false;
+		}
+		HANDLE view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* memory = view != nullptr ? MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (memory == nullptr) {
+			if (view != nullptr) {
+				CloseHandle(view);
+			}
+			CloseHandle(file);
+			errorText = "can not map " + path;
+			return false;
+		}
+		fileHandle = file;
+		mappingHandle = view;
+		mapping = memory;
+		mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+		errorText.clear();
+		return true;
+	}
+
+	void MappedFile::close() {
+		if (mapping != nullptr) {
+			UnmapViewOfFile(mapping);
+			CloseHandle(static_cast<HANDLE>(mappingHandle));
+			CloseHandle(static_cast<HANDLE>(fileHandle));
+		}
+		mapping = nullptr;
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+		mappedSize = 0;
+	}
+
+	void MappedFile::prefetch(std::size_t offset, std::size_t bytes) const {
+		if (mapping == nullptr || offset >= mappedSize) {
+			return;
+		}
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = static_cast<unsigned char*>(mapping) + offset;
+		range.NumberOfBytes = bytes < mappedSize - offset ? bytes : mappedSize - offset;
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+
+#else
+
+	bool MappedFile::open(const std::string& path) {
+		close();
+		int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (file < 0) {
+			errorText = "can not open " + path;
+			return false;
+		}
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size == 0) {
+			::close(file);
+			errorText = "empty file " + path;
+			return false;
+		}
+		const std::size_t bytes = static_cast<std::size_t>(status.st_size);
+		void* memory = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, file, 0);
+		// the mapping keeps the file referenced on its own
+		::close(file);
+		if (memory == MAP_FAILED) {
+			errorText = "can not map " + path;
+			return false;
+		}
+		mapping = memory;
+		mappedSize = bytes;
+		errorText.clear();
+		return true;
+	}
+
+	void MappedFile::close() {
+		if (mapping != nullptr) {
+			munmap(mapping, mappedSize);
+		}
+		mapping = nullptr;
+		mappedSize = 0;
+	}
+
+	void MappedFile::prefetch(std::size_t offset, std::size_t bytes) const {
+		if (mapping == nullptr || offset >= mappedSize) {
+			return;
+		}
+		// madvise wants a page aligned start
+		const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		const std::size_t start = offset / page * page;
+		const std::size_t end = offset + (bytes < mappedSize - offset ? bytes : mappedSize - offset);
+		madvise(static_cast<unsigned char*>(mapping) + start, end - start, MADV_WILLNEED);
+	}
+
+#endif
+
+}
@@ -0,0 +1,40 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// read-only memory mapping of a whole file, mmap on posix and file mappings on windows -->
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace psix {
+
+	// the pages are read by the os on first touch, opening a file of any size
+	// costs the same. data() is page aligned and stays valid until close()
+
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile() { close(); }
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		// false when the file can not be opened or mapped, error() says why
+		bool open(const std::string& path);
+		void close();
+		bool isOpen() const { return mapping != nullptr; }
+		const unsigned char* data() const { return static_cast<const unsigned char*>(mapping); }
+		std::size_t size() const { return mappedSize; }
+		// asks the os to read the range ahead, for data about to be walked in order
+		void prefetch(std::size_t offset, std::size_t bytes) const;
+		const std::string& error() const { return errorText; }
+	private:
+		void* mapping = nullptr;
+		std::size_t mappedSize = 0;
+#if defined(_WIN32)
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#endif
+		std::string errorText;
+	};
+
+}
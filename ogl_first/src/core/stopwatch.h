@@ -0,0 +1,30 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// wall clock stopwatch for profiling -->
+
+#pragma once
+
+#include <chrono>
+
+namespace psix {
+
+	class Stopwatch {
+	public:
+		Stopwatch() : start(std::chrono::steady_clock::now()) {}
+		void restart() { start = std::chrono::steady_clock::now(); }
+		// milliseconds since construction or the last restart
+		double elapsedMs() const {
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+		// elapsed milliseconds, then restart, for timing consecutive phases
+		double lap() {
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			double ms = std::chrono::duration<double, std::milli>(now - start).count();
+			start = now;
+			return ms;
+		}
+	private:
+		std::chrono::steady_clock::time_point start;
+	};
+
+}
@@ -5,136 +5,199 @@
 // necessary includes
 
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <ctime>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
 #include <glad/glad.h>
+#if defined(PSIX_NO_WINDOW)
+// built without glfw (cmake found none), only --headless runs work
+struct GLFWwindow;
+#else
 #include <GLFW/glfw3.h>
+#endif
+#include "core/asset_archive.h"
+#include "core/stopwatch.h"
+#include "physics/body_archive.h"
+#include "physics/world.h"
+#include "render/command_bucket.h"
+#include "render/gl_state.h"
+#include "render/gpu_profiler.h"
+#include "render/headless_context.h"
+#include "render/instanced_renderer.h"
+#include "render/offscreen_target.h"
+#include "render/program_cache.h"
+#include "render/shader_library.h"
+#include "render/shader_program.h"
+#include "render/shape_batch.h"
+#include "render/uniform_blocks.h"
+#include "render/uniform_buffer.h"
 
 // constants
 
 constexpr auto WIDTH = 1280;
 constexpr auto HEIGHT = 720;
 constexpr auto TITLE = "OGL First Program";
-constexpr auto SHADER_FILE_DIRECTORY = "C:\\Users\\mahmu\\Desktop\\codez\\vs\\cpp\\ogl_first\\ogl_first\\src\\shaders\\";
+constexpr auto SHADER_CACHE_DIRECTORY = "shader_cache";
 
-// vertex and fragment shader source code
+// startup options, --headless renders a fixed number of frames into an
+// offscreen target without a window or display
 
-const char* vertexShaderSource;
-const char* fragmentShaderSource;
+struct AppOptions {
+	bool headless = false;
+	int frames = 600;
+	const char* capture = nullptr;	// ppm of the last headless frame
+	const char* shaderDirectory = nullptr;	// --shaders, null uses the embedded pack
+	const char* scene = nullptr;		// archive with more bodies and meshes to load
+	const char* saveScene = nullptr;	// archive written with the meshes and bodies at startup
+};
 
 // function prototypes
 
+bool windowShouldClose(GLFWwindow* window);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
-void calculateFPS(GLFWwindow* window);
-const char* readShaderFileGLSL(const char* shaderFile);
+void calculateFPS(GLFWwindow* window, const psix::GpuProfiler& profiler);
+AppOptions parseOptions(int argc, char** argv);
+double currentTime();
 
 
-int main() {
-	srand(time(0));
+int main(int argc, char** argv) {
+	AppOptions options = parseOptions(argc, argv);
+	// headless runs are compared between machines, they always see the same colours
+	srand(options.headless ? 0 : time(0));
 	// ---------------------------------------- start window initialization ----------------------------------------
 	std::cout << "Initializing OpenGL application ..." << std::endl;
-	glfwInit();
-	// set OpenGL version to 3.3 and window metadata
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, TITLE, NULL, NULL);
-	// check if window is created successfully
-	if (window == NULL) {
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
+	GLFWwindow* window = NULL;
+	psix::HeadlessContext headlessContext;
+	GLADloadproc loader = nullptr;
+	if (options.headless) {
+		// no display needed, glfw is never initialized
+		if (!headlessContext.create()) {
+			std::cout << "Failed to create headless context: " << headlessContext.error() << std::endl;
+			return -1;
+		}
+		loader = psix::HeadlessContext::loader();
+	}
+	else {
+#if defined(PSIX_NO_WINDOW)
+		std::cout << "Built without glfw, only --headless runs are supported" << std::endl;
 		return -1;
+#else
+		glfwInit();
+		// set OpenGL version to 3.3 and window metadata
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		window = glfwCreateWindow(WIDTH, HEIGHT, TITLE, NULL, NULL);
+		// check if window is created successfully
+		if (window == NULL) {
+			std::cout << "Failed to create GLFW window" << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+		// make the window's context current
+		glfwMakeContextCurrent(window);
+		//// disable window resize (disabled)
+		//glfwSetWindowAttrib(window, GLFW_RESIZABLE, GLFW_FALSE);
+		loader = (GLADloadproc)glfwGetProcAddress;
+#endif
 	}
-	// make the window's context current
-	glfwMakeContextCurrent(window);
-	//// disable window resize (disabled)
-	//glfwSetWindowAttrib(window, GLFW_RESIZABLE, GLFW_FALSE);
 	// load GLAD to manage function pointers
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+	if (!gladLoadGLLoader(loader)) {
 		std::cout << "Failed to initialize GLAD" << std::endl;
 		return -1;
 	}
-	// set the viewport size
-	glViewport(0, 0, WIDTH, HEIGHT);
-	// set the window resize callback functions
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-	// ---------------------------------------- end window initialization ----------------------------------------
-	// ---------------------------------------- start vertex shader initialization ----------------------------------------
-	vertexShaderSource = readShaderFileGLSL((SHADER_FILE_DIRECTORY + std::string("vrtxone.vert")).c_str());
-	unsigned int vertexShader;
-	vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	int success;
-	char infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success) {
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-		return -1;
-	} else {
-		std::cout << "Vertex shader compiled successfully!" << std::endl;
-	}
-	// ---------------------------------------- end vertex shader initialization ----------------------------------------
-	// ---------------------------------------- start fragment shader initialization ----------------------------------------
-	fragmentShaderSource = readShaderFileGLSL((SHADER_FILE_DIRECTORY + std::string("frgone.frag")).c_str());
-	unsigned int fragmentShader;
-	fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success) {
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-		return -1;
+	// headless frames go into a framebuffer object of the window size
+	psix::OffscreenTarget offscreenTarget;
+	if (options.headless) {
+		if (!offscreenTarget.init(WIDTH, HEIGHT)) {
+			std::cout << "Failed to create offscreen framebuffer" << std::endl;
+			return -1;
+		}
+		offscreenTarget.bind();
 	}
 	else {
-		std::cout << "Fragment shader compiled successfully!" << std::endl;
+		// set the viewport size
+		psix::glState().viewport(0, 0, WIDTH, HEIGHT);
+#if !defined(PSIX_NO_WINDOW)
+		// set the window resize callback functions
+		glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+#endif
 	}
-	// ---------------------------------------- end fragment shader initialization ----------------------------------------
+	// ---------------------------------------- end window initialization ----------------------------------------
 	// ---------------------------------------- start shader program initialization ----------------------------------------
-	unsigned int shaderProgram;
-	shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+	// the driver compiles on its own threads where it can, reloads then never stall a frame
+	if (psix::enableParallelShaderCompile(loader)) {
+		std::cout << "Parallel shader compile enabled" << std::endl;
+	}
+	// linked programs are kept as driver binaries, later starts skip the compile
+	psix::Stopwatch shaderStartup;
+	psix::ProgramCache programCache;
+	if (!programCache.init(SHADER_CACHE_DIRECTORY, loader)) {
+		std::cout << "Program binaries are not supported, shaders compile on every start" << std::endl;
+	}
+	// shaders come from the pack built into the executable. with --shaders
+	// they are read from that directory and rebuilt in the background when
+	// their files are saved
+	psix::ShaderLibrary shaderLibrary;
+	if (options.shaderDirectory != nullptr) {
+		shaderLibrary.init(options.shaderDirectory);
+	}
+	else {
+		shaderLibrary.init("shaders", psix::readEmbeddedShaderFile);
+	}
+	shaderLibrary.setProgramCache(&programCache);
+	// compiles, links and reflects the active uniforms once. the triangle keeps
+	// its vertex colours, the white circle and quad meshes skip them
+	psix::ShaderDefines colouredDefines;
+	colouredDefines.add("INSTANCED").add("VERTEX_COLOUR");
+	psix::ShaderDefines plainDefines;
+	plainDefines.add("INSTANCED");
+	psix::ShaderProgram* colouredProgram = shaderLibrary.load("vrtxone.vert", "frgone.frag", colouredDefines);
+	psix::ShaderProgram* plainProgram = colouredProgram != nullptr ? shaderLibrary.load("vrtxone.vert", "frgone.frag", plainDefines) : nullptr;
+	if (plainProgram == nullptr) {
+		std::cout << shaderLibrary.error() << std::endl;
 		return -1;
 	}
 	else {
 		std::cout << "Shader program linked successfully!" << std::endl;
 	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	// debug and level geometry goes through the shape batch and its own program
+	psix::ShaderProgram* shapeProgram = shaderLibrary.load("shape.vert", "shape.frag");
+	if (shapeProgram == nullptr) {
+		std::cout << shaderLibrary.error() << std::endl;
+		return -1;
+	}
+	// a warm start loads every program from the cache
+	const psix::ProgramCacheStats& cacheStats = programCache.stats();
+	std::cout << "Shader programs ready in " << shaderStartup.elapsedMs() << " ms (" << (cacheStats.misses + cacheStats.rejected == 0 ? "warm" : "cold")
+		<< " start, " << cacheStats.hits << " from cache, " << cacheStats.misses + cacheStats.rejected << " compiled, " << shaderLibrary.sharedLoads() << " shared variants)" << std::endl;
 	// ---------------------------------------- end shader program initialization ----------------------------------------
 	// ---------------------------------------- start render initialization ----------------------------------------
-	float vertices[] = {
-		// positions       // colors
-		0.5f, 0.5f, 0.0f,  1.0f, 0.0f, 0.0f, // top right
-	   -0.5f, 0.5f, 0.0f,  0.0f, 1.0f, 0.0f, // bottom right
-		0.0f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f // bottom left
-	};
-	// vertex buffer object
-	unsigned int VBO;
-	unsigned int VAO;
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-	// 1. bind the vertex array object
-	glBindVertexArray(VAO);
-	// 2. copy our vertices array in a vertex buffer for OpenGL to use
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-	// 4. then set the vertex attributes pointers
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 *sizeof(float)));
-	glEnableVertexAttribArray(1);
+	// every body is drawn as an instance, one draw call per shape type
+	psix::InstancedRenderer instancedRenderer;
+	instancedRenderer.init();
+	// per-frame values go out in one buffer update per frame
+	psix::UniformBuffer frameUniforms;
+	frameUniforms.init(sizeof(psix::FrameBlock));
+	frameUniforms.bindBase(psix::FRAME_BLOCK_BINDING);
+	// materials are sub-allocated from one buffer and selected by range
+	psix::UniformArena materialUniforms;
+	materialUniforms.init(64 * 1024);
+	psix::UniformSlot bodyMaterial = materialUniforms.add(psix::MaterialBlock{ { 1.0f, 1.0f, 1.0f, 1.0f } });
+	materialUniforms.upload();
+	psix::ShapeBatch shapeBatch;
+	shapeBatch.init();
+	// draws are recorded with a sort key and submitted together, sorted by state
+	psix::CommandBucket drawCommands;
+	// gpu time per pass, read back a few frames late so it never stalls
+	psix::GpuProfiler profiler;
+	profiler.init();
 	// ---------------------------------------- end render initialization ----------------------------------------
 	// ---------------------------------------- start render loop and print status logs ----------------------------------------
 	// print OpenGL version and renderer
@@ -144,58 +207,221 @@ int main() {
 	std::cout << "OpenGL shading language version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
 	std::cout << "\nOpenGL application initialized successfully!" << std::endl;
 	// render loop
-	float timeValue = glfwGetTime();
+	float timeValue = currentTime();
 	float ofStValue = (sin(timeValue) / 2.0f) + 0.5f;
-	float triangleLocation = 0.0f;
-	bool triangleDirection = true;
-	int vertexColorLocation = glGetUniformLocation(shaderProgram, "ofstclr");
-	int vertexAposXLocation = glGetUniformLocation(shaderProgram, "positionModifier");
-	while (!glfwWindowShouldClose(window)) {
-		// calculate FPS
-		calculateFPS(window);
-		// inputs
-		processInput(window);
+	// physics runs at a fixed 120 Hz, independent of the frame rate
+	psix::WorldSettings worldSettings;
+	worldSettings.stepper.fixedDt = 1.0 / 120.0;
+	worldSettings.stepper.maxSubsteps = 8;
+	worldSettings.gravity = psix::Vec2(0.0f, 0.0f);
+	psix::World world(worldSettings);
+	// physics fans out onto worker threads, the render thread joins in while it waits
+	psix::JobSystem jobSystem;
+	world.setJobSystem(&jobSystem);
+	// the triangle is the first body of the world
+	psix::BodyDesc triangleBody;
+	triangleBody.velocity = psix::Vec2(0.36f, 0.0f);
+	triangleBody.friction = 0.0f;
+	triangleBody.restitution = 1.0f;
+	const psix::BodyId triangleId = 0;
+	// walls on both sides, the triangle bounces between -0.5 and 0.5
+	float wallInner = 0.5f + triangleBody.radius;
+	psix::ProxyId walls[2];
+	walls[0] = world.addStaticBox(psix::Aabb(psix::Vec2(-wallInner - 0.5f, -1.0f), psix::Vec2(-wallInner, 1.0f)), 0.0f, 1.0f);
+	walls[1] = world.addStaticBox(psix::Aabb(psix::Vec2(wallInner, -1.0f), psix::Vec2(wallInner + 0.5f, 1.0f)), 0.0f, 1.0f);
+	// a scene archive is mapped, not read. the meshes go from the mapping into
+	// their buffers and each body array is one copy into the world. a saved
+	// scene starts with the triangle, its bodies replace the default one
+	if (options.scene != nullptr) {
+		psix::Stopwatch sceneWatch;
+		psix::AssetArchive scene;
+		psix::BodyColumns sceneBodies;
+		std::size_t sceneBodyCount = 0;
+		if (!scene.open(options.scene)) {
+			std::cout << "Failed to open scene: " << scene.error() << std::endl;
+		}
+		else if (!instancedRenderer.loadMeshes(scene)) {
+			std::cout << "Scene meshes do not match the mesh format: " << options.scene << std::endl;
+		}
+		else {
+			if (psix::bodyColumns(scene, sceneBodies, sceneBodyCount)) {
+				world.createBodies(sceneBodies, sceneBodyCount);
+			}
+			std::cout << "Loaded scene " << options.scene << " (" << scene.size() << " bytes, " << sceneBodyCount << " bodies) in " << sceneWatch.elapsedMs() << " ms" << std::endl;
+		}
+	}
+	if (world.bodies().size() == 0) {
+		world.createBody(triangleBody);	// becomes triangleId
+	}
+	if (options.saveScene != nullptr) {
+		psix::ArchiveWriter sceneWriter;
+		if (instancedRenderer.addMeshSections(sceneWriter) && psix::addBodySections(sceneWriter, world.bodies()) && sceneWriter.write(options.saveScene)) {
+			std::cout << "Wrote scene " << options.saveScene << std::endl;
+		}
+		else {
+			std::cout << "Failed to write scene " << options.saveScene << std::endl;
+		}
+	}
+	double previousFrameTime = currentTime();
+	psix::FrameBlock frameBlock = {};
+	int frameIndex = 0;
+	std::vector<double> frameTimes;
+	psix::Stopwatch frameWatch;
+	while (options.headless ? frameIndex < options.frames : !windowShouldClose(window)) {
+		// calculate FPS, the gl call counters restart with every frame
+		psix::glState().beginFrame();
+#if !defined(PSIX_NO_WINDOW)
+		if (window != NULL) {
+			calculateFPS(window, profiler);
+			// inputs
+			processInput(window);
+		}
+#endif
+		// swap in the programs that were rebuilt since the last frame
+		for (const psix::ShaderReload& reload : shaderLibrary.update()) {
+			if (reload.previous != nullptr) {
+				// the two variants stopped sharing a program after an edit
+				colouredProgram = shaderLibrary.find("vrtxone.vert", "frgone.frag", colouredDefines);
+				plainProgram = shaderLibrary.find("vrtxone.vert", "frgone.frag", plainDefines);
+			}
+			if (reload.linked) {
+				std::cout << "Reloaded shader program " << reload.files << std::endl;
+			}
+			else {
+				std::cout << "Shader reload failed, keeping the old program " << reload.files << "\n" << reload.log << std::endl;
+			}
+		}
+		// step the physics world with the wall time of the last frame, headless
+		// runs step a fixed amount so every run produces the same frames
+		double currentFrameTime = currentTime();
+		world.update(options.headless ? worldSettings.stepper.fixedDt : currentFrameTime - previousFrameTime);
+		previousFrameTime = currentFrameTime;
 		// rendering
+		profiler.beginFrame();
 		// make background color random
-		glClearColor(static_cast <float> (rand()) / static_cast <float> (RAND_MAX), static_cast <float> (rand()) / static_cast <float> (RAND_MAX), static_cast <float> (rand()) / static_cast <float> (RAND_MAX), 1.0);
+		int clearPass = profiler.beginPass("clear");
+		psix::glState().clearColor(static_cast <float> (rand()) / static_cast <float> (RAND_MAX), static_cast <float> (rand()) / static_cast <float> (RAND_MAX), static_cast <float> (rand()) / static_cast <float> (RAND_MAX), 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
-		glUseProgram(shaderProgram);
-		timeValue = glfwGetTime();
+		profiler.endPass(clearPass);
+		timeValue = options.headless ? static_cast<float>(frameIndex * worldSettings.stepper.fixedDt) : currentTime();
 		ofStValue = (sin(timeValue) / 2.0f) + 0.5f;
-		if (triangleLocation >= 0.5f) {
-			triangleDirection = false;
+		frameBlock.offsetColor[0] = ofStValue;
+		frameBlock.offsetColor[1] = ofStValue;
+		frameBlock.offsetColor[2] = ofStValue;
+		frameBlock.time = timeValue;
+		frameBlock.viewport[0] = static_cast<float>(WIDTH);
+		frameBlock.viewport[1] = static_cast<float>(HEIGHT);
+		frameUniforms.update(frameBlock);
+		// interpolate between the last two physics states so motion stays smooth,
+		// the triangle keeps its size and vertex colours
+		int bodiesPass = profiler.beginPass("bodies");
+		instancedRenderer.beginFrame();
+		instancedRenderer.add(psix::ShapeType::Triangle, world.renderPosition(triangleId), 1.0f, 1.0f, 1.0f, 1.0f);
+		// every other body is a circle written straight into the instance stream
+		const psix::BodyStore& bodies = world.bodies();
+		psix::InstanceData* circles = instancedRenderer.writeInstances(psix::ShapeType::Circle, bodies.size() - 1);
+		for (psix::BodyId id = 0; circles != nullptr && id < bodies.size(); id++) {
+			if (id == triangleId) {
+				continue;
+			}
+			psix::Vec2 position = world.renderPosition(id);
+			*circles++ = psix::InstanceData{ position.x, position.y, 2.0f * bodies.radius[id], 0xffffffffu };
 		}
-		else if (triangleLocation <= -0.5f) {
-			triangleDirection = true;
+		GLuint bodyPrograms[static_cast<int>(psix::ShapeType::Count)];
+		bodyPrograms[static_cast<int>(psix::ShapeType::Triangle)] = colouredProgram->id();
+		bodyPrograms[static_cast<int>(psix::ShapeType::Quad)] = plainProgram->id();
+		bodyPrograms[static_cast<int>(psix::ShapeType::Circle)] = plainProgram->id();
+		instancedRenderer.record(drawCommands, 1, bodyPrograms, materialUniforms, bodyMaterial);
+		profiler.endPass(bodiesPass);
+		// the walls sit on the layer below the bodies
+		int wallsPass = profiler.beginPass("walls");
+		shapeBatch.beginFrame();
+		shapeBatch.begin(drawCommands, 0, shapeProgram->id());
+		for (psix::ProxyId wall : walls) {
+			const psix::Aabb& box = world.staticBox(wall);
+			shapeBatch.box((box.min + box.max) * 0.5f, (box.max - box.min) * 0.5f, 0.0f, psix::packColour(0.3f, 0.3f, 0.3f));
 		}
-		if (triangleDirection) {
-			triangleLocation += 0.003f;
+		shapeBatch.flush();
+		profiler.endPass(wallsPass);
+		// recording is cpu only, the gpu works on what the submit issues
+		int submitPass = profiler.beginPass("submit");
+		drawCommands.submit();
+		profiler.endPass(submitPass);
+		instancedRenderer.endFrame();
+		shapeBatch.endFrame();
+		profiler.endFrame();
+#if !defined(PSIX_NO_WINDOW)
+		if (window != NULL) {
+			// check and call events and swap the buffers
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+#endif
+		frameTimes.push_back(frameWatch.lap());
+		frameIndex++;
+	}
+	if (options.headless) {
+		// frame times for regression tracking, the first frames include warm-up
+		double totalMs = 0.0;
+		for (double ms : frameTimes) {
+			totalMs += ms;
+		}
+		std::sort(frameTimes.begin(), frameTimes.end());
+		if (!frameTimes.empty()) {
+			std::cout << "Headless frames: " << frameTimes.size() << ", ms/frame avg " << totalMs / frameTimes.size()
+				<< ", median " << frameTimes[frameTimes.size() / 2] << ", max " << frameTimes.back() << std::endl;
+		}
+		const psix::GpuFrameTiming& timing = profiler.lastFrame();
+		std::cout << "Frame " << timing.frame << " cpu/gpu ms: " << timing.cpuMs << "/" << timing.gpuMs << std::endl;
+		for (int i = 0; i < timing.passCount; i++) {
+			const psix::PassTiming& pass = profiler.pass(i);
+			std::cout << "  " << pass.name << " cpu/gpu ms: " << pass.cpuMs << "/" << pass.gpuMs << std::endl;
+		}
+		if (options.capture != nullptr) {
+			if (offscreenTarget.writePpm(options.capture)) {
+				std::cout << "Wrote " << options.capture << std::endl;
+			}
+			else {
+				std::cout << "Failed to write " << options.capture << std::endl;
+			}
 		}
-		else {
-			triangleLocation -= 0.003f;
-		}
-		vertexColorLocation = glGetUniformLocation(shaderProgram, "ofstclr");
-		vertexAposXLocation = glGetUniformLocation(shaderProgram, "positionModifier");
-		glUniform3f(vertexColorLocation, ofStValue, ofStValue, ofStValue);
-		glUniform1f(vertexAposXLocation, triangleLocation);
-		// render the triangle
-		glBindVertexArray(VAO);
-		glDrawArrays(GL_TRIANGLES, 0, 3);
-		glBindVertexArray(0);
-		// check and call events and swap the buffers
-		glfwSwapBuffers(window);
-		glfwPollEvents();
 	}
 	// clear all the resources and exit program
-	glfwTerminate();
+	profiler.destroy();
+	instancedRenderer.destroy();
+	shapeBatch.destroy();
+	materialUniforms.destroy();
+	frameUniforms.destroy();
+	shaderLibrary.destroy();
+	offscreenTarget.destroy();
+	if (options.headless) {
+		headlessContext.destroy();
+	}
+#if !defined(PSIX_NO_WINDOW)
+	else {
+		glfwTerminate();
+	}
+#endif
 	return 0;
 	// ---------------------------------------- terminate glfw and end program ----------------------------------------
 }
 
+#if defined(PSIX_NO_WINDOW)
+
+bool windowShouldClose(GLFWwindow*) {
+	return true;
+}
+
+#else
+
+bool windowShouldClose(GLFWwindow* window) {
+	return glfwWindowShouldClose(window);
+}
+
 // callback function for window resize
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-	glViewport(0, 0, width, height);
+	psix::glState().viewport(0, 0, width, height);
 }
 
 // process input function
@@ -208,7 +434,7 @@ void processInput(GLFWwindow* window) {
 
 // calculate FPS
 
-void calculateFPS(GLFWwindow* window) {
+void calculateFPS(GLFWwindow* window, const psix::GpuProfiler& profiler) {
 	static double previousSeconds = glfwGetTime();
 	static int frameCount;
 	double elapsedSeconds;
@@ -218,31 +444,57 @@ void calculateFPS(GLFWwindow* window) {
 		previousSeconds = currentSeconds;
 		double fps = (double)frameCount / elapsedSeconds;
 		double msPerFrame = 1000.0 / fps;
-		char title[256];
-		sprintf_s(title, "OpenGL Application [FPS: %.2f] [ms/frame: %.2f]", fps, msPerFrame);
+		char title[512];
+		const psix::GlStateStats& glCalls = psix::glState().lastFrameStats();
+		const psix::GpuFrameTiming& timing = profiler.lastFrame();
+		int length = snprintf(title, sizeof(title), "OpenGL Application [FPS: %.2f] [ms/frame: %.2f] [cpu/gpu ms: %.2f/%.2f] [gl state calls: %zu issued, %zu skipped]",
+			fps, msPerFrame, timing.cpuMs, timing.gpuMs, glCalls.issued, glCalls.skipped);
+		// cpu and gpu time of every pass, the larger one tells which side is the bottleneck
+		for (int i = 0; i < timing.passCount && length > 0 && length < static_cast<int>(sizeof(title)); i++) {
+			const psix::PassTiming& pass = profiler.pass(i);
+			length += snprintf(title + length, sizeof(title) - length, " [%s %.2f/%.2f]", pass.name, pass.cpuMs, pass.gpuMs);
+		}
 		glfwSetWindowTitle(window, title);
 		frameCount = 0;
 	}
 	frameCount++;
 }
 
-// read shader file
-
-const char* readShaderFileGLSL(const char* shaderFile) {
-    std::ifstream file(shaderFile);
-    std::string shaderCode = "";
-    if (file.is_open()) {
-        std::string line;
-        while (std::getline(file, line)) {
-            shaderCode += line + "\n";
-        }
-        file.close();
-		std::cout << "Shader file read successfully!" << std::endl;
-    } else {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
-    }
-    // Allocate memory for the shader code and copy the string content
-    char* code = new char[shaderCode.size() + 1];
-	code = (char*)shaderCode.c_str();
-    return code;
+#endif
+
+// parse command line options
+
+AppOptions parseOptions(int argc, char** argv) {
+	AppOptions options;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--headless") == 0) {
+			options.headless = true;
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			options.frames = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+			options.capture = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--shaders") == 0 && i + 1 < argc) {
+			options.shaderDirectory = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+			options.scene = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--save-scene") == 0 && i + 1 < argc) {
+			options.saveScene = argv[++i];
+		}
+		else {
+			std::cout << "Unknown option " << argv[i] << ", usage: [--headless] [--frames count] [--capture file.ppm] [--shaders directory] [--scene file] [--save-scene file]" << std::endl;
+		}
+	}
+	return options;
+}
+
+// seconds since the first call, glfw time needs glfw which headless runs skip
+
+double currentTime() {
+	static psix::Stopwatch startup;
+	return startup.elapsedMs() / 1000.0;
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// axis aligned bounding box -->
+
+#pragma once
+
+#include <algorithm>
+#include "physics/vec2.h"
+
+namespace psix {
+
+	struct Aabb {
+		Vec2 min;
+		Vec2 max;
+		Aabb() = default;
+		Aabb(const Vec2& min, const Vec2& max) : min(min), max(max) {}
+		static Aabb fromCircle(const Vec2& center, float radius) {
+			return Aabb(Vec2(center.x - radius, center.y - radius), Vec2(center.x + radius, center.y + radius));
+		}
+		Vec2 center() const { return (min + max) * 0.5f; }
+		Vec2 extents() const { return (max - min) * 0.5f; }
+		// half the perimeter, the surface area heuristic cost in 2D
+		float perimeter() const { return 2.0f * ((max.x - min.x) + (max.y - min.y)); }
+		bool contains(const Aabb& o) const {
+			return min.x <= o.min.x && min.y <= o.min.y && o.max.x <= max.x && o.max.y <= max.y;
+		}
+		Aabb fattened(float margin) const {
+			return Aabb(Vec2(min.x - margin, min.y - margin), Vec2(max.x + margin, max.y + margin));
+		}
+	};
+
+	inline bool overlaps(const Aabb& a, const Aabb& b) {
+		return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y;
+	}
+
+	inline Aabb combine(const Aabb& a, const Aabb& b) {
+		return Aabb(Vec2(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)),
+			Vec2(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y)));
+	}
+
+}
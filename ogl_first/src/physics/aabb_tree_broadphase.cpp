@@ -0,0 +1,47 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// broadphase on top of the dynamic AABB tree, for bodies of mixed sizes -->
+
+#include "physics/aabb_tree_broadphase.h"
+
+namespace psix {
+
+	AabbTreeBroadphase::AabbTreeBroadphase(float margin) : proxyTree(margin) {
+	}
+
+	void AabbTreeBroadphase::update(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) {
+		candidatePairs.clear();
+		const std::size_t count = bodies.size();
+		bodyBoxes.resize(count);
+		// sleeping bodies keep their boxes and proxies, only awake bodies are refreshed and queried
+		const std::size_t awakeCount = awakeBodies.size();
+		awakeBoxes.resize(awakeCount);
+		moveCount = 0;
+		for (std::size_t i = 0; i < awakeCount; i++) {
+			BodyId id = awakeBodies[i];
+			bodyBoxes[id] = Aabb::fromCircle(bodies.position(id), bodies.radius[id] + contactMargin);
+			awakeBoxes[i] = bodyBoxes[id];
+			if (id < bodyProxies.size() && proxyTree.moveProxy(bodyProxies[id], bodyBoxes[id])) {
+				moveCount++;
+			}
+		}
+		// bodies created since the last update get their proxies here
+		for (std::size_t i = bodyProxies.size(); i < count; i++) {
+			bodyProxies.push_back(proxyTree.createProxy(bodyBoxes[i], static_cast<std::uint32_t>(i)));
+		}
+		// the fat boxes only narrow the search, pairs are reported on the tight
+		// bounds. a pair of two awake bodies is reported from the lower id only
+		const std::uint8_t* awake = bodies.awake.data();
+		gatherPairs(awakeCount, [&](std::vector<BodyPair>& output, std::size_t first, std::size_t last) {
+			proxyTree.queryBatch(awakeBoxes.data() + first, last - first, [&](std::size_t offset, ProxyId proxy) {
+				BodyId self = awakeBodies[first + offset];
+				BodyId other = proxyTree.userData(proxy);
+				if ((other > self || awake[other] == 0) && other != self && overlaps(bodyBoxes[self], bodyBoxes[other])) {
+					output.push_back(makeBodyPair(self, other));
+				}
+				return true;
+			});
+		});
+	}
+
+}
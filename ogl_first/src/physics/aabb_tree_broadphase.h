@@ -0,0 +1,34 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// broadphase on top of the dynamic AABB tree, for bodies of mixed sizes -->
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "physics/broadphase.h"
+#include "physics/dynamic_tree.h"
+
+namespace psix {
+
+	// one fattened proxy per body, a body that stays inside its fat box costs a
+	// containment test per step. unlike a uniform grid the tree does not care
+	// how different the body sizes are
+
+	class AabbTreeBroadphase : public Broadphase {
+	public:
+		explicit AabbTreeBroadphase(float margin = 0.05f);
+		const char* name() const override { return "aabb tree"; }
+		void update(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) override;
+		const DynamicTree& tree() const { return proxyTree; }
+		// proxies reinserted during the last update
+		std::size_t lastMoveCount() const { return moveCount; }
+	private:
+		DynamicTree proxyTree;
+		std::vector<ProxyId> bodyProxies;
+		std::vector<Aabb> bodyBoxes;
+		std::vector<Aabb> awakeBoxes;	// query input, in awake list order
+		std::size_t moveCount = 0;
+	};
+
+}
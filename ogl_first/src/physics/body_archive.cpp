@@ -0,0 +1,54 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// initial body states stored as sections of an asset archive -->
+
+#include "physics/body_archive.h"
+
+namespace psix {
+
+	namespace {
+
+		struct BodySection {
+			const char* name;
+			AlignedArray<float> BodyStore::* array;
+			const float* BodyColumns::* column;
+		};
+
+		const BodySection BODY_SECTIONS[] = {
+			{ "bodies/positionX", &BodyStore::positionX, &BodyColumns::positionX },
+			{ "bodies/positionY", &BodyStore::positionY, &BodyColumns::positionY },
+			{ "bodies/velocityX", &BodyStore::velocityX, &BodyColumns::velocityX },
+			{ "bodies/velocityY", &BodyStore::velocityY, &BodyColumns::velocityY },
+			{ "bodies/inverseMass", &BodyStore::inverseMass, &BodyColumns::inverseMass },
+			{ "bodies/radius", &BodyStore::radius, &BodyColumns::radius },
+			{ "bodies/friction", &BodyStore::friction, &BodyColumns::friction },
+			{ "bodies/restitution", &BodyStore::restitution, &BodyColumns::restitution }
+		};
+
+	}
+
+	bool addBodySections(ArchiveWriter& writer, const BodyStore& bodies) {
+		for (const BodySection& section : BODY_SECTIONS) {
+			const AlignedArray<float>& array = bodies.*section.array;
+			if (!writer.add(section.name, array.data(), array.size())) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool bodyColumns(const AssetArchive& archive, BodyColumns& columns, std::size_t& count) {
+		count = 0;
+		for (std::size_t i = 0; i < sizeof(BODY_SECTIONS) / sizeof(BODY_SECTIONS[0]); i++) {
+			const BodySection& section = BODY_SECTIONS[i];
+			ArchiveArray<float> array = archive.array<float>(section.name);
+			if (!array || (i > 0 && array.count != count)) {
+				return false;
+			}
+			count = array.count;
+			columns.*section.column = array.data;
+		}
+		return true;
+	}
+
+}
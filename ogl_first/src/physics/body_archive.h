@@ -0,0 +1,22 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// initial body states stored as sections of an asset archive -->
+
+#pragma once
+
+#include <cstddef>
+#include "core/asset_archive.h"
+#include "physics/body_store.h"
+
+namespace psix {
+
+	// one float section per property ("bodies/positionX", ...) holding the
+	// bodies as they are right now, the store has to outlive the write
+	bool addBodySections(ArchiveWriter& writer, const BodyStore& bodies);
+
+	// points the columns at the sections of a mapped archive, nothing is read
+	// yet. false when a section is missing or the counts differ.
+	//   world.createBodies(columns, count) then copies each array once
+	bool bodyColumns(const AssetArchive& archive, BodyColumns& columns, std::size_t& count);
+
+}
@@ -0,0 +1,119 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// structure-of-arrays storage for the bodies of a world -->
+
+#include "physics/body_store.h"
+#include <algorithm>
+
+namespace psix {
+
+	namespace {
+
+		template <typename T>
+		void appendFilled(AlignedArray<T>& array, T value, std::size_t count) {
+			const std::size_t first = array.size();
+			array.resize(first + count);
+			std::fill(array.begin() + first, array.end(), value);
+		}
+
+	}
+
+	BodyId BodyStore::add(const BodyDesc& desc) {
+		BodyId id = static_cast<BodyId>(positionX.size());
+		positionX.push_back(desc.position.x);
+		positionY.push_back(desc.position.y);
+		previousX.push_back(desc.position.x);
+		previousY.push_back(desc.position.y);
+		velocityX.push_back(desc.velocity.x);
+		velocityY.push_back(desc.velocity.y);
+		forceX.push_back(0.0f);
+		forceY.push_back(0.0f);
+		inverseMass.push_back(desc.inverseMass);
+		radius.push_back(desc.radius);
+		friction.push_back(desc.friction);
+		restitution.push_back(desc.restitution);
+		sleepTime.push_back(0.0f);
+		awake.push_back(1);
+		sleepingIsland.push_back(0xffffffffu);
+		return id;
+	}
+
+	BodyId BodyStore::add(const BodyColumns& columns, std::size_t count) {
+		BodyId first = static_cast<BodyId>(positionX.size());
+		if (count == 0) {
+			return first;
+		}
+		positionX.append(columns.positionX, count);
+		positionY.append(columns.positionY, count);
+		previousX.append(columns.positionX, count);
+		previousY.append(columns.positionY, count);
+		velocityX.append(columns.velocityX, count);
+		velocityY.append(columns.velocityY, count);
+		// resize zeroes the new elements
+		forceX.resize(forceX.size() + count);
+		forceY.resize(forceY.size() + count);
+		inverseMass.append(columns.inverseMass, count);
+		radius.append(columns.radius, count);
+		friction.append(columns.friction, count);
+		restitution.append(columns.restitution, count);
+		sleepTime.resize(sleepTime.size() + count);
+		appendFilled<std::uint8_t>(awake, 1, count);
+		appendFilled(sleepingIsland, 0xffffffffu, count);
+		return first;
+	}
+
+	void BodyStore::reserve(std::size_t count) {
+		positionX.reserve(count);
+		positionY.reserve(count);
+		previousX.reserve(count);
+		previousY.reserve(count);
+		velocityX.reserve(count);
+		velocityY.reserve(count);
+		forceX.reserve(count);
+		forceY.reserve(count);
+		inverseMass.reserve(count);
+		radius.reserve(count);
+		friction.reserve(count);
+		restitution.reserve(count);
+		sleepTime.reserve(count);
+		awake.reserve(count);
+		sleepingIsland.reserve(count);
+	}
+
+	void BodyStore::clear() {
+		positionX.clear();
+		positionY.clear();
+		previousX.clear();
+		previousY.clear();
+		velocityX.clear();
+		velocityY.clear();
+		forceX.clear();
+		forceY.clear();
+		inverseMass.clear();
+		radius.clear();
+		friction.clear();
+		restitution.clear();
+		sleepTime.clear();
+		awake.clear();
+		sleepingIsland.clear();
+		wakeRequests.clear();
+	}
+
+	void BodyStore::savePreviousPositions() {
+		previousX = positionX;
+		previousY = positionY;
+	}
+
+	void BodyStore::savePreviousPositions(std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; i++) {
+			previousX[i] = positionX[i];
+			previousY[i] = positionY[i];
+		}
+	}
+
+	Vec2 BodyStore::interpolatedPosition(BodyId id, float alpha) const {
+		return Vec2(previousX[id] + (positionX[id] - previousX[id]) * alpha,
+			previousY[id] + (positionY[id] - previousY[id]) * alpha);
+	}
+
+}
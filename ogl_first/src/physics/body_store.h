@@ -0,0 +1,89 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// structure-of-arrays storage for the bodies of a world -->
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "core/aligned_array.h"
+#include "physics/vec2.h"
+
+namespace psix {
+
+	using BodyId = std::uint32_t;
+
+	// description used to create a body, inverse mass 0 makes a body immovable
+
+	struct BodyDesc {
+		Vec2 position;
+		Vec2 velocity;
+		float inverseMass = 1.0f;
+		float radius = 0.05f;
+		float friction = 0.4f;
+		float restitution = 0.0f;	// 1 bounces back with the full impact speed
+	};
+
+	// initial state of many bodies as separate arrays, the layout of the store
+	// itself (and of a scene archive, see physics/body_archive.h)
+
+	struct BodyColumns {
+		const float* positionX = nullptr;
+		const float* positionY = nullptr;
+		const float* velocityX = nullptr;
+		const float* velocityY = nullptr;
+		const float* inverseMass = nullptr;
+		const float* radius = nullptr;
+		const float* friction = nullptr;
+		const float* restitution = nullptr;
+	};
+
+	// every property lives in its own 64 byte aligned array so the integration
+	// kernels can stream 8 bodies per AVX register, bodies are addressed by index
+
+	class BodyStore {
+	public:
+		BodyId add(const BodyDesc& desc);
+		// count bodies at once, one memcpy per array. returns the id of the first
+		BodyId add(const BodyColumns& columns, std::size_t count);
+		void reserve(std::size_t count);
+		void clear();
+		std::size_t size() const { return positionX.size(); }
+		Vec2 position(BodyId id) const { return Vec2(positionX[id], positionY[id]); }
+		Vec2 velocity(BodyId id) const { return Vec2(velocityX[id], velocityY[id]); }
+		// moving or pushing a sleeping body wakes its island at the start of the next step
+		void setPosition(BodyId id, const Vec2& p) { positionX[id] = p.x; positionY[id] = p.y; wake(id); }
+		void setVelocity(BodyId id, const Vec2& v) { velocityX[id] = v.x; velocityY[id] = v.y; wake(id); }
+		void applyForce(BodyId id, const Vec2& f) { forceX[id] += f.x; forceY[id] += f.y; wake(id); }
+		bool isAwake(BodyId id) const { return awake[id] != 0; }
+		void wake(BodyId id) {
+			if (awake[id] == 0) {
+				wakeRequests.push_back(id);
+			}
+		}
+		// copy the current positions into the previous-position arrays (before a step)
+		void savePreviousPositions();
+		void savePreviousPositions(std::size_t begin, std::size_t end);
+		// position blended between the previous and current step
+		Vec2 interpolatedPosition(BodyId id, float alpha) const;
+
+		AlignedArray<float> positionX;
+		AlignedArray<float> positionY;
+		AlignedArray<float> previousX;
+		AlignedArray<float> previousY;
+		AlignedArray<float> velocityX;
+		AlignedArray<float> velocityY;
+		AlignedArray<float> forceX;
+		AlignedArray<float> forceY;
+		AlignedArray<float> inverseMass;
+		AlignedArray<float> radius;
+		AlignedArray<float> friction;
+		AlignedArray<float> restitution;
+		// sleeping state, owned by the island manager of the world
+		AlignedArray<float> sleepTime;
+		AlignedArray<std::uint8_t> awake;
+		AlignedArray<std::uint32_t> sleepingIsland;
+		std::vector<BodyId> wakeRequests;
+	};
+
+}
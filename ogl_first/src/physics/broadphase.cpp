@@ -0,0 +1,36 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// common interface of the broadphase implementations -->
+
+#include "physics/broadphase.h"
+#include "physics/aabb_tree_broadphase.h"
+#include "physics/hash_grid_broadphase.h"
+#include "physics/sweep_and_prune_broadphase.h"
+
+namespace psix {
+
+	std::unique_ptr<Broadphase> createBroadphase(const BroadphaseSettings& settings) {
+		switch (settings.type) {
+		case BroadphaseType::SweepAndPrune:
+			return std::make_unique<SweepAndPruneBroadphase>();
+		case BroadphaseType::AabbTree:
+			return std::make_unique<AabbTreeBroadphase>(settings.treeMargin);
+		case BroadphaseType::HashGrid:
+		default:
+			return std::make_unique<HashGridBroadphase>(settings.hashGrid);
+		}
+	}
+
+	const char* broadphaseTypeName(BroadphaseType type) {
+		switch (type) {
+		case BroadphaseType::SweepAndPrune:
+			return "sweep and prune";
+		case BroadphaseType::AabbTree:
+			return "aabb tree";
+		case BroadphaseType::HashGrid:
+		default:
+			return "hash grid";
+		}
+	}
+
+}
@@ -0,0 +1,111 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// common interface of the broadphase implementations -->
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "core/job_system.h"
+#include "physics/body_store.h"
+
+namespace psix {
+
+	// candidate pair handed to the narrowphase, always a < b
+
+	struct BodyPair {
+		BodyId a;
+		BodyId b;
+	};
+
+	inline bool operator==(const BodyPair& l, const BodyPair& r) {
+		return l.a == r.a && l.b == r.b;
+	}
+
+	inline BodyPair makeBodyPair(BodyId a, BodyId b) {
+		return a < b ? BodyPair{ a, b } : BodyPair{ b, a };
+	}
+
+	// a broadphase looks at the bounds of every body (circle of radius around
+	// the position) once per step and reports the pairs whose bounds overlap.
+	// sleeping bodies keep their bounds, pairs of two sleeping bodies are not reported
+
+	class Broadphase {
+	public:
+		virtual ~Broadphase() = default;
+		virtual const char* name() const = 0;
+		// refresh from the current body positions and rebuild the candidate pairs,
+		// awakeBodies is sorted and lists the bodies that may have moved
+		virtual void update(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) = 0;
+		const std::vector<BodyPair>& pairs() const { return candidatePairs; }
+		// broadphases with a persistent pair set also report which pairs started
+		// and stopped overlapping during the last update
+		virtual bool reportsDeltas() const { return false; }
+		const std::vector<BodyPair>& added() const { return addedPairs; }
+		const std::vector<BodyPair>& removed() const { return removedPairs; }
+		// pair generation fans out onto the job system when one is set
+		void setJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+		// bounds grow by the margin, for solvers that want contacts before the shapes touch
+		void setContactMargin(float margin) { contactMargin = margin; }
+		float margin() const { return contactMargin; }
+	protected:
+		// runs body(output, begin, end) over chunks of [0, count), every chunk
+		// writes into its own pair list and the lists are appended to the
+		// candidate pairs in chunk order, so the result does not depend on timing
+		template <typename F>
+		void gatherPairs(std::size_t count, const F& body);
+
+		std::vector<BodyPair> candidatePairs;
+		std::vector<BodyPair> addedPairs;
+		std::vector<BodyPair> removedPairs;
+		JobSystem* jobSystem = nullptr;
+		float contactMargin = 0.0f;
+		std::vector<std::vector<BodyPair>> chunkPairs;
+	};
+
+	template <typename F>
+	void Broadphase::gatherPairs(std::size_t count, const F& body) {
+		if (jobSystem == nullptr || jobSystem->workerCount() <= 1 || count < 1024) {
+			body(candidatePairs, std::size_t(0), count);
+			return;
+		}
+		const std::size_t chunks = static_cast<std::size_t>(jobSystem->workerCount()) * 4;
+		const std::size_t chunkSize = (count + chunks - 1) / chunks;
+		if (chunkPairs.size() < chunks) {
+			chunkPairs.resize(chunks);
+		}
+		jobSystem->parallelFor(0, chunks, 1, [&](std::size_t first, std::size_t last) {
+			for (std::size_t c = first; c < last; c++) {
+				std::size_t begin = c * chunkSize;
+				std::size_t end = begin + chunkSize < count ? begin + chunkSize : count;
+				chunkPairs[c].clear();
+				if (begin < end) {
+					body(chunkPairs[c], begin, end);
+				}
+			}
+		});
+		for (std::size_t c = 0; c < chunks; c++) {
+			candidatePairs.insert(candidatePairs.end(), chunkPairs[c].begin(), chunkPairs[c].end());
+		}
+	}
+
+	enum class BroadphaseType {
+		HashGrid,		// many similarly sized bodies
+		SweepAndPrune,	// coherent motion, reports pair deltas
+		AabbTree		// mixed body sizes
+	};
+
+	struct HashGridSettings {
+		float cellSize = 0.0f;	// 0 picks the largest body diameter every step
+	};
+
+	struct BroadphaseSettings {
+		BroadphaseType type = BroadphaseType::HashGrid;
+		HashGridSettings hashGrid;
+		float treeMargin = 0.05f;	// fat box margin of the aabb tree
+	};
+
+	std::unique_ptr<Broadphase> createBroadphase(const BroadphaseSettings& settings);
+	const char* broadphaseTypeName(BroadphaseType type);
+
+}
@@ -0,0 +1,51 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// contact manifolds produced by the narrowphase and consumed by the solvers -->
+
+#pragma once
+
+#include <cstdint>
+#include "physics/body_store.h"
+#include "physics/vec2.h"
+
+namespace psix {
+
+	constexpr BodyId NULL_BODY = 0xffffffffu;
+	constexpr int MAX_MANIFOLD_POINTS = 2;
+
+	struct ContactPoint {
+		Vec2 point;
+		float separation;			// negative when penetrating
+		std::uint32_t featureId;	// which features touch, warm starting only matches equal ids
+		float normalImpulse;		// accumulated over the solver iterations
+		float tangentImpulse;
+		float normalMass;
+		float tangentMass;
+		float velocityBias;			// restitution target
+	};
+
+	// the normal points from A to B. contacts with static colliders have no
+	// body A (NULL_BODY) and refer to the collider through staticIndex
+
+	struct ContactManifold {
+		std::uint64_t key;			// stable id of the shape pair, used by the contact cache
+		BodyId bodyA;
+		BodyId bodyB;
+		std::uint32_t staticIndex;
+		Vec2 normal;
+		float friction;
+		float restitution;
+		int pointCount;
+		ContactPoint points[MAX_MANIFOLD_POINTS];
+	};
+
+	inline std::uint64_t bodyPairKey(BodyId a, BodyId b) {
+		return (static_cast<std::uint64_t>(a) << 32) | b;
+	}
+
+	// the high bit keeps static keys apart from body pair keys
+	inline std::uint64_t staticPairKey(std::uint32_t staticIndex, BodyId body) {
+		return (static_cast<std::uint64_t>(body) << 32) | 0x80000000u | staticIndex;
+	}
+
+}
@@ -0,0 +1,213 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// sequential impulse contact solver with warm starting -->
+
+#include "physics/contact_solver.h"
+#include "physics/narrowphase.h"
+#include <algorithm>
+#include <cmath>
+
+namespace psix {
+
+	ContactSolver::ContactSolver(const ContactSettings& settings) : settings(settings) {
+	}
+
+	static bool cacheLess(std::uint64_t keyA, std::uint32_t featureA, std::uint64_t keyB, std::uint32_t featureB) {
+		return keyA < keyB || (keyA == keyB && featureA < featureB);
+	}
+
+	const ContactSolver::CachedImpulse* ContactSolver::findCached(std::uint64_t key, std::uint32_t featureId) const {
+		auto it = std::lower_bound(cache.begin(), cache.end(), key, [featureId](const CachedImpulse& entry, std::uint64_t k) {
+			return cacheLess(entry.key, entry.featureId, k, featureId);
+		});
+		if (it != cache.end() && it->key == key && it->featureId == featureId) {
+			return &*it;
+		}
+		return nullptr;
+	}
+
+	// velocity of a manifold side, static colliders do not move
+	static inline Vec2 sideVelocity(const BodyStore& bodies, BodyId id) {
+		return id == NULL_BODY ? Vec2() : bodies.velocity(id);
+	}
+
+	static inline float sideInverseMass(const BodyStore& bodies, BodyId id) {
+		return id == NULL_BODY ? 0.0f : bodies.inverseMass[id];
+	}
+
+	// immovable bodies are never written, islands that touch the same one can be solved in parallel
+	static inline void applyImpulse(BodyStore& bodies, BodyId a, BodyId b, float invMassA, float invMassB, const Vec2& impulse) {
+		if (invMassA > 0.0f) {
+			bodies.velocityX[a] -= impulse.x * invMassA;
+			bodies.velocityY[a] -= impulse.y * invMassA;
+		}
+		if (invMassB > 0.0f) {
+			bodies.velocityX[b] += impulse.x * invMassB;
+			bodies.velocityY[b] += impulse.y * invMassB;
+		}
+	}
+
+	std::size_t ContactSolver::prepare(const BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end) const {
+		std::size_t matched = 0;
+		for (std::size_t m = begin; m < end; m++) {
+			ContactManifold& manifold = manifolds[m];
+			float invMassA = sideInverseMass(bodies, manifold.bodyA);
+			float invMassB = sideInverseMass(bodies, manifold.bodyB);
+			float invMassSum = invMassA + invMassB;
+			Vec2 relativeVelocity = sideVelocity(bodies, manifold.bodyB) - sideVelocity(bodies, manifold.bodyA);
+			float normalSpeed = dot(relativeVelocity, manifold.normal);
+			for (int p = 0; p < manifold.pointCount; p++) {
+				ContactPoint& point = manifold.points[p];
+				// without rotation the effective mass is the same along both axes
+				point.normalMass = invMassSum > 0.0f ? 1.0f / invMassSum : 0.0f;
+				point.tangentMass = point.normalMass;
+				point.velocityBias = normalSpeed < -settings.restitutionThreshold ? -manifold.restitution * normalSpeed : 0.0f;
+				point.normalImpulse = 0.0f;
+				point.tangentImpulse = 0.0f;
+				if (settings.warmStarting) {
+					const CachedImpulse* cached = findCached(manifold.key, point.featureId);
+					if (cached != nullptr) {
+						point.normalImpulse = cached->normalImpulse;
+						point.tangentImpulse = cached->tangentImpulse;
+						matched++;
+					}
+				}
+			}
+		}
+		return matched;
+	}
+
+	void ContactSolver::warmStart(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end) const {
+		for (std::size_t m = begin; m < end; m++) {
+			ContactManifold& manifold = manifolds[m];
+			float invMassA = sideInverseMass(bodies, manifold.bodyA);
+			float invMassB = sideInverseMass(bodies, manifold.bodyB);
+			Vec2 tangent = perp(manifold.normal);
+			for (int p = 0; p < manifold.pointCount; p++) {
+				const ContactPoint& point = manifold.points[p];
+				Vec2 impulse = manifold.normal * point.normalImpulse + tangent * point.tangentImpulse;
+				applyImpulse(bodies, manifold.bodyA, manifold.bodyB, invMassA, invMassB, impulse);
+			}
+		}
+	}
+
+	void ContactSolver::solveVelocities(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end) const {
+		for (std::size_t m = begin; m < end; m++) {
+			ContactManifold& manifold = manifolds[m];
+			float invMassA = sideInverseMass(bodies, manifold.bodyA);
+			float invMassB = sideInverseMass(bodies, manifold.bodyB);
+			Vec2 tangent = perp(manifold.normal);
+			for (int p = 0; p < manifold.pointCount; p++) {
+				ContactPoint& point = manifold.points[p];
+				// friction first, bounded by the normal impulse of the previous iteration
+				Vec2 relativeVelocity = sideVelocity(bodies, manifold.bodyB) - sideVelocity(bodies, manifold.bodyA);
+				float lambda = -point.tangentMass * dot(relativeVelocity, tangent);
+				float maxFriction = manifold.friction * point.normalImpulse;
+				float newImpulse = std::clamp(point.tangentImpulse + lambda, -maxFriction, maxFriction);
+				lambda = newImpulse - point.tangentImpulse;
+				point.tangentImpulse = newImpulse;
+				applyImpulse(bodies, manifold.bodyA, manifold.bodyB, invMassA, invMassB, tangent * lambda);
+				// normal impulse, the accumulated impulse may only push
+				relativeVelocity = sideVelocity(bodies, manifold.bodyB) - sideVelocity(bodies, manifold.bodyA);
+				lambda = -point.normalMass * (dot(relativeVelocity, manifold.normal) - point.velocityBias);
+				newImpulse = std::max(point.normalImpulse + lambda, 0.0f);
+				lambda = newImpulse - point.normalImpulse;
+				point.normalImpulse = newImpulse;
+				applyImpulse(bodies, manifold.bodyA, manifold.bodyB, invMassA, invMassB, manifold.normal * lambda);
+			}
+		}
+	}
+
+	float ContactSolver::solvePositions(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end, const Aabb* staticBoxes) const {
+		float deepest = 0.0f;
+		for (std::size_t m = begin; m < end; m++) {
+			const ContactManifold& manifold = manifolds[m];
+			float invMassA = sideInverseMass(bodies, manifold.bodyA);
+			float invMassB = sideInverseMass(bodies, manifold.bodyB);
+			float invMassSum = invMassA + invMassB;
+			if (invMassSum == 0.0f) {
+				continue;
+			}
+			// recompute the separation from the current positions
+			ContactManifold current;
+			bool touching;
+			if (manifold.bodyA == NULL_BODY) {
+				touching = collideBoxCircle(staticBoxes[manifold.staticIndex], bodies.position(manifold.bodyB), bodies.radius[manifold.bodyB], current);
+			}
+			else {
+				touching = collideCircles(bodies.position(manifold.bodyA), bodies.radius[manifold.bodyA], bodies.position(manifold.bodyB), bodies.radius[manifold.bodyB], current);
+			}
+			if (!touching) {
+				continue;
+			}
+			float separation = current.points[0].separation;
+			deepest = std::min(deepest, separation);
+			float correction = std::clamp(settings.baumgarte * (separation + settings.linearSlop), -settings.maxCorrection, 0.0f);
+			if (correction == 0.0f) {
+				continue;
+			}
+			Vec2 push = current.normal * (-correction / invMassSum);
+			if (invMassA > 0.0f) {
+				bodies.positionX[manifold.bodyA] -= push.x * invMassA;
+				bodies.positionY[manifold.bodyA] -= push.y * invMassA;
+			}
+			if (invMassB > 0.0f) {
+				bodies.positionX[manifold.bodyB] += push.x * invMassB;
+				bodies.positionY[manifold.bodyB] += push.y * invMassB;
+			}
+		}
+		return deepest;
+	}
+
+	std::size_t ContactSolver::solveVelocityRange(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end) const {
+		std::size_t matched = prepare(bodies, manifolds, begin, end);
+		if (settings.warmStarting) {
+			warmStart(bodies, manifolds, begin, end);
+		}
+		for (int i = 0; i < settings.velocityIterations; i++) {
+			solveVelocities(bodies, manifolds, begin, end);
+		}
+		return matched;
+	}
+
+	void ContactSolver::solvePositionRange(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end, const Aabb* staticBoxes) const {
+		for (int i = 0; i < settings.positionIterations; i++) {
+			// stop early once everything is within the slop
+			if (solvePositions(bodies, manifolds, begin, end, staticBoxes) >= -3.0f * settings.linearSlop) {
+				break;
+			}
+		}
+	}
+
+	void ContactSolver::storeImpulses(const ContactManifold* manifolds, std::size_t count) {
+		nextCache.clear();
+		for (std::size_t m = 0; m < count; m++) {
+			const ContactManifold& manifold = manifolds[m];
+			for (int p = 0; p < manifold.pointCount; p++) {
+				const ContactPoint& point = manifold.points[p];
+				nextCache.push_back(CachedImpulse{ manifold.key, point.featureId, point.normalImpulse, point.tangentImpulse });
+			}
+		}
+		std::sort(nextCache.begin(), nextCache.end(), [](const CachedImpulse& a, const CachedImpulse& b) {
+			return cacheLess(a.key, a.featureId, b.key, b.featureId);
+		});
+		cache.swap(nextCache);
+	}
+
+	void ContactSolver::restoreImpulses(const ContactManifold* manifolds, std::size_t count) {
+		if (count == 0) {
+			return;
+		}
+		for (std::size_t m = 0; m < count; m++) {
+			const ContactManifold& manifold = manifolds[m];
+			for (int p = 0; p < manifold.pointCount; p++) {
+				const ContactPoint& point = manifold.points[p];
+				cache.push_back(CachedImpulse{ manifold.key, point.featureId, point.normalImpulse, point.tangentImpulse });
+			}
+		}
+		std::sort(cache.begin(), cache.end(), [](const CachedImpulse& a, const CachedImpulse& b) {
+			return cacheLess(a.key, a.featureId, b.key, b.featureId);
+		});
+	}
+
+}
@@ -0,0 +1,65 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// sequential impulse contact solver with warm starting -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "physics/aabb.h"
+#include "physics/body_store.h"
+#include "physics/contact.h"
+
+namespace psix {
+
+	struct ContactSettings {
+		int velocityIterations = 8;
+		int positionIterations = 3;
+		bool warmStarting = true;			// start from the impulses of the previous step
+		float baumgarte = 0.2f;				// fraction of the penetration removed per position iteration
+		float linearSlop = 0.0005f;			// penetration that is allowed to remain
+		float maxCorrection = 0.02f;		// largest position correction per iteration
+		float restitutionThreshold = 0.1f;	// slower impacts do not bounce
+	};
+
+	// the solver works on ranges of manifolds so callers can hand independent
+	// groups (islands) to different threads. accumulated impulses are kept in a
+	// sorted cache keyed by shape pair and feature id between steps
+
+	class ContactSolver {
+	public:
+		explicit ContactSolver(const ContactSettings& settings = ContactSettings());
+		void setSettings(const ContactSettings& newSettings) { settings = newSettings; }
+		const ContactSettings& contactSettings() const { return settings; }
+		// computes the effective masses and restitution targets and fetches the
+		// cached impulses of the previous step, returns the number of warm started points
+		std::size_t prepare(const BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end) const;
+		void warmStart(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end) const;
+		void solveVelocities(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end) const;
+		// one nonlinear gauss seidel pass over the penetrations, returns the largest penetration left
+		float solvePositions(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end, const Aabb* staticBoxes) const;
+		// runs prepare, warm start and all iterations on a range, the position
+		// pass needs integratePositions to have run, so it is separate
+		std::size_t solveVelocityRange(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end) const;
+		void solvePositionRange(BodyStore& bodies, ContactManifold* manifolds, std::size_t begin, std::size_t end, const Aabb* staticBoxes) const;
+		// replace the cache with the impulses of this step
+		void storeImpulses(const ContactManifold* manifolds, std::size_t count);
+		// put impulses back into the cache, used when a sleeping island wakes up
+		void restoreImpulses(const ContactManifold* manifolds, std::size_t count);
+		std::size_t cachedPointCount() const { return cache.size(); }
+	private:
+		struct CachedImpulse {
+			std::uint64_t key;
+			std::uint32_t featureId;
+			float normalImpulse;
+			float tangentImpulse;
+		};
+		const CachedImpulse* findCached(std::uint64_t key, std::uint32_t featureId) const;
+
+		ContactSettings settings;
+		std::vector<CachedImpulse> cache;	// sorted by key, feature id
+		std::vector<CachedImpulse> nextCache;
+	};
+
+}
@@ -0,0 +1,226 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// dynamic AABB tree (bounding volume hierarchy) with a pooled node array -->
+
+#include "physics/dynamic_tree.h"
+#include <algorithm>
+
+namespace psix {
+
+	DynamicTree::DynamicTree(float margin) : margin(margin) {
+	}
+
+	std::uint32_t DynamicTree::allocateNode() {
+		if (freeList == NULL_NODE) {
+			// grow the pool and thread the new nodes onto the free list
+			std::uint32_t first = static_cast<std::uint32_t>(nodes.size());
+			std::uint32_t grow = first == 0 ? 16 : first;
+			nodes.resize(first + grow);
+			for (std::uint32_t i = first; i < first + grow; i++) {
+				nodes[i].parent = i + 1 < first + grow ? i + 1 : NULL_NODE;
+				nodes[i].height = -1;
+			}
+			freeList = first;
+		}
+		std::uint32_t index = freeList;
+		freeList = nodes[index].parent;
+		Node& node = nodes[index];
+		node.parent = NULL_NODE;
+		node.child1 = NULL_NODE;
+		node.child2 = NULL_NODE;
+		node.userData = 0;
+		node.height = 0;
+		return index;
+	}
+
+	void DynamicTree::freeNode(std::uint32_t node) {
+		nodes[node].parent = freeList;
+		nodes[node].height = -1;
+		freeList = node;
+	}
+
+	ProxyId DynamicTree::createProxy(const Aabb& box, std::uint32_t userData) {
+		std::uint32_t leaf = allocateNode();
+		nodes[leaf].box = box.fattened(margin);
+		nodes[leaf].userData = userData;
+		insertLeaf(leaf);
+		leafCount++;
+		return leaf;
+	}
+
+	void DynamicTree::destroyProxy(ProxyId proxy) {
+		removeLeaf(proxy);
+		freeNode(proxy);
+		leafCount--;
+	}
+
+	bool DynamicTree::moveProxy(ProxyId proxy, const Aabb& box) {
+		if (nodes[proxy].box.contains(box)) {
+			return false;
+		}
+		removeLeaf(proxy);
+		nodes[proxy].box = box.fattened(margin);
+		insertLeaf(proxy);
+		return true;
+	}
+
+	void DynamicTree::insertLeaf(std::uint32_t leaf) {
+		if (root == NULL_NODE) {
+			root = leaf;
+			nodes[root].parent = NULL_NODE;
+			return;
+		}
+		// descend towards the sibling with the lowest perimeter cost (SAH in 2D)
+		const Aabb leafBox = nodes[leaf].box;
+		std::uint32_t index = root;
+		while (!nodes[index].isLeaf()) {
+			const Node& node = nodes[index];
+			float area = node.box.perimeter();
+			float combinedArea = combine(node.box, leafBox).perimeter();
+			// cost of making a new parent for this node and the leaf
+			float cost = 2.0f * combinedArea;
+			// minimum cost of pushing the leaf further down the tree
+			float inheritanceCost = 2.0f * (combinedArea - area);
+			float childCost[2];
+			const std::uint32_t children[2] = { node.child1, node.child2 };
+			for (int c = 0; c < 2; c++) {
+				const Node& child = nodes[children[c]];
+				float grown = combine(leafBox, child.box).perimeter();
+				childCost[c] = child.isLeaf() ? grown + inheritanceCost : (grown - child.box.perimeter()) + inheritanceCost;
+			}
+			if (cost < childCost[0] && cost < childCost[1]) {
+				break;
+			}
+			index = childCost[0] < childCost[1] ? node.child1 : node.child2;
+		}
+		std::uint32_t sibling = index;
+		// create a new parent holding the sibling and the leaf
+		std::uint32_t oldParent = nodes[sibling].parent;
+		std::uint32_t newParent = allocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+		if (oldParent != NULL_NODE) {
+			if (nodes[oldParent].child1 == sibling) {
+				nodes[oldParent].child1 = newParent;
+			}
+			else {
+				nodes[oldParent].child2 = newParent;
+			}
+		}
+		else {
+			root = newParent;
+		}
+		refit(nodes[leaf].parent);
+	}
+
+	void DynamicTree::removeLeaf(std::uint32_t leaf) {
+		if (leaf == root) {
+			root = NULL_NODE;
+			return;
+		}
+		std::uint32_t parent = nodes[leaf].parent;
+		std::uint32_t grandParent = nodes[parent].parent;
+		std::uint32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+		if (grandParent != NULL_NODE) {
+			// the sibling takes the place of the parent
+			if (nodes[grandParent].child1 == parent) {
+				nodes[grandParent].child1 = sibling;
+			}
+			else {
+				nodes[grandParent].child2 = sibling;
+			}
+			nodes[sibling].parent = grandParent;
+			freeNode(parent);
+			refit(grandParent);
+		}
+		else {
+			root = sibling;
+			nodes[sibling].parent = NULL_NODE;
+			freeNode(parent);
+		}
+	}
+
+	void DynamicTree::refit(std::uint32_t index) {
+		// walk back to the root fixing heights and boxes, rotating where unbalanced
+		while (index != NULL_NODE) {
+			index = balance(index);
+			Node& node = nodes[index];
+			node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+			node.box = combine(nodes[node.child1].box, nodes[node.child2].box);
+			index = node.parent;
+		}
+	}
+
+	// rotate the taller child up if the subtree heights differ by more than one,
+	// returns the index of the node now at the top of this subtree
+
+	std::uint32_t DynamicTree::balance(std::uint32_t iA) {
+		Node& A = nodes[iA];
+		if (A.isLeaf() || A.height < 2) {
+			return iA;
+		}
+		std::uint32_t iB = A.child1;
+		std::uint32_t iC = A.child2;
+		int balanceFactor = nodes[iC].height - nodes[iB].height;
+		if (balanceFactor > 1 || balanceFactor < -1) {
+			// the taller child (up) is promoted, its shorter grandchild moves under A
+			std::uint32_t iUp = balanceFactor > 1 ? iC : iB;
+			std::uint32_t iStay = balanceFactor > 1 ? iB : iC;
+			Node& up = nodes[iUp];
+			std::uint32_t iF = up.child1;
+			std::uint32_t iG = up.child2;
+			// swap A and up
+			up.child1 = iA;
+			up.parent = A.parent;
+			A.parent = iUp;
+			if (up.parent != NULL_NODE) {
+				if (nodes[up.parent].child1 == iA) {
+					nodes[up.parent].child1 = iUp;
+				}
+				else {
+					nodes[up.parent].child2 = iUp;
+				}
+			}
+			else {
+				root = iUp;
+			}
+			// the taller grandchild stays with up, the shorter one replaces up under A
+			std::uint32_t iKeep = nodes[iF].height > nodes[iG].height ? iF : iG;
+			std::uint32_t iMove = iKeep == iF ? iG : iF;
+			up.child2 = iKeep;
+			if (balanceFactor > 1) {
+				A.child2 = iMove;
+			}
+			else {
+				A.child1 = iMove;
+			}
+			nodes[iMove].parent = iA;
+			A.box = combine(nodes[iStay].box, nodes[iMove].box);
+			A.height = 1 + std::max(nodes[iStay].height, nodes[iMove].height);
+			up.box = combine(A.box, nodes[iKeep].box);
+			up.height = 1 + std::max(A.height, nodes[iKeep].height);
+			return iUp;
+		}
+		return iA;
+	}
+
+	float DynamicTree::areaRatio() const {
+		if (root == NULL_NODE) {
+			return 0.0f;
+		}
+		float rootArea = nodes[root].box.perimeter();
+		float totalArea = 0.0f;
+		for (const Node& node : nodes) {
+			if (node.height > 0) {
+				totalArea += node.box.perimeter();
+			}
+		}
+		return rootArea > 0.0f ? totalArea / rootArea : 0.0f;
+	}
+
+}
@@ -0,0 +1,170 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// dynamic AABB tree (bounding volume hierarchy) with a pooled node array -->
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "physics/aabb.h"
+
+namespace psix {
+
+	using ProxyId = std::uint32_t;
+	constexpr std::uint32_t NULL_NODE = 0xffffffffu;
+
+	// leaves hold fattened boxes so small motions do not touch the tree, inner
+	// nodes are kept balanced with rotations. nodes live in one array and refer
+	// to each other with 32 bit indices, which keeps them small and relocatable
+
+	class DynamicTree {
+	public:
+		explicit DynamicTree(float margin = 0.05f);
+		// insert a box, the stored box is grown by the margin
+		ProxyId createProxy(const Aabb& box, std::uint32_t userData);
+		void destroyProxy(ProxyId proxy);
+		// returns true if the proxy had to be reinserted (the box left its fat box)
+		bool moveProxy(ProxyId proxy, const Aabb& box);
+		std::uint32_t userData(ProxyId proxy) const { return nodes[proxy].userData; }
+		const Aabb& fatBox(ProxyId proxy) const { return nodes[proxy].box; }
+		// calls callback(proxy) for every leaf overlapping the box, return false to stop.
+		// queries and ray casts are read only and may run concurrently
+		template <typename Callback>
+		void query(const Aabb& box, Callback&& callback) const;
+		// batched query, calls callback(index, proxy) for every leaf overlapping boxes[index]
+		template <typename Callback>
+		void queryBatch(const Aabb* boxes, std::size_t count, Callback&& callback) const;
+		// casts the segment p1 -> p2, callback(proxy, maxFraction) returns the new
+		// max fraction (0 stops, the current value continues) and refines the test
+		template <typename Callback>
+		void rayCast(const Vec2& p1, const Vec2& p2, Callback&& callback) const;
+		int height() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+		std::size_t proxyCount() const { return leafCount; }
+		// sum of inner node perimeters divided by the root perimeter
+		float areaRatio() const;
+		float fatMargin() const { return margin; }
+	private:
+		struct Node {
+			Aabb box;
+			std::uint32_t parent;	// next free node while on the free list
+			std::uint32_t child1;
+			std::uint32_t child2;
+			std::uint32_t userData;
+			std::int32_t height;	// leaf = 0, free node = -1
+			bool isLeaf() const { return child1 == NULL_NODE; }
+		};
+		std::uint32_t allocateNode();
+		void freeNode(std::uint32_t node);
+		void insertLeaf(std::uint32_t leaf);
+		void removeLeaf(std::uint32_t leaf);
+		std::uint32_t balance(std::uint32_t node);
+		void refit(std::uint32_t node);
+
+		std::vector<Node> nodes;
+		std::uint32_t root = NULL_NODE;
+		std::uint32_t freeList = NULL_NODE;
+		std::size_t leafCount = 0;
+		float margin;
+	};
+
+	// traversal stack on the caller's stack frame so queries can run on several
+	// threads at once. the tree is kept balanced, so its height stays far below
+	// the capacity (two entries per level)
+
+	struct TreeStack {
+		static constexpr int CAPACITY = 256;
+		std::uint32_t items[CAPACITY];
+		int count = 0;
+		void push(std::uint32_t index) { assert(count < CAPACITY); items[count++] = index; }
+		std::uint32_t pop() { return items[--count]; }
+		bool empty() const { return count == 0; }
+	};
+
+	template <typename Callback>
+	void DynamicTree::query(const Aabb& box, Callback&& callback) const {
+		if (root == NULL_NODE) {
+			return;
+		}
+		TreeStack stack;
+		stack.push(root);
+		while (!stack.empty()) {
+			std::uint32_t index = stack.pop();
+			const Node& node = nodes[index];
+			if (!overlaps(node.box, box)) {
+				continue;
+			}
+			if (node.isLeaf()) {
+				if (!callback(static_cast<ProxyId>(index))) {
+					return;
+				}
+			}
+			else {
+				stack.push(node.child1);
+				stack.push(node.child2);
+			}
+		}
+	}
+
+	template <typename Callback>
+	void DynamicTree::queryBatch(const Aabb* boxes, std::size_t count, Callback&& callback) const {
+		for (std::size_t i = 0; i < count; i++) {
+			query(boxes[i], [&](ProxyId proxy) { return callback(i, proxy); });
+		}
+	}
+
+	template <typename Callback>
+	void DynamicTree::rayCast(const Vec2& p1, const Vec2& p2, Callback&& callback) const {
+		if (root == NULL_NODE) {
+			return;
+		}
+		Vec2 d = p2 - p1;
+		float maxFraction = 1.0f;
+		TreeStack stack;
+		stack.push(root);
+		while (!stack.empty()) {
+			std::uint32_t index = stack.pop();
+			const Node& node = nodes[index];
+			// slab test of the segment [p1, p1 + d * maxFraction] against the node box
+			float tMin = 0.0f;
+			float tMax = maxFraction;
+			bool hit = true;
+			const float origin[2] = { p1.x, p1.y };
+			const float dir[2] = { d.x, d.y };
+			const float lo[2] = { node.box.min.x, node.box.min.y };
+			const float hi[2] = { node.box.max.x, node.box.max.y };
+			for (int axis = 0; axis < 2 && hit; axis++) {
+				if (dir[axis] == 0.0f) {
+					hit = origin[axis] >= lo[axis] && origin[axis] <= hi[axis];
+					continue;
+				}
+				float inv = 1.0f / dir[axis];
+				float t1 = (lo[axis] - origin[axis]) * inv;
+				float t2 = (hi[axis] - origin[axis]) * inv;
+				if (t1 > t2) {
+					float t = t1; t1 = t2; t2 = t;
+				}
+				tMin = t1 > tMin ? t1 : tMin;
+				tMax = t2 < tMax ? t2 : tMax;
+				hit = tMin <= tMax;
+			}
+			if (!hit) {
+				continue;
+			}
+			if (node.isLeaf()) {
+				float value = callback(static_cast<ProxyId>(index), maxFraction);
+				if (value == 0.0f) {
+					return;
+				}
+				if (value > 0.0f && value < maxFraction) {
+					maxFraction = value;
+				}
+			}
+			else {
+				stack.push(node.child1);
+				stack.push(node.child2);
+			}
+		}
+	}
+
+}
@@ -0,0 +1,56 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// fixed timestep accumulator for the physics world -->
+
+#include "physics/fixed_stepper.h"
+
+namespace psix {
+
+	FixedStepper::FixedStepper(const StepperSettings& settings) {
+		setSettings(settings);
+	}
+
+	int FixedStepper::advance(double frameSeconds) {
+		// negative deltas can come from clock adjustments, ignore them
+		if (frameSeconds > 0.0) {
+			accumulator += frameSeconds;
+		}
+		int steps = static_cast<int>(accumulator / settings.fixedDt);
+		if (steps > settings.maxSubsteps) {
+			// the simulation cannot keep up, drop the backlog instead of
+			// running more and more steps each frame (spiral of death)
+			double excess = (steps - settings.maxSubsteps) * settings.fixedDt;
+			accumulator -= excess;
+			totalDropped += excess;
+			steps = settings.maxSubsteps;
+		}
+		accumulator -= steps * settings.fixedDt;
+		totalSteps += steps;
+		return steps;
+	}
+
+	float FixedStepper::alpha() const {
+		double a = accumulator / settings.fixedDt;
+		if (a < 0.0) {
+			return 0.0f;
+		}
+		return a >= 1.0 ? 1.0f : static_cast<float>(a);
+	}
+
+	void FixedStepper::setSettings(const StepperSettings& newSettings) {
+		settings = newSettings;
+		if (settings.fixedDt <= 0.0) {
+			settings.fixedDt = 1.0 / 120.0;
+		}
+		if (settings.maxSubsteps < 1) {
+			settings.maxSubsteps = 1;
+		}
+	}
+
+	void FixedStepper::reset() {
+		accumulator = 0.0;
+		totalSteps = 0;
+		totalDropped = 0.0;
+	}
+
+}
@@ -0,0 +1,40 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// fixed timestep accumulator for the physics world -->
+
+#pragma once
+
+namespace psix {
+
+	// settings for the fixed timestep stepper
+
+	struct StepperSettings {
+		double fixedDt = 1.0 / 120.0;	// simulation step length in seconds
+		int maxSubsteps = 8;			// upper bound of steps per frame (spiral of death clamp)
+	};
+
+	// accumulates wall time and hands out whole fixed steps, the leftover
+	// fraction is used to interpolate render state between the last two steps
+
+	class FixedStepper {
+	public:
+		explicit FixedStepper(const StepperSettings& settings = StepperSettings());
+		// feed the wall time of one frame, returns the number of fixed steps to run
+		int advance(double frameSeconds);
+		// interpolation factor between the previous and current physics state [0, 1)
+		float alpha() const;
+		double fixedDt() const { return settings.fixedDt; }
+		int maxSubsteps() const { return settings.maxSubsteps; }
+		void setSettings(const StepperSettings& newSettings);
+		// total steps taken and time discarded by the substep clamp
+		unsigned long long stepCount() const { return totalSteps; }
+		double droppedSeconds() const { return totalDropped; }
+		void reset();
+	private:
+		StepperSettings settings;
+		double accumulator = 0.0;
+		unsigned long long totalSteps = 0;
+		double totalDropped = 0.0;
+	};
+
+}
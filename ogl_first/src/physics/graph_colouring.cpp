@@ -0,0 +1,62 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// greedy graph colouring of constraints for parallel solving -->
+
+#include "physics/graph_colouring.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace psix {
+
+	static inline std::uint32_t lowestZeroBit(std::uint64_t mask) {
+		std::uint64_t free = ~mask;
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, free);
+		return static_cast<std::uint32_t>(index);
+#else
+		return static_cast<std::uint32_t>(__builtin_ctzll(free));
+#endif
+	}
+
+	void GraphColouring::begin(std::size_t bodyCount) {
+		if (bodyMasks.size() < bodyCount) {
+			bodyMasks.resize(bodyCount, 0);
+		}
+		for (BodyId id : touched) {
+			bodyMasks[id] = 0;
+		}
+		touched.clear();
+		usedColours = 0;
+		overflow = 0;
+	}
+
+	std::uint32_t GraphColouring::colour(const BodyId* ids, std::size_t count, const float* inverseMass) {
+		std::uint64_t mask = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			if (inverseMass[ids[i]] > 0.0f) {
+				mask |= bodyMasks[ids[i]];
+			}
+		}
+		if (mask == ~std::uint64_t(0)) {
+			overflow++;
+			return OVERFLOW_COLOUR;
+		}
+		std::uint32_t colour = lowestZeroBit(mask);
+		const std::uint64_t bit = std::uint64_t(1) << colour;
+		for (std::size_t i = 0; i < count; i++) {
+			BodyId id = ids[i];
+			if (inverseMass[id] > 0.0f) {
+				if (bodyMasks[id] == 0) {
+					touched.push_back(id);
+				}
+				bodyMasks[id] |= bit;
+			}
+		}
+		usedColours = colour + 1 > usedColours ? colour + 1 : usedColours;
+		return colour;
+	}
+
+}
@@ -0,0 +1,39 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// greedy graph colouring of constraints for parallel solving -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "physics/body_store.h"
+
+namespace psix {
+
+	// colours are bits of a 64 bit mask per body, constraints that find no free
+	// colour go to the overflow colour, which is solved on one thread
+	constexpr std::uint32_t MAX_COLOURS = 64;
+	constexpr std::uint32_t OVERFLOW_COLOUR = MAX_COLOURS;
+
+	// constraints of one colour share no movable body, so a colour can be split
+	// over threads without atomics. immovable bodies (inverse mass 0) are only
+	// read by the solvers and do not take part
+
+	class GraphColouring {
+	public:
+		// start a new colouring, only the masks of bodies used by the last one are cleared
+		void begin(std::size_t bodyCount);
+		// lowest colour none of the bodies uses yet, the bodies are marked with it
+		std::uint32_t colour(const BodyId* ids, std::size_t count, const float* inverseMass);
+		// colours handed out so far, without the overflow colour
+		std::uint32_t colourCount() const { return usedColours; }
+		std::size_t overflowCount() const { return overflow; }
+	private:
+		std::vector<std::uint64_t> bodyMasks;
+		std::vector<BodyId> touched;
+		std::uint32_t usedColours = 0;
+		std::size_t overflow = 0;
+	};
+
+}
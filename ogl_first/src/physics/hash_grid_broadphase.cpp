@@ -0,0 +1,334 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// uniform spatial hash grid broadphase for many similarly sized bodies -->
+
+#include "physics/hash_grid_broadphase.h"
+#include <algorithm>
+#include <cmath>
+
+namespace psix {
+
+	HashGridBroadphase::HashGridBroadphase(const HashGridSettings& settings) : settings(settings) {
+	}
+
+	static inline std::int32_t cellCoordinate(float scaled) {
+		// floor without the libm call, truncation rounds toward zero
+		std::int32_t truncated = static_cast<std::int32_t>(scaled);
+		return truncated - (scaled < static_cast<float>(truncated) ? 1 : 0);
+	}
+
+	static inline std::uint32_t cellHash(std::int32_t cx, std::int32_t cy, std::uint32_t mask) {
+		// rows are scattered over the table but cells along a row stay in
+		// consecutive buckets, so the sorted order walks space coherently and the
+		// forward neighbours of a cell land in two runs of buckets instead of four
+		std::uint32_t h = static_cast<std::uint32_t>(cx) + static_cast<std::uint32_t>(cy) * 0x9e3779b1u;
+		return h & mask;
+	}
+
+	std::uint32_t HashGridBroadphase::hashCell(std::int32_t cx, std::int32_t cy) const {
+		return cellHash(cx, cy, bucketMask);
+	}
+
+	static std::size_t bucketsFor(std::size_t bodyCount) {
+		// two buckets per body keeps collisions rare
+		std::size_t buckets = 64;
+		while (buckets < bodyCount * 2) {
+			buckets <<= 1;
+		}
+		return buckets;
+	}
+
+	void HashGridBroadphase::resizeScratch(std::size_t awakeCount, std::size_t bodyCount) {
+		// the table follows the awake count so clearing it stays O(awake), the
+		// vectors keep their capacity and other sizes only ever grow
+		const std::size_t buckets = bucketsFor(awakeCount);
+		cellCount.resize(buckets);
+		cellStart.resize(buckets + 1);
+		bucketMask = static_cast<std::uint32_t>(buckets - 1);
+		if (awakeCount > sorted.size()) {
+			bodyBucket.resize(awakeCount);
+			sorted.resize(awakeCount);
+		}
+		if (bodyCount > bodySlot.size()) {
+			bodySlot.resize(bodyCount);
+		}
+	}
+
+	// ---------------------------------------- sleeping grid ----------------------------------------
+
+	void HashGridBroadphase::insertSleeping(const BodyStore& bodies, BodyId id) {
+		const float inverseCell = 1.0f / sleepingCellSize;
+		SleepingBody& entry = sleeping[id];
+		entry.x = bodies.positionX[id];
+		entry.y = bodies.positionY[id];
+		entry.radius = bodies.radius[id];
+		entry.cellX = cellCoordinate(entry.x * inverseCell);
+		entry.cellY = cellCoordinate(entry.y * inverseCell);
+		const std::uint32_t bucket = cellHash(entry.cellX, entry.cellY, sleepingMask);
+		entry.previous = NO_BUCKET;
+		entry.next = sleepingHead[bucket];
+		if (entry.next != NO_BUCKET) {
+			sleeping[entry.next].previous = id;
+		}
+		sleepingHead[bucket] = id;
+		sleepingBucket[id] = bucket;
+		sleepingCount++;
+	}
+
+	void HashGridBroadphase::removeSleeping(BodyId id) {
+		const std::uint32_t bucket = sleepingBucket[id];
+		if (bucket == NO_BUCKET) {
+			return;
+		}
+		const SleepingBody& entry = sleeping[id];
+		if (entry.previous != NO_BUCKET) {
+			sleeping[entry.previous].next = entry.next;
+		}
+		else {
+			sleepingHead[bucket] = entry.next;
+		}
+		if (entry.next != NO_BUCKET) {
+			sleeping[entry.next].previous = entry.previous;
+		}
+		sleepingBucket[id] = NO_BUCKET;
+		sleepingCount--;
+	}
+
+	void HashGridBroadphase::rebuildSleeping(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) {
+		const std::size_t count = bodies.size();
+		const std::size_t buckets = bucketsFor(count);
+		sleepingHead.assign(buckets, NO_BUCKET);
+		sleepingMask = static_cast<std::uint32_t>(buckets - 1);
+		sleeping.resize(count);
+		sleepingBucket.assign(count, NO_BUCKET);
+		sleepingCount = 0;
+		sleepingCellSize = activeCellSize;
+		std::size_t next = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			if (next < awakeBodies.size() && awakeBodies[next] == i) {
+				next++;
+				continue;
+			}
+			insertSleeping(bodies, static_cast<BodyId>(i));
+		}
+		knownBodyCount = count;
+	}
+
+	void HashGridBroadphase::updateSleeping(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies, float awakeRadius) {
+		const float* radius = bodies.radius.data();
+		const std::size_t count = bodies.size();
+		// a changed body count rebuilds, otherwise only the bodies that fell asleep
+		// or woke up since the last step are touched (merge of two sorted lists)
+		bool rebuild = count != knownBodyCount;
+		fellAsleep.clear();
+		if (rebuild) {
+			sleepingRadius = 0.0f;
+			std::size_t next = 0;
+			for (std::size_t i = 0; i < count; i++) {
+				if (next < awakeBodies.size() && awakeBodies[next] == i) {
+					next++;
+				}
+				else {
+					sleepingRadius = radius[i] > sleepingRadius ? radius[i] : sleepingRadius;
+				}
+			}
+		}
+		else {
+			std::size_t i = 0;
+			std::size_t j = 0;
+			while (i < previousAwake.size() || j < awakeBodies.size()) {
+				if (j == awakeBodies.size() || (i < previousAwake.size() && previousAwake[i] < awakeBodies[j])) {
+					fellAsleep.push_back(previousAwake[i++]);
+				}
+				else if (i == previousAwake.size() || awakeBodies[j] < previousAwake[i]) {
+					removeSleeping(awakeBodies[j++]);
+				}
+				else {
+					i++;
+					j++;
+				}
+			}
+			if (sleepingCount == 0) {
+				sleepingRadius = 0.0f;
+			}
+			for (BodyId id : fellAsleep) {
+				sleepingRadius = radius[id] > sleepingRadius ? radius[id] : sleepingRadius;
+			}
+		}
+		previousAwake.assign(awakeBodies.begin(), awakeBodies.end());
+		// the 3x3 neighbourhood only covers every overlap if a cell is at least one diameter wide
+		float maxRadius = awakeRadius > sleepingRadius ? awakeRadius : sleepingRadius;
+		maxRadius += contactMargin;
+		activeCellSize = settings.cellSize > 2.0f * maxRadius ? settings.cellSize : 2.0f * maxRadius;
+		if (activeCellSize <= 0.0f) {
+			activeCellSize = 1.0f;
+		}
+		if (rebuild) {
+			rebuildSleeping(bodies, awakeBodies);
+			return;
+		}
+		if (sleepingCount == 0) {
+			sleepingCellSize = activeCellSize;
+		}
+		else if (activeCellSize < sleepingCellSize) {
+			// wider cells still cover every overlap, keep the sleeping grid as it is
+			activeCellSize = sleepingCellSize;
+		}
+		else if (activeCellSize > sleepingCellSize) {
+			rebuildSleeping(bodies, awakeBodies);
+			return;
+		}
+		for (BodyId id : fellAsleep) {
+			insertSleeping(bodies, id);
+		}
+	}
+
+	// ---------------------------------------- awake grid ----------------------------------------
+
+	void HashGridBroadphase::update(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) {
+		candidatePairs.clear();
+		const std::size_t count = bodies.size();
+		if (count < 2) {
+			knownBodyCount = 0;
+			return;
+		}
+		const std::size_t awakeCount = awakeBodies.size();
+		resizeScratch(awakeCount, count);
+		const float* positionX = bodies.positionX.data();
+		const float* positionY = bodies.positionY.data();
+		const float* radius = bodies.radius.data();
+		float awakeRadius = 0.0f;
+		for (BodyId id : awakeBodies) {
+			awakeRadius = radius[id] > awakeRadius ? radius[id] : awakeRadius;
+		}
+		updateSleeping(bodies, awakeBodies, awakeRadius);
+		if (awakeCount == 0) {
+			return;
+		}
+		const float inverseCell = 1.0f / activeCellSize;
+		// counting sort: count awake bodies per bucket
+		std::fill(cellCount.begin(), cellCount.end(), 0u);
+		for (std::size_t k = 0; k < awakeCount; k++) {
+			const BodyId id = awakeBodies[k];
+			std::uint32_t bucket = hashCell(cellCoordinate(positionX[id] * inverseCell), cellCoordinate(positionY[id] * inverseCell));
+			bodyBucket[k] = bucket;
+			cellCount[bucket]++;
+		}
+		// exclusive prefix sum gives the first slot of every bucket
+		std::uint32_t running = 0;
+		for (std::size_t b = 0; b < cellCount.size(); b++) {
+			cellStart[b] = running;
+			running += cellCount[b];
+			cellCount[b] = cellStart[b];	// reused as the scatter cursor
+		}
+		cellStart[cellCount.size()] = running;
+		// scatter bodies into their bucket ranges
+		for (std::size_t k = 0; k < awakeCount; k++) {
+			const BodyId id = awakeBodies[k];
+			bodySlot[id] = cellCount[bodyBucket[k]]++;
+			SortedBody& entry = sorted[bodySlot[id]];
+			entry.x = positionX[id];
+			entry.y = positionY[id];
+			entry.radius = radius[id] + contactMargin;
+			entry.cellX = cellCoordinate(positionX[id] * inverseCell);
+			entry.cellY = cellCoordinate(positionY[id] * inverseCell);
+			entry.id = id;
+		}
+		const std::uint32_t bucketTotal = static_cast<std::uint32_t>(cellCount.size());
+		if (sleepingCount > 0) {
+			// an awake body has to look at the whole block to find its sleeping
+			// neighbours, pairs of two awake bodies are kept from the lower id
+			gatherPairs(awakeCount, [&](std::vector<BodyPair>& output, std::size_t first, std::size_t last) {
+				for (std::size_t k = first; k < last; k++) {
+					scanBlock(output, bodySlot[awakeBodies[k]]);
+				}
+			});
+			return;
+		}
+		// each body looks at its own cell and the four cells after it (half of the
+		// 3x3 block), so every pair is visited exactly once. the right neighbour
+		// always hashes to the next bucket and the three cells above to three
+		// consecutive buckets, so this is two linear scans per body. buckets are
+		// shared by cells with the same hash, entries from other rows are skipped
+		gatherPairs(awakeCount, [&](std::vector<BodyPair>& output, std::size_t first, std::size_t last) {
+			for (std::size_t s = first; s < last; s++) {
+				const std::int32_t cx = sorted[s].cellX;
+				const std::int32_t cy = sorted[s].cellY;
+				const std::uint32_t bucket = hashCell(cx, cy);
+				// own cell after this body plus the right neighbour
+				if (bucket + 1 < bucketTotal) {
+					scanRange(output, s, static_cast<std::uint32_t>(s) + 1, cellStart[bucket + 2], cx, cy);
+				}
+				else {
+					scanRange(output, s, static_cast<std::uint32_t>(s) + 1, cellStart[bucketTotal], cx, cy);
+					scanRange(output, s, cellStart[0], cellStart[1], cx, cy);
+				}
+				// the three cells of the row above
+				const std::uint32_t above = hashCell(cx, cy + 1);
+				if (above >= 1 && above + 2 <= bucketTotal) {
+					scanRange(output, s, cellStart[above - 1], cellStart[above + 2], cx, cy + 1);
+				}
+				else {
+					for (std::uint32_t n = 0; n < 3; n++) {
+						std::uint32_t b = (above + bucketTotal - 1 + n) & bucketMask;
+						scanRange(output, s, cellStart[b], cellStart[b + 1], cx, cy + 1);
+					}
+				}
+			}
+		});
+	}
+
+	inline void HashGridBroadphase::scanRange(std::vector<BodyPair>& output, std::size_t s, std::uint32_t begin, std::uint32_t end, std::int32_t cx, std::int32_t row) const {
+		const SortedBody self = sorted[s];
+		// the own row accepts the own cell and the one to the right, the row above accepts all three
+		const std::int32_t minX = row == self.cellY ? cx : cx - 1;
+		const std::uint32_t width = static_cast<std::uint32_t>(cx + 1 - minX);
+		for (std::uint32_t t = begin; t < end; t++) {
+			const SortedBody& other = sorted[t];
+			const float reach = self.radius + other.radius;
+			const bool sameRow = other.cellY == row;
+			const bool inRange = static_cast<std::uint32_t>(other.cellX - minX) <= width;
+			const bool touching = (std::fabs(other.x - self.x) <= reach) & (std::fabs(other.y - self.y) <= reach);
+			if (sameRow & inRange & touching) {
+				output.push_back(makeBodyPair(self.id, other.id));
+			}
+		}
+	}
+
+	void HashGridBroadphase::scanBlock(std::vector<BodyPair>& output, std::size_t s) const {
+		const SortedBody self = sorted[s];
+		for (std::int32_t row = self.cellY - 1; row <= self.cellY + 1; row++) {
+			const std::uint32_t left = hashCell(self.cellX - 1, row);
+			for (std::uint32_t n = 0; n < 3; n++) {
+				std::uint32_t b = (left + n) & bucketMask;
+				for (std::uint32_t t = cellStart[b]; t < cellStart[b + 1]; t++) {
+					const SortedBody& other = sorted[t];
+					const float reach = self.radius + other.radius;
+					const bool sameRow = other.cellY == row;
+					const bool inRange = static_cast<std::uint32_t>(other.cellX - self.cellX + 1) <= 2u;
+					const bool touching = (std::fabs(other.x - self.x) <= reach) & (std::fabs(other.y - self.y) <= reach);
+					if (sameRow & inRange & touching & (other.id > self.id)) {
+						output.push_back(makeBodyPair(self.id, other.id));
+					}
+				}
+			}
+		}
+		// sleeping neighbours, every pair with a sleeping body is reported from the awake one
+		for (std::int32_t row = self.cellY - 1; row <= self.cellY + 1; row++) {
+			for (std::int32_t column = self.cellX - 1; column <= self.cellX + 1; column++) {
+				BodyId t = sleepingHead[cellHash(column, row, sleepingMask)];
+				while (t != NO_BUCKET) {
+					const SleepingBody& other = sleeping[t];
+					const float reach = self.radius + (other.radius + contactMargin);
+					const bool sameCell = (other.cellX == column) & (other.cellY == row);
+					const bool touching = (std::fabs(other.x - self.x) <= reach) & (std::fabs(other.y - self.y) <= reach);
+					if (sameCell & touching) {
+						output.push_back(makeBodyPair(self.id, t));
+					}
+					t = other.next;
+				}
+			}
+		}
+	}
+
+}
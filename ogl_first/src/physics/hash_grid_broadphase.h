@@ -0,0 +1,79 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// uniform spatial hash grid broadphase for many similarly sized bodies -->
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "physics/broadphase.h"
+
+namespace psix {
+
+	// awake bodies are counting-sorted into hashed cells every step, a body is
+	// tested against the half of the 3x3 block of cells around it. sleeping
+	// bodies do not move, they live in a second grid of per cell lists that only
+	// changes when a body falls asleep or wakes up, so a step costs O(awake)
+	// once most of the scene sleeps. awake bodies then scan the whole block of
+	// both grids. all scratch storage is kept between steps, so steady state
+	// updates do not touch the heap
+
+	class HashGridBroadphase : public Broadphase {
+	public:
+		explicit HashGridBroadphase(const HashGridSettings& settings = HashGridSettings());
+		const char* name() const override { return "hash grid"; }
+		void update(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) override;
+		float cellSize() const { return activeCellSize; }
+		std::size_t bucketCount() const { return cellCount.size(); }
+	private:
+		static constexpr std::uint32_t NO_BUCKET = 0xffffffffu;
+		std::uint32_t hashCell(std::int32_t cx, std::int32_t cy) const;
+		void resizeScratch(std::size_t awakeCount, std::size_t bodyCount);
+		void updateSleeping(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies, float awakeRadius);
+		void rebuildSleeping(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies);
+		void insertSleeping(const BodyStore& bodies, BodyId id);
+		void removeSleeping(BodyId id);
+		void scanRange(std::vector<BodyPair>& output, std::size_t s, std::uint32_t begin, std::uint32_t end, std::int32_t cx, std::int32_t row) const;
+		void scanBlock(std::vector<BodyPair>& output, std::size_t s) const;
+
+		HashGridSettings settings;
+		float activeCellSize = 0.0f;
+		std::uint32_t bucketMask = 0;
+		std::vector<std::uint32_t> cellCount;	// prefix sums after the counting pass
+		std::vector<std::uint32_t> cellStart;
+		std::vector<std::uint32_t> bodyBucket;	// by index into the awake list
+		std::vector<std::uint32_t> bodySlot;	// position of an awake body in sorted
+		// body data gathered in bucket order, one entry per body so a pair test
+		// touches a single cache line of the candidate
+		struct SortedBody {
+			float x;
+			float y;
+			float radius;
+			std::int32_t cellX;
+			std::int32_t cellY;
+			BodyId id;
+		};
+		std::vector<SortedBody> sorted;
+		// sleeping grid, entries are indexed by body id and linked per bucket
+		struct SleepingBody {
+			float x;
+			float y;
+			float radius;
+			std::int32_t cellX;
+			std::int32_t cellY;
+			BodyId next;
+			BodyId previous;
+		};
+		std::vector<SleepingBody> sleeping;
+		std::vector<std::uint32_t> sleepingBucket;	// NO_BUCKET while the body is awake
+		std::vector<BodyId> sleepingHead;
+		std::uint32_t sleepingMask = 0;
+		std::size_t sleepingCount = 0;
+		float sleepingCellSize = 0.0f;
+		float sleepingRadius = 0.0f;	// largest sleeping radius, only shrinks on a rebuild
+		std::size_t knownBodyCount = 0;
+		std::vector<BodyId> previousAwake;
+		std::vector<BodyId> fellAsleep;
+	};
+
+}
@@ -0,0 +1,169 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// semi-implicit euler integration kernels over the body store -->
+
+#include "physics/integrator.h"
+#include "core/cpu_features.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PSIX_HAS_AVX2_KERNEL 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define PSIX_TARGET_AVX2
+#else
+#define PSIX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace psix {
+
+	IntegrateArgs makeIntegrateArgs(BodyStore& bodies, const Vec2& gravity, float dt) {
+		IntegrateArgs args;
+		args.positionX = bodies.positionX.data();
+		args.positionY = bodies.positionY.data();
+		args.velocityX = bodies.velocityX.data();
+		args.velocityY = bodies.velocityY.data();
+		args.forceX = bodies.forceX.data();
+		args.forceY = bodies.forceY.data();
+		args.inverseMass = bodies.inverseMass.data();
+		args.gravity = gravity;
+		args.dt = dt;
+		return args;
+	}
+
+	void integrateVelocitiesScalar(const IntegrateArgs& args, std::size_t begin, std::size_t end) {
+		const float dt = args.dt;
+		for (std::size_t i = begin; i < end; i++) {
+			float invMass = args.inverseMass[i];
+			float gravityScale = invMass > 0.0f ? 1.0f : 0.0f;
+			args.velocityX[i] += (args.forceX[i] * invMass + args.gravity.x * gravityScale) * dt;
+			args.velocityY[i] += (args.forceY[i] * invMass + args.gravity.y * gravityScale) * dt;
+			args.forceX[i] = 0.0f;
+			args.forceY[i] = 0.0f;
+		}
+	}
+
+	void integratePositionsScalar(const IntegrateArgs& args, std::size_t begin, std::size_t end) {
+		const float dt = args.dt;
+		for (std::size_t i = begin; i < end; i++) {
+			args.positionX[i] += args.velocityX[i] * dt;
+			args.positionY[i] += args.velocityY[i] * dt;
+		}
+	}
+
+#if defined(PSIX_HAS_AVX2_KERNEL)
+
+	// first index at or after begin that is a multiple of 8 (aligned lane start)
+	static std::size_t alignedStart(std::size_t begin, std::size_t end) {
+		std::size_t aligned = (begin + 7) & ~static_cast<std::size_t>(7);
+		return aligned < end ? aligned : end;
+	}
+
+	PSIX_TARGET_AVX2 static void integrateVelocitiesAvx2Kernel(const IntegrateArgs& args, std::size_t begin, std::size_t end) {
+		// peel bodies up to the next multiple of 8 so the loads below stay aligned
+		std::size_t i = alignedStart(begin, end);
+		integrateVelocitiesScalar(args, begin, i);
+		const std::size_t simdEnd = i + ((end - i) & ~static_cast<std::size_t>(7));
+		const __m256 dt = _mm256_set1_ps(args.dt);
+		const __m256 gravityX = _mm256_set1_ps(args.gravity.x);
+		const __m256 gravityY = _mm256_set1_ps(args.gravity.y);
+		const __m256 zero = _mm256_setzero_ps();
+		for (; i < simdEnd; i += 8) {
+			__m256 invMass = _mm256_load_ps(args.inverseMass + i);
+			// gravity masked off for static bodies (inverse mass == 0)
+			__m256 dynamicMask = _mm256_cmp_ps(invMass, zero, _CMP_GT_OQ);
+			__m256 accelX = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(args.forceX + i), invMass), _mm256_and_ps(gravityX, dynamicMask));
+			__m256 accelY = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(args.forceY + i), invMass), _mm256_and_ps(gravityY, dynamicMask));
+			_mm256_store_ps(args.velocityX + i, _mm256_add_ps(_mm256_load_ps(args.velocityX + i), _mm256_mul_ps(accelX, dt)));
+			_mm256_store_ps(args.velocityY + i, _mm256_add_ps(_mm256_load_ps(args.velocityY + i), _mm256_mul_ps(accelY, dt)));
+			_mm256_store_ps(args.forceX + i, zero);
+			_mm256_store_ps(args.forceY + i, zero);
+		}
+		integrateVelocitiesScalar(args, i, end);
+	}
+
+	PSIX_TARGET_AVX2 static void integratePositionsAvx2Kernel(const IntegrateArgs& args, std::size_t begin, std::size_t end) {
+		std::size_t i = alignedStart(begin, end);
+		integratePositionsScalar(args, begin, i);
+		const std::size_t simdEnd = i + ((end - i) & ~static_cast<std::size_t>(7));
+		const __m256 dt = _mm256_set1_ps(args.dt);
+		for (; i < simdEnd; i += 8) {
+			_mm256_store_ps(args.positionX + i, _mm256_add_ps(_mm256_load_ps(args.positionX + i), _mm256_mul_ps(_mm256_load_ps(args.velocityX + i), dt)));
+			_mm256_store_ps(args.positionY + i, _mm256_add_ps(_mm256_load_ps(args.positionY + i), _mm256_mul_ps(_mm256_load_ps(args.velocityY + i), dt)));
+		}
+		integratePositionsScalar(args, i, end);
+	}
+
+#endif
+
+	void integrateVelocitiesAvx2(const IntegrateArgs& args, std::size_t begin, std::size_t end) {
+#if defined(PSIX_HAS_AVX2_KERNEL)
+		if (cpuFeatures().avx2) {
+			integrateVelocitiesAvx2Kernel(args, begin, end);
+			return;
+		}
+#endif
+		integrateVelocitiesScalar(args, begin, end);
+	}
+
+	void integratePositionsAvx2(const IntegrateArgs& args, std::size_t begin, std::size_t end) {
+#if defined(PSIX_HAS_AVX2_KERNEL)
+		if (cpuFeatures().avx2) {
+			integratePositionsAvx2Kernel(args, begin, end);
+			return;
+		}
+#endif
+		integratePositionsScalar(args, begin, end);
+	}
+
+	static IntegratorPath resolvePath(IntegratorPath path) {
+#if defined(PSIX_HAS_AVX2_KERNEL)
+		if (path != IntegratorPath::Scalar && cpuFeatures().avx2) {
+			return IntegratorPath::Avx2;
+		}
+#endif
+		return IntegratorPath::Scalar;
+	}
+
+	static IntegratorPath selectedPath = resolvePath(IntegratorPath::Auto);
+
+	void integrateVelocities(const IntegrateArgs& args, std::size_t begin, std::size_t end) {
+#if defined(PSIX_HAS_AVX2_KERNEL)
+		if (selectedPath == IntegratorPath::Avx2) {
+			integrateVelocitiesAvx2Kernel(args, begin, end);
+			return;
+		}
+#endif
+		integrateVelocitiesScalar(args, begin, end);
+	}
+
+	void integratePositions(const IntegrateArgs& args, std::size_t begin, std::size_t end) {
+#if defined(PSIX_HAS_AVX2_KERNEL)
+		if (selectedPath == IntegratorPath::Avx2) {
+			integratePositionsAvx2Kernel(args, begin, end);
+			return;
+		}
+#endif
+		integratePositionsScalar(args, begin, end);
+	}
+
+	void setIntegratorPath(IntegratorPath path) {
+		selectedPath = resolvePath(path);
+	}
+
+	IntegratorPath activeIntegratorPath() {
+		return selectedPath;
+	}
+
+	const char* integratorPathName(IntegratorPath path) {
+		switch (path) {
+		case IntegratorPath::Avx2:
+			return "avx2";
+		case IntegratorPath::Scalar:
+			return "scalar";
+		default:
+			return "auto";
+		}
+	}
+
+}
@@ -0,0 +1,52 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// semi-implicit euler integration kernels over the body store -->
+
+#pragma once
+
+#include <cstddef>
+#include "physics/body_store.h"
+
+namespace psix {
+
+	enum class IntegratorPath {
+		Auto,	// pick the widest path the CPU supports
+		Scalar,
+		Avx2
+	};
+
+	// raw pointers into the body store, kernels work on [begin, end)
+
+	struct IntegrateArgs {
+		float* positionX;
+		float* positionY;
+		float* velocityX;
+		float* velocityY;
+		float* forceX;
+		float* forceY;
+		const float* inverseMass;
+		Vec2 gravity;
+		float dt;
+	};
+
+	IntegrateArgs makeIntegrateArgs(BodyStore& bodies, const Vec2& gravity, float dt);
+
+	// the step is split so the contact solver can run between the two halves:
+	// velocities: v += (f * invMass + g) * dt, forces are cleared afterwards.
+	// gravity only acts on bodies with a non-zero inverse mass
+	void integrateVelocitiesScalar(const IntegrateArgs& args, std::size_t begin, std::size_t end);
+	// positions: x += v * dt
+	void integratePositionsScalar(const IntegrateArgs& args, std::size_t begin, std::size_t end);
+	// 8 bodies per instruction, unaligned head and tail go through the scalar kernels
+	void integrateVelocitiesAvx2(const IntegrateArgs& args, std::size_t begin, std::size_t end);
+	void integratePositionsAvx2(const IntegrateArgs& args, std::size_t begin, std::size_t end);
+
+	// run the kernels of the path selected at runtime via CPUID
+	void integrateVelocities(const IntegrateArgs& args, std::size_t begin, std::size_t end);
+	void integratePositions(const IntegrateArgs& args, std::size_t begin, std::size_t end);
+	// force a path (used by benchmarks), Avx2 falls back to Scalar when unsupported
+	void setIntegratorPath(IntegratorPath path);
+	IntegratorPath activeIntegratorPath();
+	const char* integratorPathName(IntegratorPath path);
+
+}
@@ -0,0 +1,248 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// simulation islands and body sleeping -->
+
+#include "physics/island_manager.h"
+#include <algorithm>
+
+namespace psix {
+
+	constexpr std::uint32_t NO_ISLAND = 0xffffffffu;
+
+	IslandManager::IslandManager(const SleepSettings& settings) : settings(settings) {
+	}
+
+	void IslandManager::addBody(BodyId id) {
+		awakeList.push_back(id);
+		rangesDirty = true;
+	}
+
+	void IslandManager::processWakeRequests(BodyStore& bodies) {
+		for (BodyId id : bodies.wakeRequests) {
+			wakeIsland(bodies, id);
+		}
+		bodies.wakeRequests.clear();
+	}
+
+	bool IslandManager::wakeIsland(BodyStore& bodies, BodyId id) {
+		if (bodies.awake[id] != 0) {
+			return false;
+		}
+		std::uint32_t slot = bodies.sleepingIsland[id];
+		SleepingIsland& island = sleeping[slot];
+		for (BodyId body : island.bodies) {
+			bodies.awake[body] = 1;
+			bodies.sleepTime[body] = 0.0f;
+			bodies.sleepingIsland[body] = NO_ISLAND;
+			wokenBodies.push_back(body);
+		}
+		restored.insert(restored.end(), island.contacts.begin(), island.contacts.end());
+		sleepingBodies -= island.bodies.size();
+		sleepingCount--;
+		island.bodies.clear();
+		island.contacts.clear();
+		freeSlots.push_back(slot);
+		awakeDirty = true;
+		return true;
+	}
+
+	void IslandManager::wakeStaticContacts(BodyStore& bodies, std::uint32_t staticIndex) {
+		for (SleepingIsland& island : sleeping) {
+			for (const ContactManifold& contact : island.contacts) {
+				if (contact.bodyA == NULL_BODY && contact.staticIndex == staticIndex) {
+					wakeIsland(bodies, island.bodies.front());
+					break;
+				}
+			}
+		}
+	}
+
+	void IslandManager::updateAwakeList(const BodyStore& bodies) {
+		if (!awakeDirty) {
+			return;
+		}
+		// drop the bodies that fell asleep and merge in the woken ones
+		std::size_t kept = 0;
+		for (BodyId id : awakeList) {
+			if (bodies.awake[id] != 0) {
+				awakeList[kept++] = id;
+			}
+		}
+		awakeList.resize(kept);
+		awakeList.insert(awakeList.end(), wokenBodies.begin(), wokenBodies.end());
+		std::sort(awakeList.begin(), awakeList.end());
+		wokenBodies.clear();
+		awakeDirty = false;
+		rangesDirty = true;
+	}
+
+	const std::vector<BodyRange>& IslandManager::awakeRanges(std::size_t maxRange) {
+		if (!rangesDirty && rangeLimit == maxRange) {
+			return ranges;
+		}
+		// consecutive ids are merged so the integration kernels keep streaming
+		ranges.clear();
+		for (std::size_t i = 0; i < awakeList.size();) {
+			BodyId begin = awakeList[i];
+			BodyId end = begin + 1;
+			i++;
+			while (i < awakeList.size() && awakeList[i] == end && end % maxRange != 0) {
+				end++;
+				i++;
+			}
+			ranges.push_back(BodyRange{ begin, end });
+		}
+		rangeLimit = maxRange;
+		rangesDirty = false;
+		return ranges;
+	}
+
+	std::uint32_t IslandManager::findRoot(std::uint32_t* parent, std::uint32_t index) const {
+		while (parent[index] != index) {
+			parent[index] = parent[parent[index]];	// path halving
+			index = parent[index];
+		}
+		return index;
+	}
+
+	void IslandManager::build(const BodyStore& bodies, ContactManifold*& manifolds, std::size_t count, const std::vector<BodyPair>& links, LinearArena& arena) {
+		updateAwakeList(bodies);
+		islandList.clear();
+		bodyOrder.clear();
+		const std::size_t awakeCount = awakeList.size();
+		if (awakeCount == 0) {
+			return;
+		}
+		if (localIndex.size() < bodies.size()) {
+			localIndex.resize(bodies.size());
+		}
+		std::uint32_t* parent = arena.allocateArray<std::uint32_t>(awakeCount);
+		for (std::size_t i = 0; i < awakeCount; i++) {
+			localIndex[awakeList[i]] = static_cast<std::uint32_t>(i);
+			parent[i] = static_cast<std::uint32_t>(i);
+		}
+		const float* inverseMass = bodies.inverseMass.data();
+		const std::uint8_t* awake = bodies.awake.data();
+		// only edges between two movable bodies connect islands
+		auto join = [&](BodyId a, BodyId b) {
+			if (inverseMass[a] == 0.0f || inverseMass[b] == 0.0f || awake[a] == 0 || awake[b] == 0) {
+				return;
+			}
+			std::uint32_t rootA = findRoot(parent, localIndex[a]);
+			std::uint32_t rootB = findRoot(parent, localIndex[b]);
+			if (rootA != rootB) {
+				// the lower root wins so the result only depends on the edge order
+				parent[std::max(rootA, rootB)] = std::min(rootA, rootB);
+			}
+		};
+		for (std::size_t m = 0; m < count; m++) {
+			if (manifolds[m].bodyA != NULL_BODY) {
+				join(manifolds[m].bodyA, manifolds[m].bodyB);
+			}
+		}
+		for (const BodyPair& link : links) {
+			join(link.a, link.b);
+		}
+		// islands are numbered in order of their lowest body id
+		std::uint32_t* islandOf = arena.allocateArray<std::uint32_t>(awakeCount);
+		for (std::size_t i = 0; i < awakeCount; i++) {
+			std::uint32_t root = findRoot(parent, static_cast<std::uint32_t>(i));
+			if (root == i) {
+				islandOf[i] = static_cast<std::uint32_t>(islandList.size());
+				islandList.push_back(Island{ 0, 0, 0, 0, 0, false });
+			}
+			else {
+				islandOf[i] = islandOf[root];
+			}
+			islandList[islandOf[i]].bodyCount++;
+		}
+		// bodies and manifolds are counting-sorted by island
+		std::uint32_t running = 0;
+		for (Island& island : islandList) {
+			island.bodyBegin = running;
+			running += island.bodyCount;
+			island.bodyCount = 0;
+		}
+		bodyOrder.resize(awakeCount);
+		for (std::size_t i = 0; i < awakeCount; i++) {
+			Island& island = islandList[islandOf[i]];
+			bodyOrder[island.bodyBegin + island.bodyCount++] = awakeList[i];
+		}
+		std::uint32_t* manifoldIsland = arena.allocateArray<std::uint32_t>(count);
+		for (std::size_t m = 0; m < count; m++) {
+			BodyId a = manifolds[m].bodyA;
+			BodyId owner = a != NULL_BODY && inverseMass[a] > 0.0f ? a : manifolds[m].bodyB;
+			manifoldIsland[m] = islandOf[localIndex[owner]];
+			islandList[manifoldIsland[m]].manifoldCount++;
+		}
+		running = 0;
+		for (Island& island : islandList) {
+			island.manifoldBegin = running;
+			running += island.manifoldCount;
+			island.manifoldCount = 0;
+		}
+		ContactManifold* grouped = arena.allocateArray<ContactManifold>(count);
+		for (std::size_t m = 0; m < count; m++) {
+			Island& island = islandList[manifoldIsland[m]];
+			grouped[island.manifoldBegin + island.manifoldCount++] = manifolds[m];
+		}
+		manifolds = grouped;
+	}
+
+	void IslandManager::updateSleepTimers(BodyStore& bodies, Island& island, float dt) const {
+		const float tolerance = settings.linearTolerance * settings.linearTolerance;
+		float minSleepTime = settings.timeToSleep;
+		for (std::uint32_t i = 0; i < island.bodyCount; i++) {
+			BodyId id = bodyOrder[island.bodyBegin + i];
+			float vx = bodies.velocityX[id];
+			float vy = bodies.velocityY[id];
+			if (vx * vx + vy * vy > tolerance) {
+				bodies.sleepTime[id] = 0.0f;
+			}
+			else {
+				bodies.sleepTime[id] += dt;
+			}
+			minSleepTime = std::min(minSleepTime, bodies.sleepTime[id]);
+		}
+		island.resting = settings.enabled && minSleepTime >= settings.timeToSleep;
+	}
+
+	std::size_t IslandManager::sleepRestingIslands(BodyStore& bodies, const ContactManifold* manifolds) {
+		std::size_t fellAsleep = 0;
+		for (const Island& island : islandList) {
+			if (!island.resting) {
+				continue;
+			}
+			std::uint32_t slot;
+			if (!freeSlots.empty()) {
+				slot = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else {
+				slot = static_cast<std::uint32_t>(sleeping.size());
+				sleeping.emplace_back();
+			}
+			SleepingIsland& target = sleeping[slot];
+			const BodyId* first = bodyOrder.data() + island.bodyBegin;
+			target.bodies.assign(first, first + island.bodyCount);
+			target.contacts.assign(manifolds + island.manifoldBegin, manifolds + island.manifoldBegin + island.manifoldCount);
+			for (BodyId id : target.bodies) {
+				// a sleeping body is frozen exactly where it is, also for rendering
+				bodies.awake[id] = 0;
+				bodies.sleepingIsland[id] = slot;
+				bodies.velocityX[id] = 0.0f;
+				bodies.velocityY[id] = 0.0f;
+				bodies.previousX[id] = bodies.positionX[id];
+				bodies.previousY[id] = bodies.positionY[id];
+			}
+			sleepingBodies += island.bodyCount;
+			sleepingCount++;
+			fellAsleep++;
+		}
+		if (fellAsleep > 0) {
+			awakeDirty = true;
+		}
+		return fellAsleep;
+	}
+
+}
@@ -0,0 +1,106 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// simulation islands and body sleeping -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "core/linear_arena.h"
+#include "physics/broadphase.h"
+#include "physics/body_store.h"
+#include "physics/contact.h"
+
+namespace psix {
+
+	struct SleepSettings {
+		bool enabled = true;
+		float linearTolerance = 0.01f;	// bodies slower than this count as resting
+		float timeToSleep = 0.5f;		// seconds a whole island has to rest before it sleeps
+	};
+
+	// run of consecutive awake body ids [begin, end)
+
+	struct BodyRange {
+		BodyId begin;
+		BodyId end;
+	};
+
+	// awake bodies connected through contacts. islands do not share any body
+	// with a non-zero inverse mass, so each one can be solved on its own thread
+
+	struct Island {
+		std::uint32_t bodyBegin;		// into islandBodies()
+		std::uint32_t bodyCount;
+		std::uint32_t manifoldBegin;	// into the manifolds passed to build()
+		std::uint32_t manifoldCount;
+		std::uint32_t warmStarted;		// written by the solve job
+		bool resting;					// every body rested for timeToSleep
+	};
+
+	// immovable bodies (inverse mass 0) never join an island, they only get one
+	// of their own for the sleep timer. a sleeping island keeps its bodies and
+	// its last contacts, so it can be woken without running the broadphase again
+
+	class IslandManager {
+	public:
+		explicit IslandManager(const SleepSettings& settings = SleepSettings());
+		void setSettings(const SleepSettings& newSettings) { settings = newSettings; }
+		const SleepSettings& sleepSettings() const { return settings; }
+		// new bodies start awake
+		void addBody(BodyId id);
+		// wake the islands of the bodies in the wake requests of the store
+		void processWakeRequests(BodyStore& bodies);
+		// wake the island of a sleeping body, the contacts it went to sleep with
+		// are appended to restoredContacts(). false if the body was awake
+		bool wakeIsland(BodyStore& bodies, BodyId id);
+		// wake every sleeping island resting on a static collider (it is being removed)
+		void wakeStaticContacts(BodyStore& bodies, std::uint32_t staticIndex);
+		std::vector<ContactManifold>& restoredContacts() { return restored; }
+		// applies the sleep and wake changes to the awake list
+		void updateAwakeList(const BodyStore& bodies);
+		// awake bodies sorted by id, and the same set as runs of consecutive ids
+		// split at multiples of maxRange so they can be handed out as jobs
+		const std::vector<BodyId>& awakeBodies() const { return awakeList; }
+		const std::vector<BodyRange>& awakeRanges(std::size_t maxRange);
+		// union-find over the awake bodies, the contacts between them and the
+		// links of joints and constraints. manifolds is replaced by a copy in
+		// the arena grouped by island
+		void build(const BodyStore& bodies, ContactManifold*& manifolds, std::size_t count, const std::vector<BodyPair>& links, LinearArena& arena);
+		Island* islands() { return islandList.data(); }
+		std::size_t islandCount() const { return islandList.size(); }
+		const BodyId* islandBodies() const { return bodyOrder.data(); }
+		// advance the sleep timers of the bodies of one island, islands can be
+		// updated from different threads
+		void updateSleepTimers(BodyStore& bodies, Island& island, float dt) const;
+		// put the resting islands of the last build to sleep, returns how many fell asleep
+		std::size_t sleepRestingIslands(BodyStore& bodies, const ContactManifold* manifolds);
+		std::size_t sleepingIslandCount() const { return sleepingCount; }
+		std::size_t sleepingBodyCount() const { return sleepingBodies; }
+	private:
+		std::uint32_t findRoot(std::uint32_t* parent, std::uint32_t index) const;
+
+		struct SleepingIsland {
+			std::vector<BodyId> bodies;
+			std::vector<ContactManifold> contacts;
+		};
+
+		SleepSettings settings;
+		std::vector<BodyId> awakeList;
+		std::vector<BodyId> wokenBodies;	// woken since the awake list was rebuilt
+		bool awakeDirty = false;
+		std::vector<BodyRange> ranges;
+		std::size_t rangeLimit = 0;
+		bool rangesDirty = true;
+		std::vector<std::uint32_t> localIndex;	// body id -> position in the awake list
+		std::vector<Island> islandList;
+		std::vector<BodyId> bodyOrder;			// awake bodies grouped by island
+		std::vector<SleepingIsland> sleeping;
+		std::vector<std::uint32_t> freeSlots;
+		std::vector<ContactManifold> restored;
+		std::size_t sleepingCount = 0;
+		std::size_t sleepingBodies = 0;
+	};
+
+}
@@ -0,0 +1,71 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// exact contact generation between the collision shapes -->
+
+#include "physics/narrowphase.h"
+#include <algorithm>
+#include <cmath>
+
+namespace psix {
+
+	bool collideCircles(const Vec2& centerA, float radiusA, const Vec2& centerB, float radiusB, ContactManifold& manifold) {
+		Vec2 delta = centerB - centerA;
+		float radii = radiusA + radiusB;
+		float distanceSquared = lengthSquared(delta);
+		if (distanceSquared > radii * radii) {
+			return false;
+		}
+		float distance = std::sqrt(distanceSquared);
+		// coincident centers get an arbitrary but stable normal
+		manifold.normal = distance > 1e-6f ? delta * (1.0f / distance) : Vec2(0.0f, 1.0f);
+		manifold.pointCount = 1;
+		ContactPoint& point = manifold.points[0];
+		point.separation = distance - radii;
+		point.point = centerA + manifold.normal * (radiusA + 0.5f * point.separation);
+		point.featureId = 0;
+		return true;
+	}
+
+	bool collideBoxCircle(const Aabb& box, const Vec2& center, float radius, ContactManifold& manifold) {
+		Vec2 closest(std::clamp(center.x, box.min.x, box.max.x), std::clamp(center.y, box.min.y, box.max.y));
+		Vec2 delta = center - closest;
+		float distanceSquared = lengthSquared(delta);
+		ContactPoint& point = manifold.points[0];
+		if (distanceSquared > 0.0f) {
+			if (distanceSquared > radius * radius) {
+				return false;
+			}
+			float distance = std::sqrt(distanceSquared);
+			manifold.normal = delta * (1.0f / distance);
+			point.separation = distance - radius;
+			// touching a face when one coordinate is strictly inside the box, else a corner
+			bool insideX = center.x > box.min.x && center.x < box.max.x;
+			bool insideY = center.y > box.min.y && center.y < box.max.y;
+			if (insideY) {
+				point.featureId = center.x < box.min.x ? 0 : 1;
+			}
+			else if (insideX) {
+				point.featureId = center.y < box.min.y ? 2 : 3;
+			}
+			else {
+				point.featureId = 4 + (center.x < box.min.x ? 0 : 1) + (center.y < box.min.y ? 0 : 2);
+			}
+		}
+		else {
+			// center inside the box, push out through the nearest face
+			const float distances[4] = { center.x - box.min.x, box.max.x - center.x, center.y - box.min.y, box.max.y - center.y };
+			const Vec2 normals[4] = { Vec2(-1.0f, 0.0f), Vec2(1.0f, 0.0f), Vec2(0.0f, -1.0f), Vec2(0.0f, 1.0f) };
+			int face = 0;
+			for (int i = 1; i < 4; i++) {
+				face = distances[i] < distances[face] ? i : face;
+			}
+			manifold.normal = normals[face];
+			point.separation = -distances[face] - radius;
+			point.featureId = static_cast<std::uint32_t>(face);
+		}
+		manifold.pointCount = 1;
+		point.point = center - manifold.normal * (radius + 0.5f * point.separation);
+		return true;
+	}
+
+}
@@ -0,0 +1,20 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// exact contact generation between the collision shapes -->
+
+#pragma once
+
+#include "physics/aabb.h"
+#include "physics/contact.h"
+
+namespace psix {
+
+	// both fill normal, pointCount and the contact point geometry of the
+	// manifold and return false when the shapes do not touch
+
+	bool collideCircles(const Vec2& centerA, float radiusA, const Vec2& centerB, float radiusB, ContactManifold& manifold);
+	// the box is shape A, the normal points from the box to the circle.
+	// feature ids: 0-3 faces (left, right, bottom, top), 4-7 corners
+	bool collideBoxCircle(const Aabb& box, const Vec2& center, float radius, ContactManifold& manifold);
+
+}
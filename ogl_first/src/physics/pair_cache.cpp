@@ -0,0 +1,121 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// persistent set of overlapping body pairs (open addressing hash set) -->
+
+#include "physics/pair_cache.h"
+
+namespace psix {
+
+	PairCache::PairCache() {
+		entries.assign(64, Entry{ EMPTY_KEY, 0 });
+		mask = entries.size() - 1;
+	}
+
+	std::size_t PairCache::slotOf(std::uint64_t key) const {
+		// 64 bit mix (murmur3 finalizer) so neighbouring ids spread over the table
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdull;
+		key ^= key >> 33;
+		return static_cast<std::size_t>(key) & mask;
+	}
+
+	std::size_t PairCache::probe(std::uint64_t key) const {
+		std::size_t slot = slotOf(key);
+		while (entries[slot].key != EMPTY_KEY && entries[slot].key != key) {
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+
+	bool PairCache::touch(const BodyPair& pair, std::uint32_t stamp) {
+		std::uint64_t key = pairKey(pair);
+		std::size_t slot = probe(key);
+		if (entries[slot].key == key) {
+			entries[slot].value = stamp;
+			return false;
+		}
+		entries[slot] = Entry{ key, stamp };
+		count++;
+		// keep the load factor below one half so probe chains stay short
+		if (count * 2 > entries.size()) {
+			grow();
+		}
+		return true;
+	}
+
+	std::uint32_t* PairCache::find(const BodyPair& pair) {
+		std::size_t slot = probe(pairKey(pair));
+		return entries[slot].key != EMPTY_KEY ? &entries[slot].value : nullptr;
+	}
+
+	const std::uint32_t* PairCache::find(const BodyPair& pair) const {
+		std::size_t slot = probe(pairKey(pair));
+		return entries[slot].key != EMPTY_KEY ? &entries[slot].value : nullptr;
+	}
+
+	bool PairCache::erase(const BodyPair& pair, std::uint32_t& value) {
+		std::size_t slot = probe(pairKey(pair));
+		if (entries[slot].key == EMPTY_KEY) {
+			return false;
+		}
+		value = entries[slot].value;
+		eraseSlot(slot);
+		return true;
+	}
+
+	void PairCache::removeStale(std::uint32_t stamp, std::vector<BodyPair>& removed) {
+		std::size_t slot = 0;
+		while (slot < entries.size()) {
+			Entry& entry = entries[slot];
+			if (entry.key != EMPTY_KEY && entry.value != stamp) {
+				removed.push_back(BodyPair{ static_cast<BodyId>(entry.key >> 32), static_cast<BodyId>(entry.key & 0xffffffffu) });
+				// backward shift may move a later entry into this slot, so look at it again
+				eraseSlot(slot);
+				continue;
+			}
+			slot++;
+		}
+	}
+
+	void PairCache::eraseSlot(std::size_t slot) {
+		// backward shift deletion keeps probe chains intact without tombstones
+		std::size_t hole = slot;
+		std::size_t next = (hole + 1) & mask;
+		while (entries[next].key != EMPTY_KEY) {
+			std::size_t home = slotOf(entries[next].key);
+			// move the entry back if its home slot is not between the hole and its position
+			if (((next - home) & mask) >= ((next - hole) & mask)) {
+				entries[hole] = entries[next];
+				hole = next;
+			}
+			next = (next + 1) & mask;
+		}
+		entries[hole].key = EMPTY_KEY;
+		count--;
+	}
+
+	void PairCache::grow() {
+		std::vector<Entry> old;
+		old.swap(entries);
+		entries.assign(old.size() * 2, Entry{ EMPTY_KEY, 0 });
+		mask = entries.size() - 1;
+		for (const Entry& entry : old) {
+			if (entry.key == EMPTY_KEY) {
+				continue;
+			}
+			std::size_t slot = slotOf(entry.key);
+			while (entries[slot].key != EMPTY_KEY) {
+				slot = (slot + 1) & mask;
+			}
+			entries[slot] = entry;
+		}
+	}
+
+	void PairCache::clear() {
+		for (Entry& entry : entries) {
+			entry.key = EMPTY_KEY;
+		}
+		count = 0;
+	}
+
+}
@@ -0,0 +1,53 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// persistent set of overlapping body pairs (open addressing hash set) -->
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "physics/broadphase.h"
+
+namespace psix {
+
+	// every pair carries a 32 bit value. the broadphases store the update in
+	// which the pair was last seen, entries that were not touched during an
+	// update are reported as removed and erased. the world stores the slot of
+	// the persistent contact of the pair
+
+	class PairCache {
+	public:
+		PairCache();
+		// mark the pair as overlapping in this update, returns true if it is new
+		bool touch(const BodyPair& pair, std::uint32_t stamp);
+		// erase every pair that was not touched with the given stamp
+		void removeStale(std::uint32_t stamp, std::vector<BodyPair>& removed);
+		bool contains(const BodyPair& pair) const { return find(pair) != nullptr; }
+		// value of the pair, null when it is not in the set
+		std::uint32_t* find(const BodyPair& pair);
+		const std::uint32_t* find(const BodyPair& pair) const;
+		// false when the pair was not in the set, value receives what it carried
+		bool erase(const BodyPair& pair, std::uint32_t& value);
+		std::size_t size() const { return count; }
+		void clear();
+	private:
+		struct Entry {
+			std::uint64_t key;	// EMPTY_KEY marks a free slot
+			std::uint32_t value;
+		};
+		static constexpr std::uint64_t EMPTY_KEY = ~0ull;
+		static std::uint64_t pairKey(const BodyPair& pair) {
+			return (static_cast<std::uint64_t>(pair.a) << 32) | pair.b;
+		}
+		std::size_t slotOf(std::uint64_t key) const;
+		// slot holding the key, or the free slot ending its probe chain
+		std::size_t probe(std::uint64_t key) const;
+		void grow();
+		void eraseSlot(std::size_t slot);
+
+		std::vector<Entry> entries;
+		std::size_t count = 0;
+		std::size_t mask = 0;
+	};
+
+}
@@ -0,0 +1,233 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// incremental sweep and prune broadphase on both axes -->
+
+#include "physics/sweep_and_prune_broadphase.h"
+#include <algorithm>
+
+namespace psix {
+
+	SweepAndPruneBroadphase::Bounds SweepAndPruneBroadphase::boundsOf(const BodyStore& bodies, BodyId id) const {
+		float r = bodies.radius[id] + contactMargin;
+		Bounds box;
+		box.min[0] = bodies.positionX[id] - r;
+		box.max[0] = bodies.positionX[id] + r;
+		box.min[1] = bodies.positionY[id] - r;
+		box.max[1] = bodies.positionY[id] + r;
+		return box;
+	}
+
+	void SweepAndPruneBroadphase::update(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) {
+		candidatePairs.clear();
+		addedPairs.clear();
+		removedPairs.clear();
+		stamp++;
+		swapCount = 0;
+		if (bodies.size() != bounds.size()) {
+			rebuild(bodies);
+			return;
+		}
+		if (resweep) {
+			sweepAll(bodies, awakeBodies);
+			return;
+		}
+		for (BodyId id : awakeBodies) {
+			const Bounds target = boundsOf(bodies, id);
+			const Bounds current = bounds[id];
+			// grow before shrinking so the stored box is never inverted while
+			// the endpoints pass each other
+			for (int axis = 0; axis < 2; axis++) {
+				if (target.min[axis] < current.min[axis]) {
+					moveEndpoint(id, axis, false, target.min[axis]);
+				}
+				if (target.max[axis] > current.max[axis]) {
+					moveEndpoint(id, axis, true, target.max[axis]);
+				}
+			}
+			for (int axis = 0; axis < 2; axis++) {
+				if (target.min[axis] > current.min[axis]) {
+					moveEndpoint(id, axis, false, target.min[axis]);
+				}
+				if (target.max[axis] < current.max[axis]) {
+					moveEndpoint(id, axis, true, target.max[axis]);
+				}
+			}
+		}
+		finishAdded();
+		resweep = swapCount > RESWEEP_SWAPS * endpoints[0].size() * 2;
+	}
+
+	void SweepAndPruneBroadphase::sweepAll(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) {
+		for (BodyId id : awakeBodies) {
+			bounds[id] = boundsOf(bodies, id);
+			for (int axis = 0; axis < 2; axis++) {
+				endpoints[axis][endpointIndex[id * 4 + axis * 2]].value = bounds[id].min[axis];
+				endpoints[axis][endpointIndex[id * 4 + axis * 2 + 1]].value = bounds[id].max[axis];
+			}
+		}
+		// the order of the last update is nearly right, the insertion sorts
+		// also count the swaps the incremental update would have done
+		for (int axis = 0; axis < 2; axis++) {
+			std::vector<Endpoint>& list = endpoints[axis];
+			for (std::size_t i = 1; i < list.size(); i++) {
+				const Endpoint key = list[i];
+				std::size_t j = i;
+				while (j > 0 && list[j - 1].value > key.value) {
+					list[j] = list[j - 1];
+					j--;
+				}
+				swapCount += i - j;
+				list[j] = key;
+			}
+		}
+		collectOverlaps();
+		resweep = swapCount > RESWEEP_SWAPS * endpoints[0].size() * 2;
+	}
+
+	void SweepAndPruneBroadphase::rebuild(const BodyStore& bodies) {
+		const std::size_t count = bodies.size();
+		bounds.resize(count);
+		endpointIndex.resize(count * 4);
+		for (int axis = 0; axis < 2; axis++) {
+			endpoints[axis].resize(count * 2);
+		}
+		for (std::size_t i = 0; i < count; i++) {
+			BodyId id = static_cast<BodyId>(i);
+			bounds[i] = boundsOf(bodies, id);
+			for (int axis = 0; axis < 2; axis++) {
+				endpoints[axis][i * 2] = Endpoint{ bounds[i].min[axis], id << 1 };
+				endpoints[axis][i * 2 + 1] = Endpoint{ bounds[i].max[axis], (id << 1) | 1u };
+			}
+		}
+		for (int axis = 0; axis < 2; axis++) {
+			// lower ends first on ties, touching bounds count as overlapping
+			std::sort(endpoints[axis].begin(), endpoints[axis].end(), [](const Endpoint& a, const Endpoint& b) {
+				return a.value < b.value || (a.value == b.value && (a.data & 1u) < (b.data & 1u));
+			});
+		}
+		collectOverlaps();
+		resweep = false;
+	}
+
+	void SweepAndPruneBroadphase::collectOverlaps() {
+		for (int axis = 0; axis < 2; axis++) {
+			const std::vector<Endpoint>& list = endpoints[axis];
+			for (std::size_t i = 0; i < list.size(); i++) {
+				endpointIndex[(list[i].data >> 1) * 4 + axis * 2 + (list[i].data & 1u)] = static_cast<std::uint32_t>(i);
+			}
+		}
+		// one sweep over x finds every overlap, the pairs that are no longer
+		// there are reported as removed
+		open.clear();
+		for (const Endpoint& endpoint : endpoints[0]) {
+			BodyId id = endpoint.data >> 1;
+			if ((endpoint.data & 1u) != 0) {
+				open.erase(std::find(open.begin(), open.end(), id));
+				continue;
+			}
+			for (BodyId other : open) {
+				if (bounds[id].min[1] <= bounds[other].max[1] && bounds[other].min[1] <= bounds[id].max[1]) {
+					BodyPair pair = makeBodyPair(id, other);
+					if (overlapCache.touch(pair, stamp)) {
+						addedPairs.push_back(pair);
+					}
+				}
+			}
+			open.push_back(id);
+		}
+		overlapCache.removeStale(stamp, removedPairs);
+	}
+
+	void SweepAndPruneBroadphase::moveEndpoint(BodyId id, int axis, bool upper, float value) {
+		Endpoint* list = endpoints[axis].data();
+		const std::size_t count = endpoints[axis].size();
+		std::uint32_t* index = endpointIndex.data();
+		std::size_t i = index[id * 4 + axis * 2 + (upper ? 1 : 0)];
+		list[i].value = value;
+		if (upper) {
+			bounds[id].max[axis] = value;
+		}
+		else {
+			bounds[id].min[axis] = value;
+		}
+		const Endpoint self = list[i];
+		// a lower end passing an upper end downwards (or the other way round)
+		// starts an overlap on this axis, the reverse ends one
+		while (i > 0 && list[i - 1].value > value) {
+			const Endpoint other = list[i - 1];
+			const BodyId otherId = other.data >> 1;
+			const bool otherUpper = (other.data & 1u) != 0;
+			if (!upper && otherUpper) {
+				if (overlaps(id, otherId)) {
+					addPair(id, otherId);
+				}
+			}
+			else if (upper && !otherUpper) {
+				removePair(id, otherId);
+			}
+			list[i] = other;
+			index[otherId * 4 + axis * 2 + (otherUpper ? 1 : 0)] = static_cast<std::uint32_t>(i);
+			i--;
+			swapCount++;
+		}
+		while (i + 1 < count && list[i + 1].value < value) {
+			const Endpoint other = list[i + 1];
+			const BodyId otherId = other.data >> 1;
+			const bool otherUpper = (other.data & 1u) != 0;
+			if (upper && !otherUpper) {
+				if (overlaps(id, otherId)) {
+					addPair(id, otherId);
+				}
+			}
+			else if (!upper && otherUpper) {
+				removePair(id, otherId);
+			}
+			list[i] = other;
+			index[otherId * 4 + axis * 2 + (otherUpper ? 1 : 0)] = static_cast<std::uint32_t>(i);
+			i++;
+			swapCount++;
+		}
+		list[i] = self;
+		index[id * 4 + axis * 2 + (upper ? 1 : 0)] = static_cast<std::uint32_t>(i);
+	}
+
+	bool SweepAndPruneBroadphase::overlaps(BodyId a, BodyId b) const {
+		const Bounds& boxA = bounds[a];
+		const Bounds& boxB = bounds[b];
+		return boxA.min[0] <= boxB.max[0] && boxB.min[0] <= boxA.max[0] &&
+			boxA.min[1] <= boxB.max[1] && boxB.min[1] <= boxA.max[1];
+	}
+
+	void SweepAndPruneBroadphase::addPair(BodyId a, BodyId b) {
+		BodyPair pair = makeBodyPair(a, b);
+		if (overlapCache.touch(pair, stamp)) {
+			addedPairs.push_back(pair);
+		}
+	}
+
+	void SweepAndPruneBroadphase::removePair(BodyId a, BodyId b) {
+		BodyPair pair = makeBodyPair(a, b);
+		std::uint32_t addedIn = 0;
+		if (!overlapCache.erase(pair, addedIn)) {
+			return;
+		}
+		// a pair added within this update is dropped from the added list at the end
+		if (addedIn != stamp) {
+			removedPairs.push_back(pair);
+		}
+	}
+
+	void SweepAndPruneBroadphase::finishAdded() {
+		std::size_t kept = 0;
+		for (const BodyPair& pair : addedPairs) {
+			std::uint32_t* addedIn = overlapCache.find(pair);
+			if (addedIn != nullptr && *addedIn == stamp) {
+				// reported once, a second entry of the pair is dropped
+				*addedIn = stamp - 1;
+				addedPairs[kept++] = pair;
+			}
+		}
+		addedPairs.resize(kept);
+	}
+
+}
@@ -0,0 +1,72 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// incremental sweep and prune broadphase on both axes -->
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "physics/broadphase.h"
+#include "physics/pair_cache.h"
+
+namespace psix {
+
+	// the bound endpoints of every body stay sorted on x and y between steps.
+	// an awake body moves its endpoints with an insertion sort, and a pair can
+	// only start or stop overlapping when a lower endpoint passes an upper one,
+	// so the overlap set is updated from the swaps alone. with coherent motion
+	// an update costs the awake bodies plus the swaps, sleeping bodies are not
+	// touched. bodies created since the last update rebuild everything once.
+	// when the motion is not coherent (more swaps than RESWEEP_SWAPS per
+	// endpoint) the swaps cost more than sorting and sweeping everything, the
+	// next updates sort all endpoints at once and sweep the whole axis until
+	// the swap count drops again.
+	//
+	// pairs() stays empty, the overlap set is only reported through added()
+	// and removed() (removed before added, a pair may be in both)
+
+	class SweepAndPruneBroadphase : public Broadphase {
+	public:
+		const char* name() const override { return "sweep and prune"; }
+		void update(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies) override;
+		bool reportsDeltas() const override { return true; }
+		std::size_t overlapCount() const { return overlapCache.size(); }
+		// swaps done by the insertion sorts during the last update
+		std::size_t lastSwapCount() const { return swapCount; }
+		bool resweeping() const { return resweep; }
+		static constexpr std::size_t RESWEEP_SWAPS = 2;
+	private:
+		struct Endpoint {
+			float value;
+			std::uint32_t data;		// body id << 1, low bit set for the upper end
+		};
+		struct Bounds {
+			float min[2];
+			float max[2];
+		};
+
+		Bounds boundsOf(const BodyStore& bodies, BodyId id) const;
+		void rebuild(const BodyStore& bodies);
+		// sorts both axes with insertion sorts and finds every overlap again
+		void sweepAll(const BodyStore& bodies, const std::vector<BodyId>& awakeBodies);
+		// overlap set from a sweep over sorted x, stale pairs are reported as removed
+		void collectOverlaps();
+		// drops the added pairs that were removed again within the update
+		void finishAdded();
+		// moves one endpoint of the body to value and sorts it into place
+		void moveEndpoint(BodyId id, int axis, bool upper, float value);
+		bool overlaps(BodyId a, BodyId b) const;
+		void addPair(BodyId a, BodyId b);
+		void removePair(BodyId a, BodyId b);
+
+		std::vector<Endpoint> endpoints[2];		// sorted by value
+		std::vector<Bounds> bounds;
+		std::vector<std::uint32_t> endpointIndex;	// 4 per body: axis * 2 + upper
+		PairCache overlapCache;		// values are the update a pair was added in
+		std::uint32_t stamp = 0;
+		std::size_t swapCount = 0;
+		bool resweep = false;
+		std::vector<BodyId> open;
+	};
+
+}
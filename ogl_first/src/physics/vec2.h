@@ -0,0 +1,33 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// minimal 2D vector math used by the physics code -->
+
+#pragma once
+
+#include <cmath>
+
+namespace psix {
+
+	struct Vec2 {
+		float x = 0.0f;
+		float y = 0.0f;
+		Vec2() = default;
+		Vec2(float x, float y) : x(x), y(y) {}
+		Vec2 operator+(const Vec2& o) const { return Vec2(x + o.x, y + o.y); }
+		Vec2 operator-(const Vec2& o) const { return Vec2(x - o.x, y - o.y); }
+		Vec2 operator*(float s) const { return Vec2(x * s, y * s); }
+		Vec2 operator-() const { return Vec2(-x, -y); }
+		Vec2& operator+=(const Vec2& o) { x += o.x; y += o.y; return *this; }
+		Vec2& operator-=(const Vec2& o) { x -= o.x; y -= o.y; return *this; }
+		Vec2& operator*=(float s) { x *= s; y *= s; return *this; }
+	};
+
+	inline Vec2 operator*(float s, const Vec2& v) { return Vec2(v.x * s, v.y * s); }
+	inline float dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+	inline float cross(const Vec2& a, const Vec2& b) { return a.x * b.y - a.y * b.x; }
+	inline float lengthSquared(const Vec2& v) { return dot(v, v); }
+	inline float length(const Vec2& v) { return std::sqrt(dot(v, v)); }
+	inline Vec2 perp(const Vec2& v) { return Vec2(-v.y, v.x); }
+	inline Vec2 lerp(const Vec2& a, const Vec2& b, float t) { return a + (b - a) * t; }
+
+}
@@ -0,0 +1,311 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// physics world, owns the simulation state and steps it at a fixed rate -->
+
+#include "physics/world.h"
+#include "core/stopwatch.h"
+#include "physics/integrator.h"
+#include "physics/narrowphase.h"
+#include <algorithm>
+#include <cmath>
+
+namespace psix {
+
+	World::World(const WorldSettings& settings) : settings(settings), fixedStepper(settings.stepper), staticTree(0.0f), solver(settings.contacts), islandManager(settings.sleep), xpbdSolver(settings.xpbd) {
+		broadphase = createBroadphase(settings.broadphase);
+		if (settings.solver == SolverType::Xpbd) {
+			broadphase->setContactMargin(settings.xpbd.contactMargin);
+		}
+	}
+
+	BodyId World::createBody(const BodyDesc& desc) {
+		BodyId id = bodyStore.add(desc);
+		islandManager.addBody(id);
+		return id;
+	}
+
+	BodyId World::createBodies(const BodyColumns& columns, std::size_t count) {
+		BodyId first = bodyStore.add(columns, count);
+		for (std::size_t i = 0; i < count; i++) {
+			islandManager.addBody(first + static_cast<BodyId>(i));
+		}
+		return first;
+	}
+
+	void World::setJobSystem(JobSystem* jobs) {
+		jobSystem = jobs;
+		broadphase->setJobSystem(jobs);
+	}
+
+	ProxyId World::addStaticBox(const Aabb& box, float friction, float restitution) {
+		staticBoxes.push_back(box);
+		staticFriction.push_back(friction);
+		staticRestitution.push_back(restitution);
+		return staticTree.createProxy(box, static_cast<std::uint32_t>(staticBoxes.size() - 1));
+	}
+
+	std::uint32_t World::addDistanceConstraint(BodyId a, BodyId b, float compliance) {
+		bodyStore.wake(a);
+		bodyStore.wake(b);
+		return xpbdSolver.addDistance(bodyStore, a, b, compliance);
+	}
+
+	std::uint32_t World::addBendingConstraint(BodyId a, BodyId b, BodyId c, float compliance) {
+		bodyStore.wake(a);
+		bodyStore.wake(b);
+		bodyStore.wake(c);
+		return xpbdSolver.addBending(bodyStore, a, b, c, compliance);
+	}
+
+	std::uint32_t World::addVolumeConstraint(const BodyId* ids, std::size_t count, float compliance, float pressure) {
+		for (std::size_t i = 0; i < count; i++) {
+			bodyStore.wake(ids[i]);
+		}
+		return xpbdSolver.addVolume(bodyStore, ids, count, compliance, pressure);
+	}
+
+	void World::removeStaticBox(ProxyId collider) {
+		// the box slot is left behind, static colliders are rarely removed
+		islandManager.wakeStaticContacts(bodyStore, staticTree.userData(collider));
+		staticTree.destroyProxy(collider);
+	}
+
+	int World::update(double frameSeconds) {
+		int steps = fixedStepper.advance(frameSeconds);
+		float dt = static_cast<float>(fixedStepper.fixedDt());
+		for (int i = 0; i < steps; i++) {
+			step(dt);
+		}
+		return steps;
+	}
+
+	template <typename F>
+	void World::forEachAwakeRange(const F& body) {
+		// ranges never cross a multiple of 4096 so the AVX2 loads of a chunk stay aligned
+		const std::vector<BodyRange>& ranges = islandManager.awakeRanges(4096);
+		auto run = [&](std::size_t first, std::size_t last) {
+			for (std::size_t r = first; r < last; r++) {
+				body(std::size_t(ranges[r].begin), std::size_t(ranges[r].end));
+			}
+		};
+		if (jobSystem != nullptr) {
+			jobSystem->parallelFor(0, ranges.size(), 1, run);
+		}
+		else {
+			run(0, ranges.size());
+		}
+	}
+
+	template <typename F>
+	void World::forEachIsland(const F& body) {
+		// islands share no movable body, so they are the unit of parallel work
+		Island* islands = islandManager.islands();
+		auto run = [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; i++) {
+				body(islands[i]);
+			}
+		};
+		if (jobSystem != nullptr) {
+			jobSystem->parallelFor(0, islandManager.islandCount(), 1, run);
+		}
+		else {
+			run(0, islandManager.islandCount());
+		}
+	}
+
+	void World::step(float dt) {
+		StepTimings& timings = stats.timings;
+		timings = StepTimings();
+		Stopwatch watch;
+		stepArena.reset();
+		// islands woken from outside (forces, teleports) get their impulses back
+		// and are picked up by the broadphase like any awake body
+		islandManager.processWakeRequests(bodyStore);
+		std::vector<ContactManifold>& restored = islandManager.restoredContacts();
+		solver.restoreImpulses(restored.data(), restored.size());
+		restored.clear();
+		islandManager.updateAwakeList(bodyStore);
+		forEachAwakeRange([&](std::size_t begin, std::size_t end) {
+			bodyStore.savePreviousPositions(begin, end);
+		});
+		timings.integrate += watch.lap();
+		// contacts are found on the positions at the start of the step
+		broadphase->update(bodyStore, islandManager.awakeBodies());
+		timings.broadphase += watch.lap();
+		collide();
+		timings.narrowphase += watch.lap();
+		islandManager.build(bodyStore, manifolds, manifoldCount, xpbdSolver.links(), stepArena);
+		if (settings.solver == SolverType::Xpbd) {
+			// xpbd splits the work by constraint colour, islands only drive sleeping
+			xpbdSolver.step(bodyStore, islandManager.awakeRanges(4096), manifolds, manifoldCount, staticBoxes.data(), settings.contacts, settings.gravity, dt, jobSystem, stepArena);
+			double substeps = watch.lap();
+			timings.integrate += xpbdSolver.lastIntegrateMs();
+			timings.solve += substeps - xpbdSolver.lastIntegrateMs();
+			forEachIsland([&](Island& island) {
+				islandManager.updateSleepTimers(bodyStore, island, dt);
+			});
+			stats.warmStartedPoints = 0;
+		}
+		else {
+			timings.solve += watch.lap();
+			IntegrateArgs args = makeIntegrateArgs(bodyStore, settings.gravity, dt);
+			forEachAwakeRange([&](std::size_t begin, std::size_t end) {
+				integrateVelocities(args, begin, end);
+			});
+			timings.integrate += watch.lap();
+			forEachIsland([&](Island& island) {
+				island.warmStarted = static_cast<std::uint32_t>(solver.solveVelocityRange(bodyStore, manifolds, island.manifoldBegin, island.manifoldBegin + island.manifoldCount));
+			});
+			timings.solve += watch.lap();
+			forEachAwakeRange([&](std::size_t begin, std::size_t end) {
+				integratePositions(args, begin, end);
+			});
+			timings.integrate += watch.lap();
+			forEachIsland([&](Island& island) {
+				solver.solvePositionRange(bodyStore, manifolds, island.manifoldBegin, island.manifoldBegin + island.manifoldCount, staticBoxes.data());
+				islandManager.updateSleepTimers(bodyStore, island, dt);
+			});
+			solver.storeImpulses(manifolds, manifoldCount);
+			stats.warmStartedPoints = 0;
+			for (std::size_t i = 0; i < islandManager.islandCount(); i++) {
+				stats.warmStartedPoints += islandManager.islands()[i].warmStarted;
+			}
+		}
+		stats.islands = islandManager.islandCount();
+		stats.awakeBodies = islandManager.awakeBodies().size();
+		// sleeping islands drop out of the next step
+		islandManager.sleepRestingIslands(bodyStore, manifolds);
+		stats.sleepingIslands = islandManager.sleepingIslandCount();
+		timings.solve += watch.lap();
+		stats.candidatePairs = broadphase->reportsDeltas() ? persistentContacts.size() : broadphase->pairs().size();
+		stats.manifolds = manifoldCount;
+		stats.arenaBytes = stepArena.bytesUsed();
+	}
+
+	bool World::collidePair(const BodyPair& pair, ContactManifold& manifold, ArenaArray<BodyId>& woken) const {
+		if (bodyStore.inverseMass[pair.a] == 0.0f && bodyStore.inverseMass[pair.b] == 0.0f) {
+			return false;
+		}
+		// with a margin the manifolds are speculative, the solver measures the separation itself
+		const float margin = broadphase->margin();
+		if (!collideCircles(bodyStore.position(pair.a), bodyStore.radius[pair.a] + margin, bodyStore.position(pair.b), bodyStore.radius[pair.b] + margin, manifold)) {
+			return false;
+		}
+		// a sleeping movable body touched by an awake one wakes with its island
+		if (bodyStore.awake[pair.a] == 0 && bodyStore.inverseMass[pair.a] > 0.0f) {
+			woken.push_back(pair.a);
+		}
+		if (bodyStore.awake[pair.b] == 0 && bodyStore.inverseMass[pair.b] > 0.0f) {
+			woken.push_back(pair.b);
+		}
+		manifold.key = bodyPairKey(pair.a, pair.b);
+		manifold.bodyA = pair.a;
+		manifold.bodyB = pair.b;
+		manifold.staticIndex = 0;
+		manifold.friction = std::sqrt(bodyStore.friction[pair.a] * bodyStore.friction[pair.b]);
+		manifold.restitution = std::max(bodyStore.restitution[pair.a], bodyStore.restitution[pair.b]);
+		return true;
+	}
+
+	void World::applyPairDeltas() {
+		// removed first, a pair that stopped and started overlapping again gets a fresh contact
+		for (const BodyPair& pair : broadphase->removed()) {
+			std::uint32_t slot = 0;
+			if (!persistentSlots.erase(pair, slot)) {
+				continue;
+			}
+			if (slot + 1 < persistentContacts.size()) {
+				persistentContacts[slot] = persistentContacts.back();
+				*persistentSlots.find(persistentContacts[slot].pair) = slot;
+			}
+			persistentContacts.pop_back();
+		}
+		for (const BodyPair& pair : broadphase->added()) {
+			if (persistentSlots.touch(pair, static_cast<std::uint32_t>(persistentContacts.size()))) {
+				PersistentContact contact = {};
+				contact.pair = pair;
+				persistentContacts.push_back(contact);
+			}
+		}
+	}
+
+	void World::collide() {
+		const std::vector<BodyPair>& pairs = broadphase->pairs();
+		const bool persistent = broadphase->reportsDeltas();
+		// only the pairs that started or stopped overlapping change the set
+		if (persistent) {
+			applyPairDeltas();
+		}
+		const float margin = broadphase->margin();
+		ArenaArray<ContactManifold> contacts(stepArena, (persistent ? persistentContacts.size() : pairs.size()) + 64);
+		ContactManifold manifold;
+		ArenaArray<BodyId> woken(stepArena, 16);
+		// body against body
+		if (persistent) {
+			// the contacts of pairs with an awake body are refreshed, the others
+			// sleep with their islands
+			for (PersistentContact& contact : persistentContacts) {
+				if ((bodyStore.awake[contact.pair.a] | bodyStore.awake[contact.pair.b]) == 0) {
+					continue;
+				}
+				contact.touching = collidePair(contact.pair, contact.manifold, woken);
+				if (contact.touching) {
+					contacts.push_back(contact.manifold);
+				}
+			}
+		}
+		else {
+			for (const BodyPair& pair : pairs) {
+				if (collidePair(pair, manifold, woken)) {
+					contacts.push_back(manifold);
+				}
+			}
+		}
+		// awake bodies against the static colliders
+		for (BodyId id : islandManager.awakeBodies()) {
+			if (bodyStore.inverseMass[id] == 0.0f) {
+				continue;
+			}
+			Vec2 center = bodyStore.position(id);
+			float radius = bodyStore.radius[id] + margin;
+			staticTree.query(Aabb::fromCircle(center, radius), [&](ProxyId collider) {
+				std::uint32_t index = staticTree.userData(collider);
+				if (collideBoxCircle(staticBoxes[index], center, radius, manifold)) {
+					manifold.key = staticPairKey(index, id);
+					manifold.bodyA = NULL_BODY;
+					manifold.bodyB = id;
+					manifold.staticIndex = index;
+					manifold.friction = std::sqrt(staticFriction[index] * bodyStore.friction[id]);
+					manifold.restitution = std::max(staticRestitution[index], bodyStore.restitution[id]);
+					contacts.push_back(manifold);
+				}
+				return true;
+			});
+		}
+		// woken islands bring back the contacts they fell asleep with, the
+		// bodies have not moved since. contacts with awake bodies were found above
+		for (BodyId id : woken) {
+			islandManager.wakeIsland(bodyStore, id);
+		}
+		std::vector<ContactManifold>& restored = islandManager.restoredContacts();
+		solver.restoreImpulses(restored.data(), restored.size());
+		for (const ContactManifold& contact : restored) {
+			// the only bodies outside an island are immovable ones, if those are
+			// awake the broadphase already reported the pair
+			bool found = contact.bodyA != NULL_BODY &&
+				((bodyStore.inverseMass[contact.bodyA] == 0.0f && bodyStore.awake[contact.bodyA] != 0) ||
+				(bodyStore.inverseMass[contact.bodyB] == 0.0f && bodyStore.awake[contact.bodyB] != 0));
+			if (!found) {
+				contacts.push_back(contact);
+			}
+		}
+		restored.clear();
+		manifolds = contacts.data();
+		manifoldCount = contacts.size();
+	}
+
+	Vec2 World::renderPosition(BodyId id) const {
+		return bodyStore.interpolatedPosition(id, fixedStepper.alpha());
+	}
+
+}
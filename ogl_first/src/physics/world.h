@@ -0,0 +1,147 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// physics world, owns the simulation state and steps it at a fixed rate -->
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "core/job_system.h"
+#include "core/linear_arena.h"
+#include "physics/fixed_stepper.h"
+#include "physics/broadphase.h"
+#include "physics/dynamic_tree.h"
+#include "physics/body_store.h"
+#include "physics/contact.h"
+#include "physics/contact_solver.h"
+#include "physics/island_manager.h"
+#include "physics/pair_cache.h"
+#include "physics/vec2.h"
+#include "physics/xpbd_solver.h"
+
+namespace psix {
+
+	enum class SolverType {
+		SequentialImpulse,	// contacts only, warm started impulses
+		Xpbd				// contacts plus distance, bending and volume constraints
+	};
+
+	// settings used when creating a world
+
+	struct WorldSettings {
+		StepperSettings stepper;
+		Vec2 gravity = Vec2(0.0f, -9.81f);
+		BroadphaseSettings broadphase;	// picked once at world creation
+		ContactSettings contacts;
+		SleepSettings sleep;
+		SolverType solver = SolverType::SequentialImpulse;
+		XpbdSettings xpbd;
+	};
+
+	// wall time of the phases of the last step in milliseconds
+
+	struct StepTimings {
+		double broadphase = 0.0;
+		double narrowphase = 0.0;
+		double solve = 0.0;		// island building, contact and constraint solving, sleeping
+		double integrate = 0.0;	// prediction and velocity updates for xpbd
+	};
+
+	// counters of the last step
+
+	struct StepStats {
+		std::size_t candidatePairs = 0;
+		std::size_t manifolds = 0;
+		std::size_t warmStartedPoints = 0;
+		std::size_t arenaBytes = 0;
+		std::size_t awakeBodies = 0;
+		std::size_t islands = 0;
+		std::size_t sleepingIslands = 0;
+		StepTimings timings;
+	};
+
+	class World {
+	public:
+		explicit World(const WorldSettings& settings = WorldSettings());
+		BodyId createBody(const BodyDesc& desc);
+		// count bodies copied from arrays (e.g. a mapped scene archive), returns the first id
+		BodyId createBodies(const BodyColumns& columns, std::size_t count);
+		// integration and the broadphase fan out onto the jobs when a job system
+		// is set (it has to outlive the world), islands are solved as separate jobs
+		void setJobSystem(JobSystem* jobs);
+		// static colliders (floors, walls, level geometry) live in their own aabb tree
+		ProxyId addStaticBox(const Aabb& box, float friction = 0.4f, float restitution = 0.0f);
+		void removeStaticBox(ProxyId collider);
+		const DynamicTree& staticColliders() const { return staticTree; }
+		const Aabb& staticBox(ProxyId collider) const { return staticBoxes[staticTree.userData(collider)]; }
+		BodyStore& bodies() { return bodyStore; }
+		const BodyStore& bodies() const { return bodyStore; }
+		// advance the world by one frame of wall time, returns the number of steps taken
+		int update(double frameSeconds);
+		// run exactly one fixed step
+		void step(float dt);
+		// position blended between the last two steps for rendering
+		Vec2 renderPosition(BodyId id) const;
+		// overlapping pairs found by the broadphase during the last step, empty
+		// for broadphases that report deltas (their pairs are persistentPairCount())
+		const std::vector<BodyPair>& candidatePairs() const { return broadphase->pairs(); }
+		std::size_t persistentPairCount() const { return persistentContacts.size(); }
+		const Broadphase& activeBroadphase() const { return *broadphase; }
+		// contacts of the last step, they live in the step arena until the next step
+		const ContactManifold* contacts() const { return manifolds; }
+		std::size_t contactCount() const { return manifoldCount; }
+		ContactSolver& contactSolver() { return solver; }
+		// sleeping islands are skipped by the whole step until something touches
+		// or moves one of their bodies
+		const IslandManager& islands() const { return islandManager; }
+		// position constraints, only solved when the world uses the xpbd solver.
+		// rest values are taken from the current positions
+		std::uint32_t addDistanceConstraint(BodyId a, BodyId b, float compliance = 0.0f);
+		std::uint32_t addBendingConstraint(BodyId a, BodyId b, BodyId c, float compliance = 0.0f);
+		std::uint32_t addVolumeConstraint(const BodyId* ids, std::size_t count, float compliance = 0.0f, float pressure = 1.0f);
+		const XpbdSolver& constraintSolver() const { return xpbdSolver; }
+		bool isAwake(BodyId id) const { return bodyStore.isAwake(id); }
+		void wakeBody(BodyId id) { bodyStore.wake(id); }
+		const StepStats& lastStepStats() const { return stats; }
+		const FixedStepper& stepper() const { return fixedStepper; }
+		const WorldSettings& worldSettings() const { return settings; }
+	private:
+		// contact of a pair reported by a delta broadphase, it lives from the
+		// update the pair was added in until the one it was removed in
+		struct PersistentContact {
+			BodyPair pair;
+			ContactManifold manifold;	// refreshed every step one of the bodies is awake
+			bool touching;
+		};
+
+		void collide();
+		// body against body into the manifold, false when there is no contact
+		bool collidePair(const BodyPair& pair, ContactManifold& manifold, ArenaArray<BodyId>& woken) const;
+		void applyPairDeltas();
+		template <typename F>
+		void forEachAwakeRange(const F& body);
+		template <typename F>
+		void forEachIsland(const F& body);
+
+		WorldSettings settings;
+		FixedStepper fixedStepper;
+		BodyStore bodyStore;
+		std::unique_ptr<Broadphase> broadphase;
+		JobSystem* jobSystem = nullptr;
+		DynamicTree staticTree;
+		std::vector<Aabb> staticBoxes;
+		std::vector<float> staticFriction;
+		std::vector<float> staticRestitution;
+		// contact data is rebuilt every step inside the arena
+		LinearArena stepArena;
+		std::vector<PersistentContact> persistentContacts;
+		PairCache persistentSlots;	// pair -> index into persistentContacts
+		ContactManifold* manifolds = nullptr;
+		std::size_t manifoldCount = 0;
+		ContactSolver solver;
+		IslandManager islandManager;
+		XpbdSolver xpbdSolver;
+		StepStats stats;
+	};
+
+}
@@ -0,0 +1,423 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// extended position based dynamics solver with graph coloured batches -->
+
+#include "physics/xpbd_solver.h"
+#include "physics/narrowphase.h"
+#include "core/stopwatch.h"
+#include <algorithm>
+#include <cmath>
+
+namespace psix {
+
+	// constraints per job inside a colour
+	constexpr std::size_t BATCH_GRAIN = 256;
+
+	XpbdSolver::XpbdSolver(const XpbdSettings& settings) : settings(settings) {
+	}
+
+	// a constraint is skipped while one of its movable bodies sleeps, islands
+	// include constraint links so all of them sleep and wake together
+	static inline bool asleep(const BodyStore& bodies, BodyId id) {
+		return bodies.awake[id] == 0 && bodies.inverseMass[id] > 0.0f;
+	}
+
+	static inline float polygonArea(const BodyStore& bodies, const BodyId* ids, std::size_t count) {
+		float area = 0.0f;
+		for (std::size_t i = 0; i < count; i++) {
+			area += cross(bodies.position(ids[i]), bodies.position(ids[(i + 1) % count]));
+		}
+		return 0.5f * area;
+	}
+
+	std::uint32_t XpbdSolver::addDistance(const BodyStore& bodies, BodyId a, BodyId b, float compliance) {
+		distances.push_back(DistanceConstraint{ a, b, length(bodies.position(b) - bodies.position(a)), compliance });
+		distanceLambda.push_back(0.0f);
+		constraintLinks.push_back(makeBodyPair(a, b));
+		coloursDirty = true;
+		return static_cast<std::uint32_t>(distances.size() - 1);
+	}
+
+	std::uint32_t XpbdSolver::addBending(const BodyStore& bodies, BodyId a, BodyId b, BodyId c, float compliance) {
+		Vec2 centroid = (bodies.position(a) + bodies.position(b) + bodies.position(c)) * (1.0f / 3.0f);
+		bendings.push_back(BendingConstraint{ a, b, c, length(bodies.position(b) - centroid), compliance });
+		bendingLambda.push_back(0.0f);
+		constraintLinks.push_back(makeBodyPair(a, b));
+		constraintLinks.push_back(makeBodyPair(b, c));
+		coloursDirty = true;
+		return static_cast<std::uint32_t>(bendings.size() - 1);
+	}
+
+	std::uint32_t XpbdSolver::addVolume(const BodyStore& bodies, const BodyId* ids, std::size_t count, float compliance, float pressure) {
+		std::uint32_t first = static_cast<std::uint32_t>(volumeBodies.size());
+		volumeBodies.insert(volumeBodies.end(), ids, ids + count);
+		volumes.push_back(VolumeConstraint{ first, static_cast<std::uint32_t>(count), polygonArea(bodies, ids, count) * pressure, compliance });
+		volumeLambda.push_back(0.0f);
+		for (std::size_t i = 0; i + 1 < count; i++) {
+			constraintLinks.push_back(makeBodyPair(ids[i], ids[i + 1]));
+		}
+		coloursDirty = true;
+		return static_cast<std::uint32_t>(volumes.size() - 1);
+	}
+
+	// counting sort of items by colour into order, returns the batches
+	template <typename T>
+	static void sortByColour(const std::uint32_t* colours, const T* items, std::size_t count, T* order, std::vector<ColourBatch>& batches, std::uint32_t colourCount) {
+		std::uint32_t counts[MAX_COLOURS + 1] = {};
+		for (std::size_t i = 0; i < count; i++) {
+			counts[colours[i]]++;
+		}
+		batches.clear();
+		std::uint32_t starts[MAX_COLOURS + 1];
+		std::uint32_t running = 0;
+		for (std::uint32_t c = 0; c <= MAX_COLOURS; c++) {
+			starts[c] = running;
+			if (counts[c] > 0 && (c < colourCount || c == OVERFLOW_COLOUR)) {
+				batches.push_back(ColourBatch{ running, running + counts[c], c == OVERFLOW_COLOUR });
+			}
+			running += counts[c];
+		}
+		for (std::size_t i = 0; i < count; i++) {
+			order[starts[colours[i]]++] = items[i];
+		}
+	}
+
+	void XpbdSolver::colourConstraints(const BodyStore& bodies) {
+		const float* inverseMass = bodies.inverseMass.data();
+		std::vector<ConstraintRef> refs;
+		std::vector<std::uint32_t> colours;
+		refs.reserve(constraintCount());
+		colours.reserve(constraintCount());
+		constraintColouring.begin(bodies.size());
+		// the biggest constraints first, they are the hardest to place
+		for (std::uint32_t i = 0; i < volumes.size(); i++) {
+			refs.push_back(ConstraintRef{ ConstraintType::Volume, i });
+			colours.push_back(constraintColouring.colour(volumeBodies.data() + volumes[i].first, volumes[i].count, inverseMass));
+		}
+		for (std::uint32_t i = 0; i < bendings.size(); i++) {
+			BodyId ids[3] = { bendings[i].a, bendings[i].b, bendings[i].c };
+			refs.push_back(ConstraintRef{ ConstraintType::Bending, i });
+			colours.push_back(constraintColouring.colour(ids, 3, inverseMass));
+		}
+		for (std::uint32_t i = 0; i < distances.size(); i++) {
+			BodyId ids[2] = { distances[i].a, distances[i].b };
+			refs.push_back(ConstraintRef{ ConstraintType::Distance, i });
+			colours.push_back(constraintColouring.colour(ids, 2, inverseMass));
+		}
+		constraintOrder.resize(refs.size());
+		sortByColour(colours.data(), refs.data(), refs.size(), constraintOrder.data(), constraintBatches, constraintColouring.colourCount());
+		coloursDirty = false;
+	}
+
+	void XpbdSolver::colourContacts(const BodyStore& bodies, const ContactManifold* manifolds, std::size_t count, LinearArena& arena) {
+		const float* inverseMass = bodies.inverseMass.data();
+		std::uint32_t* colours = arena.allocateArray<std::uint32_t>(count);
+		std::uint32_t* indices = arena.allocateArray<std::uint32_t>(count);
+		std::uint32_t* order = arena.allocateArray<std::uint32_t>(count);
+		contactColouring.begin(bodies.size());
+		for (std::size_t m = 0; m < count; m++) {
+			const ContactManifold& manifold = manifolds[m];
+			// static colliders are not bodies, only side B takes part
+			if (manifold.bodyA == NULL_BODY) {
+				colours[m] = contactColouring.colour(&manifold.bodyB, 1, inverseMass);
+			}
+			else {
+				BodyId ids[2] = { manifold.bodyA, manifold.bodyB };
+				colours[m] = contactColouring.colour(ids, 2, inverseMass);
+			}
+			indices[m] = static_cast<std::uint32_t>(m);
+		}
+		sortByColour(colours, indices, count, order, contactBatches, contactColouring.colourCount());
+		contactOrder = order;
+	}
+
+	template <typename F>
+	void XpbdSolver::forEachInBatches(const std::vector<ColourBatch>& batches, JobSystem* jobs, const F& body) {
+		for (const ColourBatch& batch : batches) {
+			if (jobs == nullptr || batch.serial || batch.end - batch.begin < 2 * BATCH_GRAIN) {
+				for (std::uint32_t i = batch.begin; i < batch.end; i++) {
+					body(i);
+				}
+				continue;
+			}
+			// colours run one after the other, everything inside one is independent
+			jobs->parallelFor(batch.begin, batch.end, BATCH_GRAIN, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; i++) {
+					body(static_cast<std::uint32_t>(i));
+				}
+			});
+		}
+	}
+
+	void XpbdSolver::step(BodyStore& bodies, const std::vector<BodyRange>& awakeRanges, const ContactManifold* manifolds, std::size_t count,
+		const Aabb* staticBoxes, const ContactSettings& contactSettings, const Vec2& gravity, float dt, JobSystem* jobs, LinearArena& arena) {
+		if (coloursDirty) {
+			colourConstraints(bodies);
+		}
+		colourContacts(bodies, manifolds, count, arena);
+		ContactState* states = arena.allocateArray<ContactState>(count);
+		const int substeps = settings.substeps > 0 ? settings.substeps : 1;
+		const float h = dt / static_cast<float>(substeps);
+		// compliance is scaled by 1 / h^2 so stiffness does not depend on the step
+		const float alphaScale = 1.0f / (h * h);
+		substepX.resize(bodies.size());
+		substepY.resize(bodies.size());
+		integrateMs = 0.0;
+		Stopwatch watch;
+		auto forEachAwake = [&](auto&& body) {
+			auto run = [&](std::size_t first, std::size_t last) {
+				for (std::size_t r = first; r < last; r++) {
+					for (std::size_t i = awakeRanges[r].begin; i < awakeRanges[r].end; i++) {
+						body(i);
+					}
+				}
+			};
+			if (jobs != nullptr) {
+				jobs->parallelFor(0, awakeRanges.size(), 1, run);
+			}
+			else {
+				run(0, awakeRanges.size());
+			}
+		};
+		for (int s = 0; s < substeps; s++) {
+			for (std::size_t m = 0; m < count; m++) {
+				const ContactManifold& manifold = manifolds[m];
+				Vec2 velocityA = manifold.bodyA == NULL_BODY ? Vec2() : bodies.velocity(manifold.bodyA);
+				states[m].normal = manifold.normal;
+				states[m].normalVelocity = dot(bodies.velocity(manifold.bodyB) - velocityA, manifold.normal);
+				states[m].lambda = 0.0f;
+			}
+			// predict: forces act over every substep and are cleared after the last one
+			watch.restart();
+			forEachAwake([&](std::size_t i) {
+				float invMass = bodies.inverseMass[i];
+				float gravityScale = invMass > 0.0f ? 1.0f : 0.0f;
+				substepX[i] = bodies.positionX[i];
+				substepY[i] = bodies.positionY[i];
+				bodies.velocityX[i] += (bodies.forceX[i] * invMass + gravity.x * gravityScale) * h;
+				bodies.velocityY[i] += (bodies.forceY[i] * invMass + gravity.y * gravityScale) * h;
+				bodies.positionX[i] += bodies.velocityX[i] * h;
+				bodies.positionY[i] += bodies.velocityY[i] * h;
+			});
+			integrateMs += watch.elapsedMs();
+			// small substeps only need the multipliers of the current substep
+			std::fill(distanceLambda.begin(), distanceLambda.end(), 0.0f);
+			std::fill(bendingLambda.begin(), bendingLambda.end(), 0.0f);
+			std::fill(volumeLambda.begin(), volumeLambda.end(), 0.0f);
+			for (int it = 0; it < settings.iterations; it++) {
+				forEachInBatches(constraintBatches, jobs, [&](std::uint32_t i) {
+					solveConstraint(bodies, constraintOrder[i], alphaScale);
+				});
+				forEachInBatches(contactBatches, jobs, [&](std::uint32_t i) {
+					std::uint32_t m = contactOrder[i];
+					solveContact(bodies, manifolds[m], states[m], staticBoxes, alphaScale);
+				});
+			}
+			const float inverseH = 1.0f / h;
+			watch.restart();
+			forEachAwake([&](std::size_t i) {
+				bodies.velocityX[i] = (bodies.positionX[i] - substepX[i]) * inverseH;
+				bodies.velocityY[i] = (bodies.positionY[i] - substepY[i]) * inverseH;
+			});
+			integrateMs += watch.elapsedMs();
+			// restitution works on the velocities
+			forEachInBatches(contactBatches, jobs, [&](std::uint32_t i) {
+				std::uint32_t m = contactOrder[i];
+				solveContactVelocity(bodies, manifolds[m], states[m], contactSettings.restitutionThreshold);
+			});
+		}
+		forEachAwake([&](std::size_t i) {
+			bodies.forceX[i] = 0.0f;
+			bodies.forceY[i] = 0.0f;
+		});
+	}
+
+	void XpbdSolver::solveConstraint(BodyStore& bodies, const ConstraintRef& ref, float alphaScale) {
+		switch (ref.type) {
+		case ConstraintType::Distance:
+			solveDistance(bodies, ref.index, alphaScale);
+			break;
+		case ConstraintType::Bending:
+			solveBending(bodies, ref.index, alphaScale);
+			break;
+		case ConstraintType::Volume:
+			solveVolume(bodies, ref.index, alphaScale);
+			break;
+		}
+	}
+
+	void XpbdSolver::solveDistance(BodyStore& bodies, std::uint32_t index, float alphaScale) {
+		const DistanceConstraint& constraint = distances[index];
+		BodyId a = constraint.a;
+		BodyId b = constraint.b;
+		if (asleep(bodies, a) || asleep(bodies, b)) {
+			return;
+		}
+		float wa = bodies.inverseMass[a];
+		float wb = bodies.inverseMass[b];
+		Vec2 delta = bodies.position(b) - bodies.position(a);
+		float distance = length(delta);
+		if (wa + wb == 0.0f || distance < 1e-6f) {
+			return;
+		}
+		Vec2 n = delta * (1.0f / distance);
+		float alpha = constraint.compliance * alphaScale;
+		float& lambda = distanceLambda[index];
+		float deltaLambda = (-(distance - constraint.restLength) - alpha * lambda) / (wa + wb + alpha);
+		lambda += deltaLambda;
+		Vec2 correction = n * deltaLambda;
+		bodies.positionX[a] -= correction.x * wa;
+		bodies.positionY[a] -= correction.y * wa;
+		bodies.positionX[b] += correction.x * wb;
+		bodies.positionY[b] += correction.y * wb;
+	}
+
+	void XpbdSolver::solveBending(BodyStore& bodies, std::uint32_t index, float alphaScale) {
+		const BendingConstraint& constraint = bendings[index];
+		BodyId a = constraint.a;
+		BodyId b = constraint.b;
+		BodyId c = constraint.c;
+		if (asleep(bodies, a) || asleep(bodies, b) || asleep(bodies, c)) {
+			return;
+		}
+		float wa = bodies.inverseMass[a];
+		float wb = bodies.inverseMass[b];
+		float wc = bodies.inverseMass[c];
+		Vec2 centroid = (bodies.position(a) + bodies.position(b) + bodies.position(c)) * (1.0f / 3.0f);
+		Vec2 delta = bodies.position(b) - centroid;
+		float height = length(delta);
+		// gradients: 2/3 n for the middle body, -1/3 n for the two ends
+		float weight = (wa + 4.0f * wb + wc) * (1.0f / 9.0f);
+		if (weight == 0.0f || height < 1e-6f) {
+			return;
+		}
+		Vec2 n = delta * (1.0f / height);
+		float alpha = constraint.compliance * alphaScale;
+		float& lambda = bendingLambda[index];
+		float deltaLambda = (-(height - constraint.restHeight) - alpha * lambda) / (weight + alpha);
+		lambda += deltaLambda;
+		Vec2 end = n * (-deltaLambda / 3.0f);
+		Vec2 middle = n * (2.0f * deltaLambda / 3.0f);
+		bodies.positionX[a] += end.x * wa;
+		bodies.positionY[a] += end.y * wa;
+		bodies.positionX[b] += middle.x * wb;
+		bodies.positionY[b] += middle.y * wb;
+		bodies.positionX[c] += end.x * wc;
+		bodies.positionY[c] += end.y * wc;
+	}
+
+	void XpbdSolver::solveVolume(BodyStore& bodies, std::uint32_t index, float alphaScale) {
+		const VolumeConstraint& constraint = volumes[index];
+		const BodyId* ids = volumeBodies.data() + constraint.first;
+		const std::uint32_t count = constraint.count;
+		if (count < 3 || asleep(bodies, ids[0])) {
+			return;
+		}
+		// gradient of the area for a vertex: half the perpendicular of (next - previous)
+		float weight = 0.0f;
+		for (std::uint32_t i = 0; i < count; i++) {
+			Vec2 previous = bodies.position(ids[(i + count - 1) % count]);
+			Vec2 next = bodies.position(ids[(i + 1) % count]);
+			Vec2 gradient = Vec2(next.y - previous.y, previous.x - next.x) * 0.5f;
+			weight += bodies.inverseMass[ids[i]] * lengthSquared(gradient);
+		}
+		if (weight == 0.0f) {
+			return;
+		}
+		float alpha = constraint.compliance * alphaScale;
+		float& lambda = volumeLambda[index];
+		float deltaLambda = (-(polygonArea(bodies, ids, count) - constraint.restArea) - alpha * lambda) / (weight + alpha);
+		lambda += deltaLambda;
+		// the gradients have to use the positions from before the update, the
+		// previous vertex is already moved so its old position is carried along
+		const Vec2 first = bodies.position(ids[0]);
+		Vec2 previous = bodies.position(ids[count - 1]);
+		for (std::uint32_t i = 0; i < count; i++) {
+			Vec2 current = bodies.position(ids[i]);
+			Vec2 next = i + 1 < count ? bodies.position(ids[i + 1]) : first;
+			Vec2 gradient = Vec2(next.y - previous.y, previous.x - next.x) * 0.5f;
+			float w = bodies.inverseMass[ids[i]];
+			bodies.positionX[ids[i]] += gradient.x * deltaLambda * w;
+			bodies.positionY[ids[i]] += gradient.y * deltaLambda * w;
+			previous = current;
+		}
+	}
+
+	void XpbdSolver::solveContact(BodyStore& bodies, const ContactManifold& manifold, ContactState& state, const Aabb* staticBoxes, float alphaScale) const {
+		BodyId a = manifold.bodyA;
+		BodyId b = manifold.bodyB;
+		float wa = a == NULL_BODY ? 0.0f : bodies.inverseMass[a];
+		float wb = bodies.inverseMass[b];
+		if (wa + wb == 0.0f) {
+			return;
+		}
+		// contacts are projected on the predicted positions, not on the ones the manifold was built from
+		ContactManifold current;
+		bool touching;
+		if (a == NULL_BODY) {
+			touching = collideBoxCircle(staticBoxes[manifold.staticIndex], bodies.position(b), bodies.radius[b], current);
+		}
+		else {
+			touching = collideCircles(bodies.position(a), bodies.radius[a], bodies.position(b), bodies.radius[b], current);
+		}
+		if (!touching || current.points[0].separation >= 0.0f) {
+			return;
+		}
+		Vec2 n = current.normal;
+		float alpha = settings.contactCompliance * alphaScale;
+		float newLambda = std::max(state.lambda + (-current.points[0].separation - alpha * state.lambda) / (wa + wb + alpha), 0.0f);
+		float deltaLambda = newLambda - state.lambda;
+		state.lambda = newLambda;
+		state.normal = n;
+		Vec2 push = n * deltaLambda;
+		// friction: remove the tangential slide of this substep, up to friction * normal correction
+		// sleeping bodies are not predicted and have not moved
+		Vec2 slide;
+		if (bodies.awake[b] != 0) {
+			slide = bodies.position(b) - Vec2(substepX[b], substepY[b]);
+		}
+		if (a != NULL_BODY && bodies.awake[a] != 0) {
+			slide = slide - (bodies.position(a) - Vec2(substepX[a], substepY[a]));
+		}
+		slide = slide - n * dot(slide, n);
+		float slideLength = length(slide);
+		float maxSlide = manifold.friction * deltaLambda;
+		Vec2 grip = slideLength > maxSlide && slideLength > 0.0f ? slide * (maxSlide / slideLength) : slide;
+		grip = grip * (1.0f / (wa + wb));
+		if (wa > 0.0f) {
+			bodies.positionX[a] += (-push.x + grip.x) * wa;
+			bodies.positionY[a] += (-push.y + grip.y) * wa;
+		}
+		if (wb > 0.0f) {
+			bodies.positionX[b] += (push.x - grip.x) * wb;
+			bodies.positionY[b] += (push.y - grip.y) * wb;
+		}
+	}
+
+	void XpbdSolver::solveContactVelocity(BodyStore& bodies, const ContactManifold& manifold, const ContactState& state, float threshold) const {
+		if (state.lambda <= 0.0f) {
+			return;
+		}
+		BodyId a = manifold.bodyA;
+		BodyId b = manifold.bodyB;
+		float wa = a == NULL_BODY ? 0.0f : bodies.inverseMass[a];
+		float wb = bodies.inverseMass[b];
+		if (wa + wb == 0.0f) {
+			return;
+		}
+		Vec2 velocityA = a == NULL_BODY ? Vec2() : bodies.velocity(a);
+		float normalVelocity = dot(bodies.velocity(b) - velocityA, state.normal);
+		// slow impacts come to rest, faster ones bounce with the velocity they came in with
+		float target = state.normalVelocity < -threshold ? -manifold.restitution * state.normalVelocity : 0.0f;
+		Vec2 impulse = state.normal * ((target - normalVelocity) / (wa + wb));
+		if (wa > 0.0f) {
+			bodies.velocityX[a] -= impulse.x * wa;
+			bodies.velocityY[a] -= impulse.y * wa;
+		}
+		if (wb > 0.0f) {
+			bodies.velocityX[b] += impulse.x * wb;
+			bodies.velocityY[b] += impulse.y * wb;
+		}
+	}
+
+}
@@ -0,0 +1,143 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// extended position based dynamics solver with graph coloured batches -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "core/aligned_array.h"
+#include "core/job_system.h"
+#include "core/linear_arena.h"
+#include "physics/aabb.h"
+#include "physics/body_store.h"
+#include "physics/broadphase.h"
+#include "physics/contact.h"
+#include "physics/contact_solver.h"
+#include "physics/graph_colouring.h"
+#include "physics/island_manager.h"
+
+namespace psix {
+
+	struct XpbdSettings {
+		int substeps = 8;				// the step is split into this many small steps
+		int iterations = 1;				// constraint passes per substep
+		float contactCompliance = 0.0f;	// inverse stiffness of contacts, 0 is rigid
+		// contacts are gathered once per step, shapes closer than this get one
+		// so the substeps see the contacts they move into
+		float contactMargin = 0.02f;
+	};
+
+	// compliance is the inverse stiffness (m/N), 0 makes a constraint rigid
+
+	struct DistanceConstraint {
+		BodyId a;
+		BodyId b;
+		float restLength;
+		float compliance;
+	};
+
+	// keeps the middle body at its rest distance from the centroid of the three
+	struct BendingConstraint {
+		BodyId a;
+		BodyId b;	// middle body
+		BodyId c;
+		float restHeight;
+		float compliance;
+	};
+
+	// area of a closed loop of bodies in counter-clockwise order
+	struct VolumeConstraint {
+		std::uint32_t first;	// into the volume body list
+		std::uint32_t count;
+		float restArea;
+		float compliance;
+	};
+
+	enum class ConstraintType : std::uint32_t {
+		Distance,
+		Bending,
+		Volume
+	};
+
+	struct ConstraintRef {
+		ConstraintType type;
+		std::uint32_t index;
+	};
+
+	// a run of constraints or contacts with the same colour
+	struct ColourBatch {
+		std::uint32_t begin;
+		std::uint32_t end;
+		bool serial;	// the overflow colour
+	};
+
+	// every step is split into substeps: predict positions from the velocities,
+	// project the constraints and contacts onto the predicted positions, then
+	// derive the velocities from the position change. constraints are kept
+	// coloured between steps, contacts are coloured every step. colours are
+	// solved one after another, each colour is split over the job system
+
+	class XpbdSolver {
+	public:
+		explicit XpbdSolver(const XpbdSettings& settings = XpbdSettings());
+		void setSettings(const XpbdSettings& newSettings) { settings = newSettings; }
+		const XpbdSettings& xpbdSettings() const { return settings; }
+		// rest values are taken from the current positions, returns the constraint index
+		std::uint32_t addDistance(const BodyStore& bodies, BodyId a, BodyId b, float compliance);
+		std::uint32_t addBending(const BodyStore& bodies, BodyId a, BodyId b, BodyId c, float compliance);
+		// pressure scales the rest area, above 1 inflates the loop
+		std::uint32_t addVolume(const BodyStore& bodies, const BodyId* ids, std::size_t count, float compliance, float pressure = 1.0f);
+		// neighbouring bodies of every constraint, islands use them as edges
+		const std::vector<BodyPair>& links() const { return constraintLinks; }
+		std::size_t constraintCount() const { return distances.size() + bendings.size() + volumes.size(); }
+		std::uint32_t constraintColours() const { return constraintColouring.colourCount(); }
+		std::uint32_t contactColours() const { return contactColouring.colourCount(); }
+		// time the last step spent predicting and deriving velocities
+		double lastIntegrateMs() const { return integrateMs; }
+		// advance the awake bodies by dt, manifolds are the contacts found at the start of the step
+		void step(BodyStore& bodies, const std::vector<BodyRange>& awakeRanges, const ContactManifold* manifolds, std::size_t count,
+			const Aabb* staticBoxes, const ContactSettings& contactSettings, const Vec2& gravity, float dt, JobSystem* jobs, LinearArena& arena);
+	private:
+		struct ContactState {
+			Vec2 normal;
+			float normalVelocity;	// before the substep, for restitution
+			float lambda;
+		};
+		void colourConstraints(const BodyStore& bodies);
+		void colourContacts(const BodyStore& bodies, const ContactManifold* manifolds, std::size_t count, LinearArena& arena);
+		void solveConstraint(BodyStore& bodies, const ConstraintRef& ref, float alphaScale);
+		void solveDistance(BodyStore& bodies, std::uint32_t index, float alphaScale);
+		void solveBending(BodyStore& bodies, std::uint32_t index, float alphaScale);
+		void solveVolume(BodyStore& bodies, std::uint32_t index, float alphaScale);
+		void solveContact(BodyStore& bodies, const ContactManifold& manifold, ContactState& state, const Aabb* staticBoxes, float alphaScale) const;
+		void solveContactVelocity(BodyStore& bodies, const ContactManifold& manifold, const ContactState& state, float threshold) const;
+		template <typename F>
+		void forEachInBatches(const std::vector<ColourBatch>& batches, JobSystem* jobs, const F& body);
+
+		XpbdSettings settings;
+		std::vector<DistanceConstraint> distances;
+		std::vector<BendingConstraint> bendings;
+		std::vector<VolumeConstraint> volumes;
+		std::vector<BodyId> volumeBodies;
+		std::vector<float> distanceLambda;
+		std::vector<float> bendingLambda;
+		std::vector<float> volumeLambda;
+		std::vector<BodyPair> constraintLinks;
+		// constraints in colour order, rebuilt when constraints are added
+		GraphColouring constraintColouring;
+		std::vector<ConstraintRef> constraintOrder;
+		std::vector<ColourBatch> constraintBatches;
+		bool coloursDirty = false;
+		// contacts in colour order, these point into the step arena
+		GraphColouring contactColouring;
+		const std::uint32_t* contactOrder = nullptr;
+		std::vector<ColourBatch> contactBatches;
+		// positions at the start of the substep
+		AlignedArray<float> substepX;
+		AlignedArray<float> substepY;
+		double integrateMs = 0.0;
+	};
+
+}
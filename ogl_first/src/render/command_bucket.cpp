@@ -0,0 +1,147 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// draw commands recorded with a sort key, sorted and submitted with few state changes -->
+
+#include "render/command_bucket.h"
+#include <cstring>
+#include "render/gl_state.h"
+#include "render/uniform_blocks.h"
+
+namespace psix {
+
+	DrawCommand& CommandBucket::add(std::uint64_t key) {
+		DrawCommand* command = arena.allocateArray<DrawCommand>(1);
+		*command = DrawCommand();
+		entries.push_back(Entry{ key, command });
+		return *command;
+	}
+
+	void CommandBucket::clear() {
+		entries.clear();
+		arena.reset();
+	}
+
+	SubmitStats CommandBucket::submit() {
+		CommandBucket* self = this;
+		return submitBuckets(&self, 1);
+	}
+
+	namespace {
+
+		struct SortEntry {
+			std::uint64_t key;
+			const DrawCommand* command;
+		};
+
+		// only the gl thread submits, the scratch arrays are kept between frames
+		std::vector<SortEntry> sortEntries;
+		std::vector<SortEntry> sortScratch;
+
+		// lsd radix sort on 8 bit digits. one pass builds all histograms and
+		// digits that are equal for every key are skipped, which drops most
+		// passes since few layers, programs and materials are in use
+		void radixSort(std::vector<SortEntry>& items, std::vector<SortEntry>& scratch) {
+			const std::size_t count = items.size();
+			if (count < 2) {
+				return;
+			}
+			std::uint32_t histograms[8][256];
+			std::memset(histograms, 0, sizeof(histograms));
+			for (const SortEntry& item : items) {
+				for (int digit = 0; digit < 8; digit++) {
+					histograms[digit][(item.key >> (digit * 8)) & 0xff]++;
+				}
+			}
+			scratch.resize(count);
+			SortEntry* source = items.data();
+			SortEntry* target = scratch.data();
+			for (int digit = 0; digit < 8; digit++) {
+				std::uint32_t* histogram = histograms[digit];
+				if (histogram[(source[0].key >> (digit * 8)) & 0xff] == count) {
+					continue;
+				}
+				std::uint32_t running = 0;
+				for (int bucket = 0; bucket < 256; bucket++) {
+					std::uint32_t bucketCount = histogram[bucket];
+					histogram[bucket] = running;
+					running += bucketCount;
+				}
+				for (std::size_t i = 0; i < count; i++) {
+					target[histogram[(source[i].key >> (digit * 8)) & 0xff]++] = source[i];
+				}
+				SortEntry* swap = source;
+				source = target;
+				target = swap;
+			}
+			if (source != items.data()) {
+				std::memcpy(items.data(), source, count * sizeof(SortEntry));
+			}
+		}
+
+		void execute(const DrawCommand& command) {
+			if (command.prepare != nullptr) {
+				command.prepare(command);
+			}
+			if (command.indexType == 0) {
+				if (command.instanceCount > 0) {
+					glDrawArraysInstanced(command.mode, command.first, command.count, command.instanceCount);
+				}
+				else {
+					glDrawArrays(command.mode, command.first, command.count);
+				}
+			}
+			else {
+				const void* indices = reinterpret_cast<const void*>(command.indexOffset);
+				if (command.instanceCount > 0) {
+					glDrawElementsInstanced(command.mode, command.count, command.indexType, indices, command.instanceCount);
+				}
+				else {
+					glDrawElements(command.mode, command.count, command.indexType, indices);
+				}
+			}
+		}
+
+	}
+
+	SubmitStats submitBuckets(CommandBucket* const* buckets, std::size_t count) {
+		SubmitStats stats;
+		sortEntries.clear();
+		for (std::size_t b = 0; b < count; b++) {
+			for (const CommandBucket::Entry& entry : buckets[b]->entries) {
+				sortEntries.push_back(SortEntry{ entry.key, entry.command });
+			}
+		}
+		radixSort(sortEntries, sortScratch);
+		// the state cache drops repeated binds, the counters here show how
+		// well the sort grouped the commands
+		const DrawCommand* previous = nullptr;
+		GlState& state = glState();
+		for (const SortEntry& entry : sortEntries) {
+			const DrawCommand& command = *entry.command;
+			if (previous == nullptr || previous->program != command.program) {
+				stats.programChanges++;
+			}
+			if (previous == nullptr || previous->vao != command.vao) {
+				stats.vertexArrayChanges++;
+			}
+			bool sameMaterial = previous != nullptr && previous->materialBuffer == command.materialBuffer
+				&& previous->materialOffset == command.materialOffset && previous->materialSize == command.materialSize;
+			if (!sameMaterial && command.materialBuffer != 0) {
+				stats.materialChanges++;
+			}
+			state.useProgram(command.program);
+			state.bindVertexArray(command.vao);
+			if (command.materialBuffer != 0) {
+				state.bindBufferRange(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_BINDING, command.materialBuffer, command.materialOffset, command.materialSize);
+			}
+			execute(command);
+			previous = &command;
+		}
+		stats.commands = sortEntries.size();
+		for (std::size_t b = 0; b < count; b++) {
+			buckets[b]->clear();
+		}
+		return stats;
+	}
+
+}
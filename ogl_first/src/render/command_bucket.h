@@ -0,0 +1,88 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// draw commands recorded with a sort key, sorted and submitted with few state changes -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "core/linear_arena.h"
+
+namespace psix {
+
+	// 64 bit sort key, most significant first:
+	// layer 4 | program 10 | material 12 | vao 12 | depth 24 | 2 unused.
+	// ids are the low bits of the gl names, collisions only cost a state change
+
+	inline std::uint64_t makeSortKey(std::uint32_t layer, GLuint program, std::uint32_t material, GLuint vao, float depth = 0.0f) {
+		depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+		std::uint64_t quantizedDepth = static_cast<std::uint64_t>(depth * 16777215.0f);
+		return (static_cast<std::uint64_t>(layer & 0xfu) << 60)
+			| (static_cast<std::uint64_t>(program & 0x3ffu) << 50)
+			| (static_cast<std::uint64_t>(material & 0xfffu) << 38)
+			| (static_cast<std::uint64_t>(vao & 0xfffu) << 26)
+			| (quantizedDepth << 2);
+	}
+
+	struct DrawCommand;
+	// called after the state of the command is bound, right before the draw
+	using DrawPrepare = void (*)(const DrawCommand& command);
+
+	struct DrawCommand {
+		GLuint program = 0;
+		GLuint vao = 0;
+		// uniform buffer range bound at MATERIAL_BLOCK_BINDING, buffer 0 binds nothing
+		GLuint materialBuffer = 0;
+		std::uint32_t materialOffset = 0;
+		std::uint32_t materialSize = 0;
+		GLenum mode = GL_TRIANGLES;
+		GLenum indexType = 0;			// 0 draws arrays
+		GLint first = 0;
+		GLsizei count = 0;
+		GLsizei instanceCount = 0;		// 0 is a plain draw
+		GLintptr indexOffset = 0;
+		DrawPrepare prepare = nullptr;
+		const void* userData = nullptr;
+		std::uint64_t userValue = 0;
+	};
+
+	struct SubmitStats {
+		std::size_t commands = 0;
+		std::size_t programChanges = 0;
+		std::size_t vertexArrayChanges = 0;
+		std::size_t materialChanges = 0;
+	};
+
+	// commands live in the arena of the bucket until clear(). a bucket is
+	// recorded by a single thread, several threads record into their own
+	// buckets and the gl thread merges them in submitBuckets()
+
+	class CommandBucket {
+	public:
+		explicit CommandBucket(std::size_t arenaBlockSize = 256 * 1024) : arena(arenaBlockSize) {}
+		CommandBucket(const CommandBucket&) = delete;
+		CommandBucket& operator=(const CommandBucket&) = delete;
+		DrawCommand& add(std::uint64_t key);
+		std::size_t size() const { return entries.size(); }
+		void clear();
+		// sorts and executes this bucket alone, then clears it
+		SubmitStats submit();
+	private:
+		friend SubmitStats submitBuckets(CommandBucket* const* buckets, std::size_t count);
+		struct Entry {
+			std::uint64_t key;
+			const DrawCommand* command;
+		};
+
+		LinearArena arena;
+		std::vector<Entry> entries;
+	};
+
+	// merges the buckets, radix sorts all commands by key (stable, so equal keys
+	// keep the recording order) and executes them on the calling gl thread.
+	// the buckets are cleared afterwards
+	SubmitStats submitBuckets(CommandBucket* const* buckets, std::size_t count);
+
+}
@@ -0,0 +1,247 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// cache of the bound gl state, redundant binds and state changes are dropped -->
+
+#include "render/gl_state.h"
+#include <cmath>
+
+namespace psix {
+
+	// never a real object name or enum, marks a value as unknown
+	constexpr GLuint UNKNOWN = 0xffffffffu;
+
+	GlState& glState() {
+		static GlState state;
+		return state;
+	}
+
+	void GlState::invalidate() {
+		boundProgram = UNKNOWN;
+		boundVertexArray = UNKNOWN;
+		for (GLuint& buffer : buffers) {
+			buffer = UNKNOWN;
+		}
+		for (RangeBinding& binding : uniformBindings) {
+			binding = RangeBinding{ UNKNOWN, 0, -1 };
+		}
+		activeUnit = UNKNOWN;
+		for (GLuint& texture : textures) {
+			texture = UNKNOWN;
+		}
+		for (std::int8_t& capability : capabilities) {
+			capability = -1;
+		}
+		blendSource = UNKNOWN;
+		blendDestination = UNKNOWN;
+		depthFunction = UNKNOWN;
+		depthWrite = -1;
+		viewportRect[0] = viewportRect[1] = viewportRect[2] = viewportRect[3] = -1;
+		// a nan never compares equal, the first clear colour is always set
+		clear[0] = clear[1] = clear[2] = clear[3] = NAN;
+	}
+
+	int GlState::bufferSlot(GLenum target) {
+		switch (target) {
+		case GL_ARRAY_BUFFER: return ARRAY_SLOT;
+		case GL_UNIFORM_BUFFER: return UNIFORM_SLOT;
+		case GL_COPY_READ_BUFFER: return COPY_READ_SLOT;
+		case GL_COPY_WRITE_BUFFER: return COPY_WRITE_SLOT;
+		case GL_PIXEL_PACK_BUFFER: return PIXEL_PACK_SLOT;
+		case GL_PIXEL_UNPACK_BUFFER: return PIXEL_UNPACK_SLOT;
+		default: return -1;
+		}
+	}
+
+	int GlState::capabilitySlot(GLenum capability) {
+		switch (capability) {
+		case GL_BLEND: return BLEND_SLOT;
+		case GL_DEPTH_TEST: return DEPTH_TEST_SLOT;
+		case GL_CULL_FACE: return CULL_FACE_SLOT;
+		case GL_SCISSOR_TEST: return SCISSOR_TEST_SLOT;
+		default: return -1;
+		}
+	}
+
+	void GlState::useProgram(GLuint program) {
+		if (boundProgram == program ? keep() : change()) {
+			glUseProgram(program);
+			boundProgram = program;
+		}
+	}
+
+	void GlState::bindVertexArray(GLuint vao) {
+		if (boundVertexArray == vao ? keep() : change()) {
+			glBindVertexArray(vao);
+			boundVertexArray = vao;
+		}
+	}
+
+	void GlState::bindBuffer(GLenum target, GLuint buffer) {
+		int slot = bufferSlot(target);
+		if (slot < 0) {
+			// element arrays and unknown targets are always forwarded
+			change();
+			glBindBuffer(target, buffer);
+			return;
+		}
+		if (buffers[slot] == buffer ? keep() : change()) {
+			glBindBuffer(target, buffer);
+			buffers[slot] = buffer;
+		}
+	}
+
+	void GlState::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+		if (target != GL_UNIFORM_BUFFER || index >= MAX_UNIFORM_BINDINGS) {
+			change();
+			glBindBufferBase(target, index, buffer);
+			return;
+		}
+		RangeBinding& binding = uniformBindings[index];
+		if (binding.buffer == buffer && binding.size < 0 ? keep() : change()) {
+			glBindBufferBase(target, index, buffer);
+			binding = RangeBinding{ buffer, 0, -1 };
+			// also binds the generic target
+			buffers[UNIFORM_SLOT] = buffer;
+		}
+	}
+
+	void GlState::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+		if (target != GL_UNIFORM_BUFFER || index >= MAX_UNIFORM_BINDINGS) {
+			change();
+			glBindBufferRange(target, index, buffer, offset, size);
+			return;
+		}
+		RangeBinding& binding = uniformBindings[index];
+		if (binding.buffer == buffer && binding.offset == offset && binding.size == size ? keep() : change()) {
+			glBindBufferRange(target, index, buffer, offset, size);
+			binding = RangeBinding{ buffer, offset, size };
+			buffers[UNIFORM_SLOT] = buffer;
+		}
+	}
+
+	void GlState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+		if (unit >= MAX_TEXTURE_UNITS || target != GL_TEXTURE_2D) {
+			change();
+			glActiveTexture(GL_TEXTURE0 + unit);
+			activeUnit = unit;
+			glBindTexture(target, texture);
+			return;
+		}
+		if (textures[unit] == texture) {
+			keep();
+			return;
+		}
+		if (activeUnit != unit) {
+			change();
+			glActiveTexture(GL_TEXTURE0 + unit);
+			activeUnit = unit;
+		}
+		change();
+		glBindTexture(target, texture);
+		textures[unit] = texture;
+	}
+
+	void GlState::setEnabled(GLenum capability, bool enabled) {
+		int slot = capabilitySlot(capability);
+		std::int8_t value = enabled ? 1 : 0;
+		if (slot >= 0 && capabilities[slot] == value) {
+			keep();
+			return;
+		}
+		change();
+		if (enabled) {
+			glEnable(capability);
+		}
+		else {
+			glDisable(capability);
+		}
+		if (slot >= 0) {
+			capabilities[slot] = value;
+		}
+	}
+
+	void GlState::blendFunc(GLenum source, GLenum destination) {
+		if (blendSource == source && blendDestination == destination ? keep() : change()) {
+			glBlendFunc(source, destination);
+			blendSource = source;
+			blendDestination = destination;
+		}
+	}
+
+	void GlState::depthFunc(GLenum function) {
+		if (depthFunction == function ? keep() : change()) {
+			glDepthFunc(function);
+			depthFunction = function;
+		}
+	}
+
+	void GlState::depthMask(bool write) {
+		std::int8_t value = write ? 1 : 0;
+		if (depthWrite == value ? keep() : change()) {
+			glDepthMask(write ? GL_TRUE : GL_FALSE);
+			depthWrite = value;
+		}
+	}
+
+	void GlState::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+		bool same = viewportRect[0] == x && viewportRect[1] == y && viewportRect[2] == width && viewportRect[3] == height;
+		if (same ? keep() : change()) {
+			glViewport(x, y, width, height);
+			viewportRect[0] = x;
+			viewportRect[1] = y;
+			viewportRect[2] = width;
+			viewportRect[3] = height;
+		}
+	}
+
+	void GlState::clearColor(float red, float green, float blue, float alpha) {
+		bool same = clear[0] == red && clear[1] == green && clear[2] == blue && clear[3] == alpha;
+		if (same ? keep() : change()) {
+			glClearColor(red, green, blue, alpha);
+			clear[0] = red;
+			clear[1] = green;
+			clear[2] = blue;
+			clear[3] = alpha;
+		}
+	}
+
+	void GlState::deleted(GlObject kind, GLuint object) {
+		switch (kind) {
+		case GlObject::Program:
+			if (boundProgram == object) {
+				boundProgram = 0;
+			}
+			break;
+		case GlObject::VertexArray:
+			if (boundVertexArray == object) {
+				boundVertexArray = 0;
+			}
+			break;
+		case GlObject::Buffer:
+			for (GLuint& buffer : buffers) {
+				if (buffer == object) {
+					buffer = 0;
+				}
+			}
+			for (RangeBinding& binding : uniformBindings) {
+				if (binding.buffer == object) {
+					binding = RangeBinding{ 0, 0, -1 };
+				}
+			}
+			break;
+		case GlObject::Texture:
+			for (GLuint& texture : textures) {
+				if (texture == object) {
+					texture = 0;
+				}
+			}
+			break;
+		}
+	}
+
+	void GlState::beginFrame() {
+		lastFrame = current;
+		current = GlStateStats();
+	}
+
+}
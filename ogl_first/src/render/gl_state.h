@@ -0,0 +1,107 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// cache of the bound gl state, redundant binds and state changes are dropped -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+
+namespace psix {
+
+	struct GlStateStats {
+		std::size_t issued = 0;
+		std::size_t skipped = 0;
+	};
+
+	enum class GlObject {
+		Program,
+		VertexArray,
+		Buffer,
+		Texture
+	};
+
+	// remembers what the context has bound and only forwards calls that change
+	// something. every bind in the render code goes through here, a raw gl call
+	// that changes cached state has to be followed by invalidate().
+	//
+	// the element array binding belongs to the bound vao and is not cached,
+	// deleting an object has to be reported so a recycled name is bound again
+
+	class GlState {
+	public:
+		static constexpr int MAX_TEXTURE_UNITS = 16;
+		static constexpr int MAX_UNIFORM_BINDINGS = 16;
+
+		GlState() { invalidate(); }
+		// forget everything, the next call of each kind is always issued
+		void invalidate();
+		void useProgram(GLuint program);
+		void bindVertexArray(GLuint vao);
+		void bindBuffer(GLenum target, GLuint buffer);
+		void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+		void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+		void bindTexture(GLuint unit, GLenum target, GLuint texture);
+		void setEnabled(GLenum capability, bool enabled);
+		void blendFunc(GLenum source, GLenum destination);
+		void depthFunc(GLenum function);
+		void depthMask(bool write);
+		void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+		void clearColor(float red, float green, float blue, float alpha);
+		// deleting a bound object binds 0 in its place
+		void deleted(GlObject kind, GLuint object);
+		GLuint program() const { return boundProgram; }
+		GLuint vertexArray() const { return boundVertexArray; }
+		// counters of the running frame, beginFrame() moves them to lastFrameStats()
+		void beginFrame();
+		const GlStateStats& stats() const { return current; }
+		const GlStateStats& lastFrameStats() const { return lastFrame; }
+	private:
+		enum BufferSlot {
+			ARRAY_SLOT,
+			UNIFORM_SLOT,
+			COPY_READ_SLOT,
+			COPY_WRITE_SLOT,
+			PIXEL_PACK_SLOT,
+			PIXEL_UNPACK_SLOT,
+			BUFFER_SLOT_COUNT
+		};
+		enum CapabilitySlot {
+			BLEND_SLOT,
+			DEPTH_TEST_SLOT,
+			CULL_FACE_SLOT,
+			SCISSOR_TEST_SLOT,
+			CAPABILITY_SLOT_COUNT
+		};
+		struct RangeBinding {
+			GLuint buffer;
+			GLintptr offset;
+			GLsizeiptr size;	// -1 for a base binding
+		};
+		static int bufferSlot(GLenum target);
+		static int capabilitySlot(GLenum capability);
+		bool change() { current.issued++; return true; }
+		bool keep() { current.skipped++; return false; }
+
+		GLuint boundProgram;
+		GLuint boundVertexArray;
+		GLuint buffers[BUFFER_SLOT_COUNT];
+		RangeBinding uniformBindings[MAX_UNIFORM_BINDINGS];
+		GLuint activeUnit;
+		GLuint textures[MAX_TEXTURE_UNITS];
+		std::int8_t capabilities[CAPABILITY_SLOT_COUNT];	// -1 unknown
+		GLenum blendSource;
+		GLenum blendDestination;
+		GLenum depthFunction;
+		std::int8_t depthWrite;
+		GLint viewportRect[4];
+		float clear[4];
+		GlStateStats current;
+		GlStateStats lastFrame;
+	};
+
+	// the state of the context of the render thread, there is one per application
+	GlState& glState();
+
+}
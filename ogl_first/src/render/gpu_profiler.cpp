@@ -0,0 +1,112 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// gpu and cpu time of named render passes, read back from a ring of timer queries -->
+
+#include "render/gpu_profiler.h"
+
+namespace psix {
+
+	namespace {
+
+		double milliseconds(std::chrono::steady_clock::duration duration) {
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+
+	}
+
+	void GpuProfiler::init(int framesInFlight) {
+		frameCount = framesInFlight < 1 ? 1 : (framesInFlight > MAX_FRAMES ? MAX_FRAMES : framesInFlight);
+		for (int i = 0; i < frameCount; i++) {
+			glGenQueries(MAX_PASSES * 2, frames[i].timestamps);
+			glGenQueries(1, &frames[i].elapsed);
+			frames[i].pending = false;
+		}
+		current = 0;
+		frameNumber = 0;
+		frameTiming = GpuFrameTiming();
+		initialized = true;
+	}
+
+	void GpuProfiler::destroy() {
+		if (!initialized) {
+			return;
+		}
+		for (int i = 0; i < frameCount; i++) {
+			glDeleteQueries(MAX_PASSES * 2, frames[i].timestamps);
+			glDeleteQueries(1, &frames[i].elapsed);
+			frames[i] = FrameQueries();
+		}
+		initialized = false;
+	}
+
+	bool GpuProfiler::readBack(FrameQueries& queries) {
+		// the elapsed query ends last, once it is there all timestamps are too
+		GLint available = 0;
+		glGetQueryObjectiv(queries.elapsed, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == 0) {
+			return false;
+		}
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(queries.elapsed, GL_QUERY_RESULT, &elapsed);
+		for (int i = 0; i < queries.passCount; i++) {
+			GLuint64 begin = 0;
+			GLuint64 end = 0;
+			glGetQueryObjectui64v(queries.timestamps[i * 2], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(queries.timestamps[i * 2 + 1], GL_QUERY_RESULT, &end);
+			passTimings[i].name = queries.names[i];
+			passTimings[i].cpuMs = queries.cpuMs[i];
+			passTimings[i].gpuMs = end > begin ? static_cast<double>(end - begin) * 1.0e-6 : 0.0;
+		}
+		frameTiming.cpuMs = queries.frameCpuMs;
+		frameTiming.gpuMs = static_cast<double>(elapsed) * 1.0e-6;
+		frameTiming.passCount = queries.passCount;
+		frameTiming.frame = queries.frame;
+		return true;
+	}
+
+	void GpuProfiler::beginFrame() {
+		FrameQueries& queries = frames[current];
+		if (queries.pending) {
+			// reusing the queries drops the old results, they are not waited for
+			if (!readBack(queries)) {
+				frameTiming.skippedReads++;
+			}
+			queries.pending = false;
+		}
+		queries.passCount = 0;
+		queries.frame = frameNumber;
+		frameStart = Clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, queries.elapsed);
+	}
+
+	int GpuProfiler::beginPass(const char* name) {
+		FrameQueries& queries = frames[current];
+		if (queries.passCount >= MAX_PASSES) {
+			return -1;
+		}
+		int pass = queries.passCount++;
+		queries.names[pass] = name;
+		glQueryCounter(queries.timestamps[pass * 2], GL_TIMESTAMP);
+		passStart[pass] = Clock::now();
+		return pass;
+	}
+
+	void GpuProfiler::endPass(int pass) {
+		if (pass < 0) {
+			return;
+		}
+		FrameQueries& queries = frames[current];
+		queries.cpuMs[pass] = milliseconds(Clock::now() - passStart[pass]);
+		glQueryCounter(queries.timestamps[pass * 2 + 1], GL_TIMESTAMP);
+	}
+
+	void GpuProfiler::endFrame() {
+		FrameQueries& queries = frames[current];
+		glEndQuery(GL_TIME_ELAPSED);
+		queries.frameCpuMs = milliseconds(Clock::now() - frameStart);
+		queries.pending = true;
+		current = (current + 1) % frameCount;
+		frameNumber++;
+	}
+
+}
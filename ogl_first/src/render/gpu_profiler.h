@@ -0,0 +1,99 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// gpu and cpu time of named render passes, read back from a ring of timer queries -->
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+
+namespace psix {
+
+	struct PassTiming {
+		const char* name = nullptr;
+		double cpuMs = 0.0;
+		double gpuMs = 0.0;
+	};
+
+	struct GpuFrameTiming {
+		double cpuMs = 0.0;			// between beginFrame() and endFrame()
+		double gpuMs = 0.0;			// GL_TIME_ELAPSED over the same commands
+		int passCount = 0;
+		std::uint64_t frame = 0;	// the frame the results belong to
+		std::size_t skippedReads = 0;	// frames whose queries were not ready in time
+	};
+
+	// every pass puts a GL_TIMESTAMP query at its begin and end, the whole frame
+	// is wrapped in one GL_TIME_ELAPSED query. the queries of a frame are read
+	// framesInFlight frames later when the gpu is done with them, so reading
+	// never stalls. a frame whose queries are still not available is skipped
+	// and the previous results stay.
+	//
+	// per frame: beginFrame() -> (beginPass() -> endPass())... -> endFrame()
+	//
+	// passes do not nest, the names have to outlive the profiler (literals)
+
+	class GpuProfiler {
+	public:
+		static constexpr int MAX_PASSES = 16;
+		static constexpr int MAX_FRAMES = 4;
+
+		GpuProfiler() = default;
+		~GpuProfiler() { destroy(); }
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+		// needs a current gl context, framesInFlight at most MAX_FRAMES
+		void init(int framesInFlight = 3);
+		void destroy();
+		// reads the results of the oldest frame if they are ready
+		void beginFrame();
+		// returns the pass index for endPass(), -1 once MAX_PASSES are in use
+		int beginPass(const char* name);
+		void endPass(int pass);
+		void endFrame();
+		// timings of the last frame that was read back
+		const GpuFrameTiming& lastFrame() const { return frameTiming; }
+		const PassTiming& pass(int index) const { return passTimings[index]; }
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct FrameQueries {
+			GLuint timestamps[MAX_PASSES * 2] = {};
+			GLuint elapsed = 0;
+			const char* names[MAX_PASSES] = {};
+			double cpuMs[MAX_PASSES] = {};
+			double frameCpuMs = 0.0;
+			int passCount = 0;
+			std::uint64_t frame = 0;
+			bool pending = false;		// queries issued and not read yet
+		};
+
+		// false when the queries of the slot are not available yet
+		bool readBack(FrameQueries& queries);
+
+		FrameQueries frames[MAX_FRAMES];
+		int frameCount = 0;
+		int current = 0;
+		std::uint64_t frameNumber = 0;
+		bool initialized = false;
+		Clock::time_point frameStart;
+		Clock::time_point passStart[MAX_PASSES];
+		GpuFrameTiming frameTiming;
+		PassTiming passTimings[MAX_PASSES];
+	};
+
+	// times a pass for the lifetime of the scope
+	class ProfilePass {
+	public:
+		ProfilePass(GpuProfiler& profiler, const char* name) : profiler(profiler), index(profiler.beginPass(name)) {}
+		~ProfilePass() { profiler.endPass(index); }
+		ProfilePass(const ProfilePass&) = delete;
+		ProfilePass& operator=(const ProfilePass&) = delete;
+	private:
+		GpuProfiler& profiler;
+		int index;
+	};
+
+}
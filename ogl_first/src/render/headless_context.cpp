@@ -0,0 +1,153 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// gl context without a window or display, for benchmarks and image tests -->
+
+#include "render/headless_context.h"
+#include <cstring>
+
+#if defined(PSIX_HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace psix {
+
+#if defined(PSIX_HEADLESS_EGL)
+
+	namespace {
+
+		bool hasExtension(const char* extensions, const char* name) {
+			if (extensions == nullptr) {
+				return false;
+			}
+			const std::size_t length = std::strlen(name);
+			for (const char* found = std::strstr(extensions, name); found != nullptr; found = std::strstr(found + length, name)) {
+				const bool startsWord = found == extensions || found[-1] == ' ';
+				const bool endsWord = found[length] == ' ' || found[length] == '\0';
+				if (startsWord && endsWord) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// the surfaceless platform needs no gpu device or display server, the
+		// default display is the fallback for drivers without it
+		EGLDisplay openDisplay() {
+			const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+			if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless") && hasExtension(clientExtensions, "EGL_EXT_platform_base")) {
+				PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+					reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+				if (getPlatformDisplay != nullptr) {
+					EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+					if (display != EGL_NO_DISPLAY) {
+						return display;
+					}
+				}
+			}
+			return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		}
+
+	}
+
+	bool HeadlessContext::create() {
+		destroy();
+		EGLDisplay eglDisplay = openDisplay();
+		if (eglDisplay == EGL_NO_DISPLAY || eglInitialize(eglDisplay, nullptr, nullptr) == EGL_FALSE) {
+			errorLog = "no egl display";
+			return false;
+		}
+		display = eglDisplay;
+		if (!hasExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+			errorLog = "EGL_KHR_surfaceless_context is not supported";
+			destroy();
+			return false;
+		}
+		if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+			errorLog = "desktop opengl is not supported by egl";
+			destroy();
+			return false;
+		}
+		// the default surface type is window, which surfaceless displays do not offer
+		const EGLint configAttributes[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8,
+			EGL_GREEN_SIZE, 8,
+			EGL_BLUE_SIZE, 8,
+			EGL_ALPHA_SIZE, 8,
+			EGL_NONE
+		};
+		EGLConfig config = nullptr;
+		EGLint configCount = 0;
+		if (eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) == EGL_FALSE || configCount == 0) {
+			errorLog = "no egl config for desktop opengl";
+			destroy();
+			return false;
+		}
+		// same version and profile the window path asks glfw for
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 3,
+			EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+		if (eglContext == EGL_NO_CONTEXT) {
+			errorLog = "could not create a 3.3 core context";
+			destroy();
+			return false;
+		}
+		context = eglContext;
+		if (eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext) == EGL_FALSE) {
+			errorLog = "could not make the context current";
+			destroy();
+			return false;
+		}
+		errorLog.clear();
+		return true;
+	}
+
+	void HeadlessContext::destroy() {
+		if (display == nullptr) {
+			return;
+		}
+		if (context != nullptr) {
+			eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			eglDestroyContext(display, context);
+			context = nullptr;
+		}
+		eglTerminate(display);
+		display = nullptr;
+	}
+
+	bool HeadlessContext::supported() {
+		return true;
+	}
+
+	GLADloadproc HeadlessContext::loader() {
+		// mesa and the nvidia driver hand out core functions too (EGL_KHR_get_all_proc_addresses)
+		return reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+	}
+
+#else
+
+	bool HeadlessContext::create() {
+		errorLog = "built without headless support, define PSIX_HEADLESS_EGL and link libEGL";
+		return false;
+	}
+
+	void HeadlessContext::destroy() {
+	}
+
+	bool HeadlessContext::supported() {
+		return false;
+	}
+
+	GLADloadproc HeadlessContext::loader() {
+		return nullptr;
+	}
+
+#endif
+
+}
@@ -0,0 +1,41 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// gl context without a window or display, for benchmarks and image tests -->
+
+#pragma once
+
+#include <string>
+#include <glad/glad.h>
+
+namespace psix {
+
+	// a 3.3 core context made current without any surface through egl
+	// (EGL_KHR_surfaceless_context, on mesa this includes llvmpipe). it renders
+	// into an OffscreenTarget since there is no default framebuffer.
+	//
+	// only built with PSIX_HEADLESS_EGL defined (and linked against libEGL),
+	// otherwise create() fails and the window path is the only one
+
+	class HeadlessContext {
+	public:
+		HeadlessContext() = default;
+		~HeadlessContext() { destroy(); }
+		HeadlessContext(const HeadlessContext&) = delete;
+		HeadlessContext& operator=(const HeadlessContext&) = delete;
+		// makes the context current on the calling thread, see error() on failure
+		bool create();
+		void destroy();
+		bool isCurrent() const { return context != nullptr; }
+		const std::string& error() const { return errorLog; }
+		// whether the egl backend was compiled in
+		static bool supported();
+		// for gladLoadGLLoader once create() succeeded
+		static GLADloadproc loader();
+	private:
+		// EGLDisplay and EGLContext, kept opaque so egl.h stays out of the header
+		void* display = nullptr;
+		void* context = nullptr;
+		std::string errorLog;
+	};
+
+}
@@ -0,0 +1,246 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// instanced renderer, one draw call per shape type for any number of bodies -->
+
+#include "render/instanced_renderer.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include "render/gl_state.h"
+
+namespace psix {
+
+	namespace {
+
+		const char* const SHAPE_NAMES[] = { "triangle", "quad", "circle" };
+		static_assert(sizeof(SHAPE_NAMES) / sizeof(SHAPE_NAMES[0]) == static_cast<int>(ShapeType::Count), "a name for every shape");
+
+		std::string meshSectionName(int shape, const char* part) {
+			return std::string("meshes/") + SHAPE_NAMES[shape] + "/" + part;
+		}
+
+	}
+
+	void InstancedRenderer::destroy() {
+		for (ShapeBatch& batch : batches) {
+			if (batch.vao == 0) {
+				continue;
+			}
+			glDeleteVertexArrays(1, &batch.vao);
+			glState().deleted(GlObject::VertexArray, batch.vao);
+			glDeleteBuffers(1, &batch.vertexBuffer);
+			glState().deleted(GlObject::Buffer, batch.vertexBuffer);
+			if (batch.indexBuffer != 0) {
+				glDeleteBuffers(1, &batch.indexBuffer);
+			}
+			batch = ShapeBatch();
+		}
+		instanceStream.destroy();
+	}
+
+	void InstancedRenderer::init(int circleSegments, std::size_t streamBytes) {
+		instanceStream.init(GL_ARRAY_BUFFER, streamBytes);
+		// half float positions are exact for the unit meshes, the shader fills in z
+		meshFormat.add(0, AttributeFormat::Half2).add(1, AttributeFormat::UByte4Norm);
+		instanceFormat.add(INSTANCE_ATTRIBUTE, AttributeFormat::Float3).add(INSTANCE_COLOUR_ATTRIBUTE, AttributeFormat::UByte4Norm);
+		// the triangle keeps the colours of the original hard-coded one
+		std::vector<float> triangle = {
+			// positions // colors
+			0.5f, 0.5f,  1.0f, 0.0f, 0.0f, 1.0f,
+		   -0.5f, 0.5f,  0.0f, 1.0f, 0.0f, 1.0f,
+			0.0f, -0.5f, 0.0f, 0.0f, 1.0f, 1.0f
+		};
+		createBatch(batches[static_cast<int>(ShapeType::Triangle)], triangle, {});
+		std::vector<float> quad = {
+		   -0.5f, -0.5f, 1.0f, 1.0f, 1.0f, 1.0f,
+			0.5f, -0.5f, 1.0f, 1.0f, 1.0f, 1.0f,
+			0.5f, 0.5f,  1.0f, 1.0f, 1.0f, 1.0f,
+		   -0.5f, 0.5f,  1.0f, 1.0f, 1.0f, 1.0f
+		};
+		createBatch(batches[static_cast<int>(ShapeType::Quad)], quad, { 0, 1, 2, 2, 3, 0 });
+		// unit circle as an indexed fan around the centre vertex
+		std::vector<float> circle = { 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+		std::vector<GLushort> circleIndices;
+		for (int i = 0; i < circleSegments; i++) {
+			float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(circleSegments);
+			circle.insert(circle.end(), { 0.5f * std::cos(angle), 0.5f * std::sin(angle), 1.0f, 1.0f, 1.0f, 1.0f });
+			circleIndices.push_back(0);
+			circleIndices.push_back(static_cast<GLushort>(1 + i));
+			circleIndices.push_back(static_cast<GLushort>(1 + (i + 1) % circleSegments));
+		}
+		createBatch(batches[static_cast<int>(ShapeType::Circle)], circle, circleIndices);
+	}
+
+	void InstancedRenderer::createBatch(ShapeBatch& batch, const std::vector<float>& vertices, const std::vector<GLushort>& indices) {
+		glGenVertexArrays(1, &batch.vao);
+		glGenBuffers(1, &batch.vertexBuffer);
+		glState().bindVertexArray(batch.vao);
+		// static mesh, per vertex
+		const std::size_t vertexCount = vertices.size() / 6;
+		const SourceAttribute sources[2] = { { vertices.data(), 6 }, { vertices.data() + 2, 6 } };
+		batch.vertexData.resize(vertexCount * meshFormat.stride());
+		meshFormat.packVertices(sources, vertexCount, batch.vertexData.data());
+		batch.indexData = indices;
+		uploadMesh(batch, batch.vertexData.data(), vertexCount, indices.data(), indices.size());
+		glState().bindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer);
+		meshFormat.apply();
+		meshFormat.enable();
+		// instance data, advances once per instance. the pointers are set again
+		// for every draw since the data moves through the stream buffer
+		instanceFormat.enable();
+		glVertexAttribDivisor(INSTANCE_ATTRIBUTE, 1);
+		glVertexAttribDivisor(INSTANCE_COLOUR_ATTRIBUTE, 1);
+	}
+
+	void InstancedRenderer::uploadMesh(ShapeBatch& batch, const void* vertices, std::size_t vertexCount, const GLushort* indices, std::size_t indexCount) {
+		glState().bindVertexArray(batch.vao);
+		glState().bindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexCount * meshFormat.stride()), vertices, GL_STATIC_DRAW);
+		if (indexCount > 0) {
+			// the element buffer binding is part of the vao
+			if (batch.indexBuffer == 0) {
+				glGenBuffers(1, &batch.indexBuffer);
+			}
+			glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.indexBuffer);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indexCount * sizeof(GLushort)), indices, GL_STATIC_DRAW);
+			batch.elementCount = static_cast<GLsizei>(indexCount);
+		}
+		else {
+			if (batch.indexBuffer != 0) {
+				glDeleteBuffers(1, &batch.indexBuffer);
+				glState().deleted(GlObject::Buffer, batch.indexBuffer);
+				batch.indexBuffer = 0;
+			}
+			batch.elementCount = static_cast<GLsizei>(vertexCount);
+		}
+	}
+
+	void InstancedRenderer::setMesh(ShapeType shape, const void* vertices, std::size_t vertexCount, const GLushort* indices, std::size_t indexCount) {
+		ShapeBatch& batch = batches[static_cast<int>(shape)];
+		// kept for addMeshSections, a loaded scene is written back as it was
+		const unsigned char* vertexBytes = static_cast<const unsigned char*>(vertices);
+		batch.vertexData.assign(vertexBytes, vertexBytes + vertexCount * meshFormat.stride());
+		batch.indexData.assign(indices, indices + indexCount);
+		uploadMesh(batch, batch.vertexData.data(), vertexCount, batch.indexData.data(), indexCount);
+	}
+
+	bool InstancedRenderer::loadMeshes(const AssetArchive& archive) {
+		// every mesh is checked before the first one is replaced, a bad archive
+		// leaves all meshes as they were
+		const ArchiveSection* vertices[static_cast<int>(ShapeType::Count)] = {};
+		ArchiveArray<GLushort> indices[static_cast<int>(ShapeType::Count)];
+		for (int shape = 0; shape < static_cast<int>(ShapeType::Count); shape++) {
+			vertices[shape] = archive.find(meshSectionName(shape, "vertices").c_str());
+			if (vertices[shape] == nullptr) {
+				continue;
+			}
+			if (vertices[shape]->elementSize != meshFormat.stride() || vertices[shape]->count == 0) {
+				return false;
+			}
+			const ArchiveSection* indexSection = archive.find(meshSectionName(shape, "indices").c_str());
+			if (indexSection == nullptr) {
+				continue;
+			}
+			if (indexSection->elementSize != sizeof(GLushort)) {
+				return false;
+			}
+			indices[shape] = archive.array<GLushort>(meshSectionName(shape, "indices").c_str());
+			for (GLushort index : indices[shape]) {
+				if (index >= vertices[shape]->count) {
+					return false;
+				}
+			}
+		}
+		for (int shape = 0; shape < static_cast<int>(ShapeType::Count); shape++) {
+			if (vertices[shape] != nullptr) {
+				setMesh(static_cast<ShapeType>(shape), archive.data(*vertices[shape]), static_cast<std::size_t>(vertices[shape]->count), indices[shape].data, indices[shape].count);
+			}
+		}
+		return true;
+	}
+
+	bool InstancedRenderer::addMeshSections(ArchiveWriter& writer) const {
+		for (int shape = 0; shape < static_cast<int>(ShapeType::Count); shape++) {
+			const ShapeBatch& batch = batches[shape];
+			if (batch.vertexData.empty()) {
+				continue;
+			}
+			if (!writer.add(meshSectionName(shape, "vertices"), batch.vertexData.data(), meshFormat.stride(), batch.vertexData.size() / meshFormat.stride())) {
+				return false;
+			}
+			if (!batch.indexData.empty() && !writer.add(meshSectionName(shape, "indices"), batch.indexData.data(), batch.indexData.size())) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	InstanceData* InstancedRenderer::writeInstances(ShapeType shape, std::size_t count) {
+		if (count == 0) {
+			return nullptr;
+		}
+		GLintptr offset = 0;
+		InstanceData* instances = instanceStream.allocateArray<InstanceData>(count, offset);
+		if (instances != nullptr) {
+			ranges.push_back(DrawRange{ shape, offset, count });
+		}
+		return instances;
+	}
+
+	void InstancedRenderer::beginFrame() {
+		instanceStream.beginFrame();
+	}
+
+	void InstancedRenderer::bindInstances(const DrawCommand& command) {
+		const InstancedRenderer* renderer = static_cast<const InstancedRenderer*>(command.userData);
+		const GLintptr offset = static_cast<GLintptr>(command.userValue);
+		glState().bindBuffer(GL_ARRAY_BUFFER, renderer->instanceStream.buffer());
+		renderer->instanceFormat.apply(offset);
+		glState().setEnabled(GL_BLEND, false);
+	}
+
+	void InstancedRenderer::record(CommandBucket& bucket, std::uint32_t layer, GLuint program, const UniformArena& materials, const UniformSlot& material) {
+		GLuint programs[static_cast<int>(ShapeType::Count)];
+		for (GLuint& shapeProgram : programs) {
+			shapeProgram = program;
+		}
+		record(bucket, layer, programs, materials, material);
+	}
+
+	void InstancedRenderer::record(CommandBucket& bucket, std::uint32_t layer, const GLuint* programs, const UniformArena& materials, const UniformSlot& material) {
+		stats = InstanceStats();
+		for (int shape = 0; shape < static_cast<int>(ShapeType::Count); shape++) {
+			std::vector<InstanceData>& instances = batches[shape].instances;
+			if (instances.empty()) {
+				continue;
+			}
+			InstanceData* target = writeInstances(static_cast<ShapeType>(shape), instances.size());
+			if (target != nullptr) {
+				std::memcpy(target, instances.data(), instances.size() * sizeof(InstanceData));
+			}
+			instances.clear();
+		}
+		// the draws run later in the frame, the data has to be flushed by then
+		instanceStream.unmap();
+		for (const DrawRange& range : ranges) {
+			const ShapeBatch& batch = batches[static_cast<int>(range.shape)];
+			const GLuint program = programs[static_cast<int>(range.shape)];
+			DrawCommand& command = bucket.add(makeSortKey(layer, program, material.offset / 256, batch.vao));
+			command.program = program;
+			command.vao = batch.vao;
+			command.materialBuffer = materials.buffer();
+			command.materialOffset = material.offset;
+			command.materialSize = material.size;
+			command.indexType = batch.indexBuffer != 0 ? GL_UNSIGNED_SHORT : 0;
+			command.count = batch.elementCount;
+			command.instanceCount = static_cast<GLsizei>(range.count);
+			command.prepare = &InstancedRenderer::bindInstances;
+			command.userData = this;
+			command.userValue = static_cast<std::uint64_t>(range.offset);
+			stats.drawCalls++;
+			stats.instances += range.count;
+		}
+		ranges.clear();
+	}
+
+}
@@ -0,0 +1,125 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// instanced renderer, one draw call per shape type for any number of bodies -->
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <glad/glad.h>
+#include "core/asset_archive.h"
+#include "physics/vec2.h"
+#include "render/command_bucket.h"
+#include "render/stream_buffer.h"
+#include "render/uniform_buffer.h"
+#include "render/vertex_format.h"
+
+namespace psix {
+
+	enum class ShapeType {
+		Triangle,
+		Quad,
+		Circle,
+		Count
+	};
+
+	// per-instance attributes, matches locations 2 and 3 of vrtxone.vert.
+	// 16 bytes, the colour is rgba8 (see packColour)
+
+	struct InstanceData {
+		float offsetX;
+		float offsetY;
+		float scale;
+		std::uint32_t colour;
+	};
+
+	struct InstanceStats {
+		std::size_t drawCalls = 0;
+		std::size_t instances = 0;
+	};
+
+	// every shape has a static unit mesh (half float position + rgba8 colour,
+	// 8 bytes a vertex, locations 0 and 1),
+	// the instance attributes (divisor 1) are read from a stream buffer ring.
+	// add() collects instances on the cpu and copies them once per shape in
+	// record(), writeInstances() hands out stream memory that is filled in place
+	// (e.g. straight from the body store) and drawn with its own draw call
+	//
+	// per frame: beginFrame() -> add() / writeInstances() -> record() ->
+	// submit of the bucket -> endFrame()
+
+	class InstancedRenderer {
+	public:
+		static constexpr GLuint INSTANCE_ATTRIBUTE = 2;
+		static constexpr GLuint INSTANCE_COLOUR_ATTRIBUTE = 3;
+
+		InstancedRenderer() = default;
+		~InstancedRenderer() { destroy(); }
+		InstancedRenderer(const InstancedRenderer&) = delete;
+		InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+		// needs a current gl context, streamBytes is the instance budget of a frame
+		void init(int circleSegments = 24, std::size_t streamBytes = 4 << 20);
+		// frees the gl objects, has to run while the context is still alive
+		void destroy();
+		void add(ShapeType shape, const InstanceData& instance) { batches[static_cast<int>(shape)].instances.push_back(instance); }
+		void add(ShapeType shape, const Vec2& position, float scale, float red, float green, float blue) {
+			add(shape, InstanceData{ position.x, position.y, scale, packColour(red, green, blue) });
+		}
+		// replaces the mesh of a shape, vertices are meshVertexSize() bytes in the
+		// mesh format and go to the buffer as they are, a cpu copy is kept for
+		// addMeshSections. no indices draws a list
+		void setMesh(ShapeType shape, const void* vertices, std::size_t vertexCount, const GLushort* indices, std::size_t indexCount);
+		std::size_t meshVertexSize() const { return meshFormat.stride(); }
+		// takes the meshes found in the archive ("meshes/circle/vertices" and
+		// "meshes/circle/indices", ...) from the mapping. false when a
+		// mesh section does not match the mesh format, indices are not 16 bit or
+		// point past the vertices, then no mesh is replaced
+		bool loadMeshes(const AssetArchive& archive);
+		// the current meshes, built-in or set later, from their cpu copies
+		bool addMeshSections(ArchiveWriter& writer) const;
+		// count instances written directly into the stream buffer, null when the
+		// budget of the frame is used up
+		InstanceData* writeInstances(ShapeType shape, std::size_t count);
+		void beginFrame();
+		// uploads everything added since the last record and records one
+		// instanced draw per shape range into the bucket
+		void record(CommandBucket& bucket, std::uint32_t layer, GLuint program, const UniformArena& materials, const UniformSlot& material);
+		// programs holds one program per ShapeType, e.g. shader variants with and
+		// without the mesh colour
+		void record(CommandBucket& bucket, std::uint32_t layer, const GLuint* programs, const UniformArena& materials, const UniformSlot& material);
+		// after the bucket holding the draws has been submitted
+		void endFrame() { instanceStream.endFrame(); }
+		const InstanceStats& lastRecordStats() const { return stats; }
+		const StreamBuffer& stream() const { return instanceStream; }
+	private:
+		struct ShapeBatch {
+			GLuint vao = 0;
+			GLuint vertexBuffer = 0;
+			GLuint indexBuffer = 0;		// 0 draws the vertices as a triangle list
+			GLsizei elementCount = 0;
+			std::vector<InstanceData> instances;
+			// cpu copy of the current mesh for addMeshSections
+			std::vector<unsigned char> vertexData;
+			std::vector<GLushort> indexData;
+		};
+		// instances of one shape in the stream buffer
+		struct DrawRange {
+			ShapeType shape;
+			GLintptr offset;
+			std::size_t count;
+		};
+		// vertices are x, y, red, green, blue, alpha in full precision
+		void createBatch(ShapeBatch& batch, const std::vector<float>& vertices, const std::vector<GLushort>& indices);
+		void uploadMesh(ShapeBatch& batch, const void* vertices, std::size_t vertexCount, const GLushort* indices, std::size_t indexCount);
+		// points the instance attributes of the vao at the range of the command
+		static void bindInstances(const DrawCommand& command);
+
+		ShapeBatch batches[static_cast<int>(ShapeType::Count)];
+		VertexFormat meshFormat;
+		VertexFormat instanceFormat;
+		StreamBuffer instanceStream;
+		std::vector<DrawRange> ranges;
+		InstanceStats stats;
+	};
+
+}
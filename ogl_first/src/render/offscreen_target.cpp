@@ -0,0 +1,83 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// framebuffer object to render into without a window, with pixel readback -->
+
+#include "render/offscreen_target.h"
+#include <cstring>
+#include <fstream>
+#include "render/gl_state.h"
+
+namespace psix {
+
+	bool OffscreenTarget::init(GLsizei width, GLsizei height) {
+		destroy();
+		targetWidth = width;
+		targetHeight = height;
+		glGenRenderbuffers(1, &colourBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, colourBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glGenFramebuffers(1, &framebufferObject);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebufferObject);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colourBuffer);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			destroy();
+			return false;
+		}
+		return true;
+	}
+
+	void OffscreenTarget::destroy() {
+		if (framebufferObject != 0) {
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glDeleteFramebuffers(1, &framebufferObject);
+			framebufferObject = 0;
+		}
+		if (colourBuffer != 0) {
+			glDeleteRenderbuffers(1, &colourBuffer);
+			colourBuffer = 0;
+		}
+	}
+
+	void OffscreenTarget::bind() const {
+		glBindFramebuffer(GL_FRAMEBUFFER, framebufferObject);
+		glState().viewport(0, 0, targetWidth, targetHeight);
+	}
+
+	void OffscreenTarget::readPixels(std::vector<unsigned char>& rgba) const {
+		const std::size_t rowBytes = static_cast<std::size_t>(targetWidth) * 4;
+		rgba.resize(rowBytes * targetHeight);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferObject);
+		// a bound pack buffer would turn the pointer into an offset
+		glState().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, targetWidth, targetHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+		// gl rows start at the bottom
+		std::vector<unsigned char> row(rowBytes);
+		for (GLsizei y = 0; y < targetHeight / 2; y++) {
+			unsigned char* top = rgba.data() + y * rowBytes;
+			unsigned char* bottom = rgba.data() + (targetHeight - 1 - y) * rowBytes;
+			std::memcpy(row.data(), top, rowBytes);
+			std::memcpy(top, bottom, rowBytes);
+			std::memcpy(bottom, row.data(), rowBytes);
+		}
+	}
+
+	bool OffscreenTarget::writePpm(const char* path) const {
+		std::vector<unsigned char> rgba;
+		readPixels(rgba);
+		std::ofstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			return false;
+		}
+		file << "P6\n" << targetWidth << " " << targetHeight << "\n255\n";
+		std::vector<unsigned char> rgb(rgba.size() / 4 * 3);
+		for (std::size_t i = 0, j = 0; i < rgba.size(); i += 4, j += 3) {
+			rgb[j] = rgba[i];
+			rgb[j + 1] = rgba[i + 1];
+			rgb[j + 2] = rgba[i + 2];
+		}
+		file.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+		return static_cast<bool>(file);
+	}
+
+}
@@ -0,0 +1,41 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// framebuffer object to render into without a window, with pixel readback -->
+
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+
+namespace psix {
+
+	// rgba8 colour renderbuffer in a framebuffer object. a headless context has
+	// no default framebuffer, everything is drawn here and read back for
+	// image comparisons
+
+	class OffscreenTarget {
+	public:
+		OffscreenTarget() = default;
+		~OffscreenTarget() { destroy(); }
+		OffscreenTarget(const OffscreenTarget&) = delete;
+		OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+		// needs a current gl context, false if the framebuffer is incomplete
+		bool init(GLsizei width, GLsizei height);
+		void destroy();
+		// binds the framebuffer for drawing and sets the viewport to its size
+		void bind() const;
+		// rgba rows from top to bottom, waits for the gpu to finish the frame
+		void readPixels(std::vector<unsigned char>& rgba) const;
+		// binary ppm (P6), the alpha channel is dropped
+		bool writePpm(const char* path) const;
+		GLuint framebuffer() const { return framebufferObject; }
+		GLsizei width() const { return targetWidth; }
+		GLsizei height() const { return targetHeight; }
+	private:
+		GLuint framebufferObject = 0;
+		GLuint colourBuffer = 0;
+		GLsizei targetWidth = 0;
+		GLsizei targetHeight = 0;
+	};
+
+}
@@ -0,0 +1,178 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// linked programs saved as driver binaries on disk, skips the compile on later starts -->
+
+#include "render/program_cache.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+#include "core/hash.h"
+#include "render/shader_program.h"
+
+// GL_ARB_get_program_binary, not in the 3.3 core header
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace psix {
+
+	namespace {
+
+		using GetProgramBinaryFunction = void (APIENTRYP)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+		using ProgramBinaryFunction = void (APIENTRYP)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+		GetProgramBinaryFunction getProgramBinary = nullptr;
+		ProgramBinaryFunction programBinary = nullptr;
+
+		constexpr std::uint32_t FILE_MAGIC = 0x42585350;	// "PSXB"
+		constexpr std::uint32_t FILE_VERSION = 1;
+
+		struct FileHeader {
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint64_t key;
+			std::uint32_t format;
+			std::uint32_t size;
+		};
+
+		std::uint64_t hashGlString(GLenum name, std::uint64_t seed) {
+			const char* text = reinterpret_cast<const char*>(glGetString(name));
+			return hashString(text != nullptr ? text : "", seed);
+		}
+
+	}
+
+	bool ProgramCache::init(const std::string& cacheDirectory, GLADloadproc loader) {
+		directory = cacheDirectory;
+		available = false;
+		GLint major = 0;
+		GLint minor = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		bool core = major > 4 || (major == 4 && minor >= 1);
+		if (loader == nullptr || (!core && !hasGlExtension("GL_ARB_get_program_binary"))) {
+			return false;
+		}
+		getProgramBinary = reinterpret_cast<GetProgramBinaryFunction>(loader("glGetProgramBinary"));
+		programBinary = reinterpret_cast<ProgramBinaryFunction>(loader("glProgramBinary"));
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		if (getProgramBinary == nullptr || programBinary == nullptr || formats == 0) {
+			return false;
+		}
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error) {
+			return false;
+		}
+		std::uint64_t hash = hashGlString(GL_VENDOR, FNV_OFFSET);
+		hash = hashGlString(GL_RENDERER, hash);
+		hash = hashGlString(GL_VERSION, hash);
+		driverHash = hashGlString(GL_SHADING_LANGUAGE_VERSION, hash);
+		available = true;
+		return true;
+	}
+
+	std::uint64_t ProgramCache::key(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) const {
+		// the separators keep "ab" + "c" and "a" + "bc" apart
+		std::uint64_t hash = hashString(vertexSource, driverHash);
+		hash = hashBytes("\0", 1, hash);
+		hash = hashString(fragmentSource, hash);
+		hash = hashBytes("\0", 1, hash);
+		return hashString(defines, hash);
+	}
+
+	std::string ProgramCache::pathOf(std::uint64_t key) const {
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+		return (std::filesystem::path(directory) / name).string();
+	}
+
+	GLuint ProgramCache::load(std::uint64_t key) {
+		if (!available) {
+			counters.misses++;
+			return 0;
+		}
+		const std::string path = pathOf(key);
+		std::ifstream file(path, std::ios::binary);
+		FileHeader header = {};
+		if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+			counters.misses++;
+			return 0;
+		}
+		std::vector<char> binary;
+		bool valid = header.magic == FILE_MAGIC && header.version == FILE_VERSION && header.key == key && header.size > 0;
+		if (valid) {
+			binary.resize(header.size);
+			valid = static_cast<bool>(file.read(binary.data(), static_cast<std::streamsize>(binary.size())));
+		}
+		file.close();
+		GLuint program = 0;
+		if (valid) {
+			program = glCreateProgram();
+			programBinary(program, static_cast<GLenum>(header.format), binary.data(), static_cast<GLsizei>(binary.size()));
+			GLint linked = 0;
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+			if (linked == 0) {
+				glDeleteProgram(program);
+				program = 0;
+			}
+		}
+		if (program == 0) {
+			// the next store() writes a fresh one
+			counters.rejected++;
+			std::error_code error;
+			std::filesystem::remove(path, error);
+			return 0;
+		}
+		counters.hits++;
+		return program;
+	}
+
+	bool ProgramCache::store(std::uint64_t key, GLuint program) {
+		if (!available || program == 0) {
+			return false;
+		}
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
+			return false;
+		}
+		std::vector<char> binary(static_cast<std::size_t>(length));
+		GLenum format = 0;
+		GLsizei written = 0;
+		getProgramBinary(program, length, &written, &format, binary.data());
+		if (written <= 0) {
+			return false;
+		}
+		FileHeader header = { FILE_MAGIC, FILE_VERSION, key, static_cast<std::uint32_t>(format), static_cast<std::uint32_t>(written) };
+		// written next to the final name and renamed, a crash never leaves half a binary
+		const std::string path = pathOf(key);
+		const std::string temporary = path + ".tmp";
+		{
+			std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				return false;
+			}
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(binary.data(), written);
+			if (!file) {
+				return false;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(temporary, path, error);
+		if (error) {
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+		counters.stored++;
+		return true;
+	}
+
+}
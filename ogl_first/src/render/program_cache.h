@@ -0,0 +1,49 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// linked programs saved as driver binaries on disk, skips the compile on later starts -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <glad/glad.h>
+
+namespace psix {
+
+	struct ProgramCacheStats {
+		std::size_t hits = 0;
+		std::size_t misses = 0;
+		std::size_t rejected = 0;	// binaries the driver refused, they were compiled again
+		std::size_t stored = 0;
+	};
+
+	// one file per program named after its key. the key hashes the sources,
+	// the defines and the vendor, renderer and version strings, so a driver
+	// update or an edited shader never loads an old binary. a binary that
+	// fails to load is deleted and the caller compiles from source.
+	//
+	// glGetProgramBinary is gl 4.1 / GL_ARB_get_program_binary and not in the
+	// 3.3 glad header, init() loads the functions itself
+
+	class ProgramCache {
+	public:
+		// false when the driver hands out no binaries, every load() then misses
+		bool init(const std::string& directory, GLADloadproc loader);
+		bool enabled() const { return available; }
+		std::uint64_t key(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) const;
+		// a linked program or 0 when there is no usable binary
+		GLuint load(std::uint64_t key);
+		// saves the binary of a linked program
+		bool store(std::uint64_t key, GLuint program);
+		const ProgramCacheStats& stats() const { return counters; }
+	private:
+		std::string pathOf(std::uint64_t key) const;
+
+		std::string directory;
+		std::uint64_t driverHash = 0;
+		bool available = false;
+		ProgramCacheStats counters;
+	};
+
+}
@@ -0,0 +1,257 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// shader programs loaded from files and rebuilt when the files change -->
+
+#include "render/shader_library.h"
+#include <algorithm>
+#include <filesystem>
+#include "core/hash.h"
+#include "render/uniform_buffer.h"
+
+namespace psix {
+
+	void ShaderLibrary::init(const std::string& shaderDirectory, ShaderFileReader reader) {
+		directory = shaderDirectory;
+		fileReader = reader;
+	}
+
+	void ShaderLibrary::destroy() {
+		entries.clear();
+		reloads.clear();
+	}
+
+	bool ShaderLibrary::readSources(Entry& entry, ShaderSource& vertex, ShaderSource& fragment) {
+		if (!preprocessShader(directory, entry.vertexFile, entry.defines, vertex, fileReader)) {
+			errorLog = vertex.error;
+			return false;
+		}
+		if (!preprocessShader(directory, entry.fragmentFile, entry.defines, fragment, fileReader)) {
+			errorLog = fragment.error;
+			return false;
+		}
+		// the defines are part of the text, equal text is an equal program
+		entry.sourceHash = hashString(fragment.text, hashString(vertex.text));
+		return true;
+	}
+
+	void ShaderLibrary::startCompile(Entry& entry, const ShaderSource& vertex, const ShaderSource& fragment, bool& cached) {
+		cached = false;
+		if (programCache != nullptr) {
+			entry.pendingKey = programCache->key(vertex.text, fragment.text, entry.defines.key());
+			GLuint program = programCache->load(entry.pendingKey);
+			if (program != 0) {
+				entry.program.adopt(program);
+				bindUniformBlocks(entry.program);
+				cached = true;
+				return;
+			}
+		}
+		entry.program.startCompile(vertex.text.c_str(), fragment.text.c_str());
+	}
+
+	void ShaderLibrary::linked(Entry& entry) {
+		bindUniformBlocks(entry.program);
+		if (programCache != nullptr) {
+			programCache->store(entry.pendingKey, entry.program.id());
+		}
+	}
+
+	static std::string reloadFiles(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines) {
+		std::string files = vertexFile + " " + fragmentFile;
+		if (!defines.empty()) {
+			files += " [" + defines.key() + "]";
+		}
+		return files;
+	}
+
+	void ShaderLibrary::watchFiles(std::size_t index, const ShaderSource& vertex, const ShaderSource& fragment) {
+		if (fileReader != readShaderFile) {
+			return;
+		}
+		Entry& entry = *entries[index];
+		for (const ShaderSource* source : { &vertex, &fragment }) {
+			for (const std::string& file : source->files) {
+				if (std::find(entry.watchedFiles.begin(), entry.watchedFiles.end(), file) != entry.watchedFiles.end()) {
+					continue;
+				}
+				entry.watchedFiles.push_back(file);
+				int id = watcher.watch((std::filesystem::path(directory) / file).string());
+				if (id >= 0) {
+					watchedBy.resize(static_cast<std::size_t>(id) + 1);
+					watchedBy[static_cast<std::size_t>(id)] = index;
+				}
+			}
+		}
+	}
+
+	ShaderProgram* ShaderLibrary::load(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines) {
+		std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+		entry->vertexFile = vertexFile;
+		entry->fragmentFile = fragmentFile;
+		entry->defines = defines;
+		ShaderSource vertex;
+		ShaderSource fragment;
+		if (!readSources(*entry, vertex, fragment)) {
+			return nullptr;
+		}
+		for (std::size_t index = 0; index < entries.size(); index++) {
+			Entry& existing = *entries[index];
+			if (existing.sourceHash != entry->sourceHash || existing.vertexFile != vertexFile || existing.fragmentFile != fragmentFile) {
+				continue;
+			}
+			// the define set is remembered so a rebuild can tell when it stops matching,
+			// and files it only includes under its own defines are watched as well
+			if (!usesDefines(existing, defines.key())) {
+				existing.sharedDefines.push_back(defines);
+				watchFiles(index, vertex, fragment);
+			}
+			deduplicated++;
+			return existing.splitFrom != nullptr ? existing.splitFrom : &existing.program;
+		}
+		bool cached = false;
+		startCompile(*entry, vertex, fragment, cached);
+		if (!cached) {
+			if (!entry->program.finishCompile()) {
+				errorLog = entry->program.infoLog();
+				return nullptr;
+			}
+			linked(*entry);
+		}
+		entries.push_back(std::move(entry));
+		watchFiles(entries.size() - 1, vertex, fragment);
+		return &entries.back()->program;
+	}
+
+	bool ShaderLibrary::usesDefines(const Entry& entry, const std::string& key) {
+		if (entry.defines.key() == key) {
+			return true;
+		}
+		for (const ShaderDefines& shared : entry.sharedDefines) {
+			if (shared.key() == key) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	ShaderProgram* ShaderLibrary::find(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines) {
+		const std::string key = defines.key();
+		for (std::unique_ptr<Entry>& entry : entries) {
+			if (entry->vertexFile != vertexFile || entry->fragmentFile != fragmentFile) {
+				continue;
+			}
+			if (usesDefines(*entry, key)) {
+				return entry->splitFrom != nullptr ? entry->splitFrom : &entry->program;
+			}
+		}
+		return nullptr;
+	}
+
+	void ShaderLibrary::splitVariants(std::size_t index) {
+		std::vector<ShaderDefines> shared;
+		shared.swap(entries[index]->sharedDefines);
+		const std::size_t firstSplit = entries.size();
+		for (const ShaderDefines& defines : shared) {
+			Entry& entry = *entries[index];
+			std::unique_ptr<Entry> variant = std::make_unique<Entry>();
+			variant->vertexFile = entry.vertexFile;
+			variant->fragmentFile = entry.fragmentFile;
+			variant->defines = defines;
+			ShaderSource vertex;
+			ShaderSource fragment;
+			if (!readSources(*variant, vertex, fragment)) {
+				// stays shared and is read again with the next change
+				entry.sharedDefines.push_back(defines);
+				ShaderReload reload;
+				reload.program = &entry.program;
+				reload.files = reloadFiles(entry.vertexFile, entry.fragmentFile, defines);
+				reload.log = errorLog;
+				reloads.push_back(reload);
+				continue;
+			}
+			if (variant->sourceHash == entry.sourceHash) {
+				entry.sharedDefines.push_back(defines);
+				continue;
+			}
+			// variants that still match each other split off together
+			Entry* sibling = nullptr;
+			for (std::size_t other = firstSplit; other < entries.size(); other++) {
+				if (entries[other]->sourceHash == variant->sourceHash) {
+					sibling = entries[other].get();
+				}
+			}
+			if (sibling != nullptr) {
+				sibling->sharedDefines.push_back(defines);
+				continue;
+			}
+			variant->splitFrom = &entry.program;
+			bool cached = false;
+			startCompile(*variant, vertex, fragment, cached);
+			if (cached) {
+				ShaderReload reload;
+				reload.program = &variant->program;
+				reload.previous = variant->splitFrom;
+				reload.files = reloadFiles(variant->vertexFile, variant->fragmentFile, variant->defines);
+				reload.linked = true;
+				reloads.push_back(reload);
+				variant->splitFrom = nullptr;
+			}
+			entries.push_back(std::move(variant));
+			watchFiles(entries.size() - 1, vertex, fragment);
+		}
+	}
+
+	const std::vector<ShaderReload>& ShaderLibrary::update() {
+		reloads.clear();
+		watcher.poll(changed);
+		for (int id : changed) {
+			entries[watchedBy[static_cast<std::size_t>(id)]]->dirty = true;
+		}
+		for (std::size_t index = 0; index < entries.size(); index++) {
+			Entry& entry = *entries[index];
+			ShaderProgram& program = entry.program;
+			ShaderReload reload;
+			reload.program = &program;
+			reload.files = reloadFiles(entry.vertexFile, entry.fragmentFile, entry.defines);
+			if (program.compiling() && program.compileReady()) {
+				reload.linked = program.finishCompile();
+				if (reload.linked) {
+					linked(entry);
+					// a split variant leaves the shared program once it has its own
+					reload.previous = entry.splitFrom;
+					entry.splitFrom = nullptr;
+				}
+				else {
+					reload.log = program.infoLog();
+				}
+				reloads.push_back(reload);
+			}
+			// a save during the compile starts another one once it is done
+			if (!entry.dirty || program.compiling()) {
+				continue;
+			}
+			entry.dirty = false;
+			ShaderSource vertex;
+			ShaderSource fragment;
+			if (!readSources(entry, vertex, fragment)) {
+				reload.linked = false;
+				reload.log = errorLog;
+				reloads.push_back(reload);
+				continue;
+			}
+			// an edit can add includes
+			watchFiles(index, vertex, fragment);
+			splitVariants(index);
+			bool cached = false;
+			startCompile(entry, vertex, fragment, cached);
+			if (cached) {
+				// an edit was undone, its binary is still around
+				reload.linked = true;
+				reload.log.clear();
+				reloads.push_back(reload);
+			}
+		}
+		return reloads;
+	}
+
+}
@@ -0,0 +1,110 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// shader programs loaded from files and rebuilt when the files change -->
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/file_watcher.h"
+#include "render/program_cache.h"
+#include "render/shader_preprocessor.h"
+#include "render/shader_program.h"
+
+namespace psix {
+
+	// outcome of a rebuild, log holds the info log when it failed. previous is
+	// set when a variant that shared a program got its own one, the callers of
+	// load() with its defines switch over (see find())
+	struct ShaderReload {
+		const ShaderProgram* program = nullptr;
+		const ShaderProgram* previous = nullptr;
+		std::string files;
+		bool linked = false;
+		std::string log;
+	};
+
+	// owns the programs, the pointers load() returns stay valid until destroy().
+	// sources go through preprocessShader(), a program is one variant of a file
+	// pair with a define set. variants whose preprocessed sources are equal
+	// share one program, so a define that changes nothing costs no compile.
+	// every define set of a shared program is kept and preprocessed again on a
+	// rebuild, the ones whose sources differ after an edit are split off into
+	// programs of their own.
+	//
+	// a saved shader or include file restarts the compile of every program using it, the
+	// compile runs on the driver threads (see enableParallelShaderCompile) and
+	// update() swaps the program in only after it linked. a failed rebuild
+	// keeps the old program running.
+	//
+	// every program gets the shared uniform block bindings (bindUniformBlocks)
+	// after each link. with a ProgramCache a program whose binary is cached is
+	// not compiled at all, and every compiled one is added to the cache
+
+	class ShaderLibrary {
+	public:
+		ShaderLibrary() = default;
+		~ShaderLibrary() { destroy(); }
+		ShaderLibrary(const ShaderLibrary&) = delete;
+		ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+		// file names given to load() are relative to the directory. files read
+		// through another reader than readShaderFile (the embedded pack) are not
+		// on disk and not watched
+		void init(const std::string& directory, ShaderFileReader reader = readShaderFile);
+		// optional, has to outlive the library
+		void setProgramCache(ProgramCache* cache) { programCache = cache; }
+		void destroy();
+		// reads, compiles and links right away, null when that fails and the
+		// reason is in error()
+		ShaderProgram* load(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines = ShaderDefines());
+		// the program a variant uses now without reading any file, null when it was never loaded
+		ShaderProgram* find(const std::string& vertexFile, const std::string& fragmentFile, const ShaderDefines& defines);
+		// once per frame, starts the rebuilds of changed programs and finishes
+		// the ones the driver is done with. the result lives until the next call
+		const std::vector<ShaderReload>& update();
+		const std::string& error() const { return errorLog; }
+		bool watchesWithNotifications() const { return watcher.usesNotifications(); }
+		std::size_t programCount() const { return entries.size(); }
+		// load() calls answered with an existing program
+		std::size_t sharedLoads() const { return deduplicated; }
+	private:
+		struct Entry {
+			std::string vertexFile;
+			std::string fragmentFile;
+			ShaderDefines defines;
+			// other define sets whose sources were equal, they use this program
+			std::vector<ShaderDefines> sharedDefines;
+			ShaderProgram program;
+			std::uint64_t sourceHash = 0;	// of the preprocessed sources, for sharing
+			std::uint64_t pendingKey = 0;	// cache key of the sources being compiled
+			std::vector<std::string> watchedFiles;
+			bool dirty = false;		// a file changed since the compile started
+			ShaderProgram* splitFrom = nullptr;	// used by these defines until the first link
+		};
+
+		// preprocesses both stages, false leaves the reason in errorLog
+		bool readSources(Entry& entry, ShaderSource& vertex, ShaderSource& fragment);
+		// starts the compile, a cached binary is adopted right away instead and sets cached
+		void startCompile(Entry& entry, const ShaderSource& vertex, const ShaderSource& fragment, bool& cached);
+		void linked(Entry& entry);
+		// whether the entry is the program of the define set with that key
+		static bool usesDefines(const Entry& entry, const std::string& key);
+		// preprocesses the shared define sets of a rebuilt entry again and splits off the changed ones
+		void splitVariants(std::size_t index);
+		// watches the files of the sources the entry does not watch yet
+		void watchFiles(std::size_t index, const ShaderSource& vertex, const ShaderSource& fragment);
+
+		std::string directory;
+		ShaderFileReader fileReader = readShaderFile;
+		ProgramCache* programCache = nullptr;
+		FileWatcher watcher;
+		std::vector<std::unique_ptr<Entry>> entries;
+		std::vector<std::size_t> watchedBy;		// entry of every watch id
+		std::vector<int> changed;
+		std::vector<ShaderReload> reloads;
+		std::size_t deduplicated = 0;
+		std::string errorLog;
+	};
+
+}
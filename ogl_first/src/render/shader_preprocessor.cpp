@@ -0,0 +1,198 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// glsl preprocessing: #include resolution and injected #define sets for variants -->
+
+#include "render/shader_preprocessor.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "core/asset_pack.h"
+#include "core/hash.h"
+
+namespace psix {
+
+	ShaderDefines& ShaderDefines::add(const std::string& name, const std::string& value) {
+		auto position = std::lower_bound(defines.begin(), defines.end(), name,
+			[](const std::pair<std::string, std::string>& define, const std::string& key) { return define.first < key; });
+		if (position != defines.end() && position->first == name) {
+			position->second = value;
+		}
+		else {
+			defines.insert(position, std::make_pair(name, value));
+		}
+		return *this;
+	}
+
+	std::string ShaderDefines::key() const {
+		std::string text;
+		for (const std::pair<std::string, std::string>& define : defines) {
+			text += define.first + "=" + define.second + ";";
+		}
+		return text;
+	}
+
+	std::uint64_t ShaderDefines::variantKey() const {
+		return hashString(key());
+	}
+
+	std::string ShaderDefines::text() const {
+		std::string text;
+		for (const std::pair<std::string, std::string>& define : defines) {
+			text += "#define " + define.first + " " + define.second + "\n";
+		}
+		return text;
+	}
+
+	static bool identifierCharacter(char c) {
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+	}
+
+	static bool containsIdentifier(const std::string& source, const std::string& name) {
+		for (std::size_t at = source.find(name); at != std::string::npos; at = source.find(name, at + 1)) {
+			const std::size_t after = at + name.size();
+			if ((at == 0 || !identifierCharacter(source[at - 1])) && (after == source.size() || !identifierCharacter(source[after]))) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::string ShaderDefines::text(const std::string& source) const {
+		std::string text;
+		for (const std::pair<std::string, std::string>& define : defines) {
+			if (containsIdentifier(source, define.first)) {
+				text += "#define " + define.first + " " + define.second + "\n";
+			}
+		}
+		return text;
+	}
+
+	bool readShaderFile(const std::string& directory, const std::string& file, std::string& text) {
+		std::ifstream stream(std::filesystem::path(directory) / file, std::ios::binary);
+		if (!stream.is_open()) {
+			return false;
+		}
+		std::ostringstream contents;
+		contents << stream.rdbuf();
+		text = contents.str();
+		return true;
+	}
+
+	bool readEmbeddedShaderFile(const std::string& directory, const std::string& file, std::string& text) {
+		AssetView asset = embeddedAsset(directory.empty() ? file : directory + "/" + file);
+		if (!asset) {
+			return false;
+		}
+		text.assign(asset.text(), asset.size);
+		return true;
+	}
+
+	namespace {
+
+		// true when the line is the directive, end is the position after its name
+		bool startsWithDirective(const std::string& line, const char* directive, std::size_t& end) {
+			std::size_t start = line.find_first_not_of(" \t");
+			if (start == std::string::npos || line[start] != '#') {
+				return false;
+			}
+			start = line.find_first_not_of(" \t", start + 1);
+			const std::size_t length = std::char_traits<char>::length(directive);
+			if (start == std::string::npos || line.compare(start, length, directive) != 0) {
+				return false;
+			}
+			end = start + length;
+			return true;
+		}
+
+		struct Preprocessor {
+			std::string directory;
+			ShaderFileReader reader;
+			ShaderSource* out;
+
+			// copies the lines of files[index] starting at firstLine, includes are expanded
+			bool expand(const std::string& text, int index, int firstLine) {
+				// a copy, includes grow the list
+				const std::string file = out->files[static_cast<std::size_t>(index)];
+				std::istringstream lines(text);
+				std::string line;
+				int number = firstLine - 1;
+				while (std::getline(lines, line)) {
+					number++;
+					if (!line.empty() && line.back() == '\r') {
+						line.pop_back();
+					}
+					std::size_t end = 0;
+					if (!startsWithDirective(line, "include", end)) {
+						out->text += line + "\n";
+						continue;
+					}
+					std::size_t open = line.find('"', end);
+					std::size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+					if (close == std::string::npos) {
+						out->error = "ERROR::SHADER::BAD_INCLUDE " + file + ":" + std::to_string(number);
+						return false;
+					}
+					std::string name = line.substr(open + 1, close - open - 1);
+					if (std::find(out->files.begin(), out->files.end(), name) == out->files.end()) {
+						if (!include(name, file, number)) {
+							return false;
+						}
+					}
+					// back in this file on the line after the include
+					out->text += "#line " + std::to_string(number + 1) + " " + std::to_string(index) + "\n";
+				}
+				return true;
+			}
+
+			bool include(const std::string& name, const std::string& from, int fromLine) {
+				std::string text;
+				if (!reader(directory, name, text)) {
+					out->error = "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ " + name + " (included from " + from + ":" + std::to_string(fromLine) + ")";
+					return false;
+				}
+				const int index = static_cast<int>(out->files.size());
+				out->files.push_back(name);
+				out->text += "#line 1 " + std::to_string(index) + "\n";
+				return expand(text, index, 1);
+			}
+		};
+
+	}
+
+	bool preprocessShader(const std::string& directory, const std::string& file, const ShaderDefines& defines, ShaderSource& out,
+		ShaderFileReader reader) {
+		out = ShaderSource();
+		std::string text;
+		if (!reader(directory, file, text)) {
+			out.error = "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ " + file;
+			return false;
+		}
+		out.files.push_back(file);
+		// #version has to stay the first line, the defines follow it
+		std::string firstLine = text.substr(0, text.find('\n'));
+		std::size_t end = 0;
+		int bodyLine = 1;
+		if (startsWithDirective(firstLine, "version", end)) {
+			text.erase(0, firstLine.size() + 1);
+			if (!firstLine.empty() && firstLine.back() == '\r') {
+				firstLine.pop_back();
+			}
+			out.text = firstLine + "\n";
+			bodyLine = 2;
+		}
+		const std::size_t definesAt = out.text.size();
+		out.text += "#line " + std::to_string(bodyLine) + " 0\n";
+		Preprocessor preprocessor;
+		preprocessor.directory = directory;
+		preprocessor.reader = reader;
+		preprocessor.out = &out;
+		if (!preprocessor.expand(text, 0, bodyLine)) {
+			return false;
+		}
+		// known only once the includes are in
+		out.text.insert(definesAt, defines.text(out.text.substr(definesAt)));
+		return true;
+	}
+
+}
@@ -0,0 +1,61 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// glsl preprocessing: #include resolution and injected #define sets for variants -->
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace psix {
+
+	// the defines of one variant, kept sorted by name so the same set gives
+	// the same key in any order. adding a name again replaces its value
+
+	class ShaderDefines {
+	public:
+		ShaderDefines& add(const std::string& name, const std::string& value = "1");
+		bool empty() const { return defines.empty(); }
+		// "NAME=value;..." in name order
+		std::string key() const;
+		std::uint64_t variantKey() const;
+		// the #define lines injected after #version
+		std::string text() const;
+		// the lines of the defines whose name appears in source as an identifier
+		std::string text(const std::string& source) const;
+	private:
+		std::vector<std::pair<std::string, std::string>> defines;
+	};
+
+	// reads directory/file into text, false when there is no such file
+	using ShaderFileReader = bool (*)(const std::string& directory, const std::string& file, std::string& text);
+
+	// from disk
+	bool readShaderFile(const std::string& directory, const std::string& file, std::string& text);
+	// from the asset pack of the executable (core/asset_pack.h), the name is
+	// directory/file, no file is opened
+	bool readEmbeddedShaderFile(const std::string& directory, const std::string& file, std::string& text);
+
+	struct ShaderSource {
+		std::string text;
+		// every file the text was built from, the index is the glsl source
+		// string number in info logs ("1:12(3)" is line 12 of files[1])
+		std::vector<std::string> files;
+		std::string error;
+	};
+
+	// reads file from the directory through the reader and replaces every #include "name" with the
+	// contents of directory/name. a file is included once, later includes of
+	// it are dropped, which also breaks cycles. includes are resolved even
+	// inside #ifdef blocks. the defines the sources mention go right after the
+	// #version line, the others are left out so a define that changes nothing
+	// gives the same text. #line directives keep the line numbers of the info
+	// log pointing into the original files.
+	//
+	// false when a file can not be read, error says which
+	bool preprocessShader(const std::string& directory, const std::string& file, const ShaderDefines& defines, ShaderSource& out,
+		ShaderFileReader reader = readShaderFile);
+
+}
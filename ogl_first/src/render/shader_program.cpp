@@ -0,0 +1,300 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// linked shader program with reflected uniforms, attributes and uniform blocks -->
+
+#include "render/shader_program.h"
+
+// GL_KHR_parallel_shader_compile, not in the 3.3 core header
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace psix {
+
+	namespace {
+
+		// bytes a cached value of the type takes, samplers are cached as ints
+		std::uint32_t cachedSize(GLenum type) {
+			switch (type) {
+			case GL_FLOAT_VEC2: return 8;
+			case GL_FLOAT_VEC3: return 12;
+			case GL_FLOAT_VEC4: return 16;
+			case GL_FLOAT_MAT4: return 64;
+			default: return 4;
+			}
+		}
+
+		std::string readInfoLog(GLuint object, bool program) {
+			GLint length = 0;
+			if (program) {
+				glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+			}
+			else {
+				glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+			}
+			std::string text(length > 1 ? static_cast<std::size_t>(length) : 1, '\0');
+			if (program) {
+				glGetProgramInfoLog(object, static_cast<GLsizei>(text.size()), nullptr, &text[0]);
+			}
+			else {
+				glGetShaderInfoLog(object, static_cast<GLsizei>(text.size()), nullptr, &text[0]);
+			}
+			text.resize(std::strlen(text.c_str()));
+			return text;
+		}
+
+		bool parallelCompile = false;
+
+	}
+
+	bool hasGlExtension(const char* name) {
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++) {
+			const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+			if (extension != nullptr && std::strcmp(extension, name) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool enableParallelShaderCompile(GLADloadproc loader) {
+		using MaxThreadsFunction = void (APIENTRYP)(GLuint count);
+		parallelCompile = false;
+		if (loader == nullptr) {
+			return false;
+		}
+		// the khr and arb extensions share the enums, only the suffix differs
+		const char* function = nullptr;
+		if (hasGlExtension("GL_KHR_parallel_shader_compile")) {
+			function = "glMaxShaderCompilerThreadsKHR";
+		}
+		else if (hasGlExtension("GL_ARB_parallel_shader_compile")) {
+			function = "glMaxShaderCompilerThreadsARB";
+		}
+		if (function == nullptr) {
+			return false;
+		}
+		MaxThreadsFunction maxThreads = reinterpret_cast<MaxThreadsFunction>(loader(function));
+		if (maxThreads != nullptr) {
+			// as many threads as the driver wants
+			maxThreads(0xffffffffu);
+		}
+		parallelCompile = true;
+		return true;
+	}
+
+	bool parallelShaderCompile() {
+		return parallelCompile;
+	}
+
+	GLuint ShaderProgram::compile(GLenum stage, const char* source) {
+		GLuint shader = glCreateShader(stage);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+		return shader;
+	}
+
+	bool ShaderProgram::create(const char* vertexSource, const char* fragmentSource) {
+		destroy();
+		startCompile(vertexSource, fragmentSource);
+		return finishCompile();
+	}
+
+	void ShaderProgram::startCompile(const char* vertexSource, const char* fragmentSource) {
+		discardPending();
+		// no status is queried here, that would wait for the compile
+		pendingShaders[0] = compile(GL_VERTEX_SHADER, vertexSource);
+		pendingShaders[1] = compile(GL_FRAGMENT_SHADER, fragmentSource);
+		pendingProgram = glCreateProgram();
+		glAttachShader(pendingProgram, pendingShaders[0]);
+		glAttachShader(pendingProgram, pendingShaders[1]);
+		glLinkProgram(pendingProgram);
+	}
+
+	bool ShaderProgram::compileReady() const {
+		if (pendingProgram == 0 || !parallelCompile) {
+			return true;
+		}
+		GLint done = 0;
+		glGetProgramiv(pendingProgram, GL_COMPLETION_STATUS_KHR, &done);
+		return done != 0;
+	}
+
+	bool ShaderProgram::finishCompile() {
+		if (pendingProgram == 0) {
+			return false;
+		}
+		log.clear();
+		GLint success = 0;
+		glGetProgramiv(pendingProgram, GL_LINK_STATUS, &success);
+		if (!success) {
+			// a failed stage makes the link fail, its log says why
+			const char* stageNames[2] = { "VERTEX", "FRAGMENT" };
+			for (int i = 0; i < 2; i++) {
+				GLint compiled = 0;
+				glGetShaderiv(pendingShaders[i], GL_COMPILE_STATUS, &compiled);
+				if (!compiled) {
+					log += std::string("ERROR::SHADER::") + stageNames[i] + "::COMPILATION_FAILED\n" + readInfoLog(pendingShaders[i], false);
+				}
+			}
+			if (log.empty()) {
+				log = "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" + readInfoLog(pendingProgram, true);
+			}
+			discardPending();
+			return false;
+		}
+		GLuint program = pendingProgram;
+		pendingProgram = 0;
+		discardPending();
+		adopt(program);
+		return true;
+	}
+
+	void ShaderProgram::adopt(GLuint program) {
+		// the old program goes, the uniform cache belongs to it
+		destroy();
+		programObject = program;
+		linkRevision++;
+		reflect();
+	}
+
+	void ShaderProgram::discardPending() {
+		for (GLuint& shader : pendingShaders) {
+			if (shader != 0) {
+				glDeleteShader(shader);
+				shader = 0;
+			}
+		}
+		if (pendingProgram != 0) {
+			glDeleteProgram(pendingProgram);
+			pendingProgram = 0;
+		}
+	}
+
+	void ShaderProgram::destroy() {
+		discardPending();
+		if (programObject != 0) {
+			glDeleteProgram(programObject);
+			glState().deleted(GlObject::Program, programObject);
+			programObject = 0;
+		}
+		uniforms.clear();
+		attributes.clear();
+		uniformBlocks.clear();
+		cache.clear();
+		cacheValid.clear();
+	}
+
+	void ShaderProgram::reflect() {
+		GLint maxLength = 0;
+		GLint count = 0;
+		// uniforms, the ones inside blocks have no location and are not cached
+		glGetProgramiv(programObject, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(programObject, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		std::vector<char> name(static_cast<std::size_t>(maxLength > 0 ? maxLength : 1));
+		std::uint32_t cacheBytes = 0;
+		for (GLint i = 0; i < count; i++) {
+			UniformInfo info;
+			GLsizei length = 0;
+			glGetActiveUniform(programObject, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &info.size, &info.type, name.data());
+			info.name.assign(name.data(), static_cast<std::size_t>(length));
+			if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0) {
+				info.name.resize(info.name.size() - 3);
+			}
+			info.location = glGetUniformLocation(programObject, name.data());
+			info.cacheOffset = cacheBytes;
+			if (info.location >= 0) {
+				cacheBytes += cachedSize(info.type);
+			}
+			uniforms.push_back(info);
+		}
+		cache.assign(cacheBytes, 0);
+		cacheValid.assign(uniforms.size(), 0);
+		// vertex attributes
+		glGetProgramiv(programObject, GL_ACTIVE_ATTRIBUTES, &count);
+		glGetProgramiv(programObject, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+		name.assign(static_cast<std::size_t>(maxLength > 0 ? maxLength : 1), '\0');
+		for (GLint i = 0; i < count; i++) {
+			AttributeInfo info;
+			GLsizei length = 0;
+			glGetActiveAttrib(programObject, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &info.size, &info.type, name.data());
+			info.name.assign(name.data(), static_cast<std::size_t>(length));
+			info.location = glGetAttribLocation(programObject, name.data());
+			attributes.push_back(info);
+		}
+		// uniform blocks
+		glGetProgramiv(programObject, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+		glGetProgramiv(programObject, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+		name.assign(static_cast<std::size_t>(maxLength > 0 ? maxLength : 1), '\0');
+		for (GLint i = 0; i < count; i++) {
+			UniformBlockInfo info;
+			GLsizei length = 0;
+			info.index = static_cast<GLuint>(i);
+			glGetActiveUniformBlockName(programObject, info.index, static_cast<GLsizei>(name.size()), &length, name.data());
+			info.name.assign(name.data(), static_cast<std::size_t>(length));
+			glGetActiveUniformBlockiv(programObject, info.index, GL_UNIFORM_BLOCK_DATA_SIZE, &info.dataSize);
+			glGetActiveUniformBlockiv(programObject, info.index, GL_UNIFORM_BLOCK_BINDING, &info.binding);
+			uniformBlocks.push_back(info);
+		}
+	}
+
+	std::int32_t ShaderProgram::findUniform(const char* name, GLenum type) const {
+		for (std::size_t i = 0; i < uniforms.size(); i++) {
+			const UniformInfo& info = uniforms[i];
+			if (info.location < 0 || info.name != name) {
+				continue;
+			}
+			// samplers are set as ints
+			bool sampler = info.type == GL_SAMPLER_2D || info.type == GL_SAMPLER_3D || info.type == GL_SAMPLER_CUBE;
+			if (info.type == type || (sampler && type == GL_INT)) {
+				return static_cast<std::int32_t>(i);
+			}
+			return -1;
+		}
+		return -1;
+	}
+
+	void ShaderProgram::upload(const UniformInfo& info, const void* value) const {
+		const float* floats = static_cast<const float*>(value);
+		switch (info.type) {
+		case GL_FLOAT: glUniform1fv(info.location, 1, floats); break;
+		case GL_FLOAT_VEC2: glUniform2fv(info.location, 1, floats); break;
+		case GL_FLOAT_VEC3: glUniform3fv(info.location, 1, floats); break;
+		case GL_FLOAT_VEC4: glUniform4fv(info.location, 1, floats); break;
+		case GL_FLOAT_MAT4: glUniformMatrix4fv(info.location, 1, GL_FALSE, floats); break;
+		default: glUniform1iv(info.location, 1, static_cast<const GLint*>(value)); break;
+		}
+	}
+
+	GLint ShaderProgram::attributeLocation(const char* name) const {
+		for (const AttributeInfo& info : attributes) {
+			if (info.name == name) {
+				return info.location;
+			}
+		}
+		return -1;
+	}
+
+	GLuint ShaderProgram::uniformBlockIndex(const char* name) const {
+		for (const UniformBlockInfo& info : uniformBlocks) {
+			if (info.name == name) {
+				return info.index;
+			}
+		}
+		return GL_INVALID_INDEX;
+	}
+
+	bool ShaderProgram::bindUniformBlock(const char* name, GLuint binding) {
+		for (UniformBlockInfo& info : uniformBlocks) {
+			if (info.name == name) {
+				glUniformBlockBinding(programObject, info.index, binding);
+				info.binding = static_cast<GLint>(binding);
+				return true;
+			}
+		}
+		return false;
+	}
+
+}
@@ -0,0 +1,182 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// linked shader program with reflected uniforms, attributes and uniform blocks -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "physics/vec2.h"
+#include "render/gl_state.h"
+
+namespace psix {
+
+	struct Float3 {
+		float x, y, z;
+	};
+
+	struct Float4 {
+		float x, y, z, w;
+	};
+
+	// column major 4x4 matrix
+	struct Float4x4 {
+		float m[16];
+	};
+
+	// glsl type of the c++ types a uniform can be set from
+
+	template <typename T> struct UniformTraits;
+	template <> struct UniformTraits<int> { static constexpr GLenum type = GL_INT; };
+	template <> struct UniformTraits<float> { static constexpr GLenum type = GL_FLOAT; };
+	template <> struct UniformTraits<Vec2> { static constexpr GLenum type = GL_FLOAT_VEC2; };
+	template <> struct UniformTraits<Float3> { static constexpr GLenum type = GL_FLOAT_VEC3; };
+	template <> struct UniformTraits<Float4> { static constexpr GLenum type = GL_FLOAT_VEC4; };
+	template <> struct UniformTraits<Float4x4> { static constexpr GLenum type = GL_FLOAT_MAT4; };
+
+	// typed handle to a uniform, looked up once after linking. it carries the
+	// revision of the program it came from, a relink makes it stale
+
+	template <typename T>
+	struct Uniform {
+		std::int32_t slot = -1;
+		std::uint32_t revision = 0;
+		bool valid() const { return slot >= 0; }
+	};
+
+	struct UniformInfo {
+		std::string name;	// without the [0] of arrays
+		GLint location;		// -1 for members of uniform blocks
+		GLenum type;
+		GLint size;			// array length
+		std::uint32_t cacheOffset;	// into the value cache, in bytes
+	};
+
+	struct AttributeInfo {
+		std::string name;
+		GLint location;
+		GLenum type;
+		GLint size;
+	};
+
+	struct UniformBlockInfo {
+		std::string name;
+		GLuint index;
+		GLint dataSize;
+		GLint binding;
+	};
+
+	struct UniformStats {
+		std::size_t uploads = 0;
+		std::size_t skipped = 0;	// the value was already set
+		std::size_t stale = 0;		// handle from an earlier revision, ignored
+	};
+
+	// with GL_KHR_parallel_shader_compile the driver compiles and links on its
+	// own threads, compileReady() can be asked without blocking. needs the
+	// loader since glad only has the 3.3 core functions, false when the driver
+	// has no support (a compile then finishes on the first status query)
+	bool enableParallelShaderCompile(GLADloadproc loader);
+	bool parallelShaderCompile();
+	// true when the current context lists the extension
+	bool hasGlExtension(const char* name);
+
+	// everything the program exposes is enumerated once at link time. setting a
+	// uniform through a handle is an index into the reflected table, the last
+	// value is cached and an unchanged value is not uploaded again.
+	//
+	// a program can be rebuilt in place: startCompile() -> compileReady() ->
+	// finishCompile(). the running program stays in use until the new one has
+	// linked and is kept when it fails. uniform handles have to be looked up
+	// again after revision() changed, set() ignores stale ones
+
+	class ShaderProgram {
+	public:
+		ShaderProgram() = default;
+		~ShaderProgram() { destroy(); }
+		ShaderProgram(const ShaderProgram&) = delete;
+		ShaderProgram& operator=(const ShaderProgram&) = delete;
+		// compiles and links, false leaves the reason in infoLog()
+		bool create(const char* vertexSource, const char* fragmentSource);
+		// issues the compile and link without waiting, drops a compile in progress
+		void startCompile(const char* vertexSource, const char* fragmentSource);
+		bool compiling() const { return pendingProgram != 0; }
+		// true once finishCompile() will not block
+		bool compileReady() const;
+		// swaps in the new program if it linked, otherwise keeps the current
+		// one and leaves the reason in infoLog()
+		bool finishCompile();
+		// takes over a program that is already linked (from a program binary)
+		void adopt(GLuint program);
+		// frees the program, has to run while the context is still alive
+		void destroy();
+		void use() const { glState().useProgram(programObject); }
+		GLuint id() const { return programObject; }
+		const std::string& infoLog() const { return log; }
+		// counts the successful links
+		std::uint32_t revision() const { return linkRevision; }
+		// invalid handle when the uniform is not active or has another type
+		template <typename T>
+		Uniform<T> uniform(const char* name) const {
+			Uniform<T> handle;
+			handle.slot = findUniform(name, UniformTraits<T>::type);
+			handle.revision = linkRevision;
+			return handle;
+		}
+		// the program has to be bound
+		template <typename T>
+		void set(Uniform<T> handle, const T& value) {
+			if (!handle.valid()) {
+				return;
+			}
+			if (handle.revision != linkRevision || static_cast<std::size_t>(handle.slot) >= uniforms.size()) {
+				stats.stale++;
+				return;
+			}
+			const UniformInfo& info = uniforms[handle.slot];
+			unsigned char* cached = cache.data() + info.cacheOffset;
+			if (cacheValid[handle.slot] != 0 && std::memcmp(cached, &value, sizeof(T)) == 0) {
+				stats.skipped++;
+				return;
+			}
+			std::memcpy(cached, &value, sizeof(T));
+			cacheValid[handle.slot] = 1;
+			upload(info, &value);
+			stats.uploads++;
+		}
+		const std::vector<UniformInfo>& activeUniforms() const { return uniforms; }
+		const std::vector<AttributeInfo>& activeAttributes() const { return attributes; }
+		const std::vector<UniformBlockInfo>& activeUniformBlocks() const { return uniformBlocks; }
+		GLint attributeLocation(const char* name) const;
+		// index of the block, GL_INVALID_INDEX when the program has none by that name
+		GLuint uniformBlockIndex(const char* name) const;
+		// glsl 330 has no binding qualifier, blocks get their binding point here.
+		// false when the program has no such block
+		bool bindUniformBlock(const char* name, GLuint binding);
+		const UniformStats& uniformStats() const { return stats; }
+		void resetStats() { stats = UniformStats(); }
+	private:
+		GLuint compile(GLenum stage, const char* source);
+		void discardPending();
+		void reflect();
+		std::int32_t findUniform(const char* name, GLenum type) const;
+		void upload(const UniformInfo& info, const void* value) const;
+
+		GLuint programObject = 0;
+		GLuint pendingProgram = 0;
+		GLuint pendingShaders[2] = {};
+		std::uint32_t linkRevision = 0;
+		std::string log;
+		std::vector<UniformInfo> uniforms;
+		std::vector<AttributeInfo> attributes;
+		std::vector<UniformBlockInfo> uniformBlocks;
+		std::vector<unsigned char> cache;
+		std::vector<std::uint8_t> cacheValid;
+		UniformStats stats;
+	};
+
+}
@@ -0,0 +1,182 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// batch renderer for 2d shapes (circles, boxes, capsules, polygons, lines) -->
+
+#include "render/shape_batch.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "render/gl_state.h"
+
+namespace psix {
+
+	void ShapeBatch::init(std::size_t vertexBytes, std::size_t indexBytes) {
+		vertexStream.init(GL_ARRAY_BUFFER, vertexBytes);
+		indexStream.init(GL_ELEMENT_ARRAY_BUFFER, indexBytes);
+		format.add(0, AttributeFormat::Float2).add(1, AttributeFormat::Half2).add(2, AttributeFormat::UByte4Norm);
+		glGenVertexArrays(1, &vao);
+		glState().bindVertexArray(vao);
+		// the index stream stays bound to the vao, draws select their range by offset
+		glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexStream.buffer());
+		format.enable();
+		vertices.reserve(MAX_BATCH_VERTICES);
+		indices.reserve(MAX_BATCH_VERTICES * 3);
+	}
+
+	void ShapeBatch::destroy() {
+		if (vao == 0) {
+			return;
+		}
+		glDeleteVertexArrays(1, &vao);
+		glState().deleted(GlObject::VertexArray, vao);
+		vao = 0;
+		vertexStream.destroy();
+		indexStream.destroy();
+	}
+
+	void ShapeBatch::beginFrame() {
+		stats = ShapeBatchStats();
+		vertexStream.beginFrame();
+		indexStream.beginFrame();
+	}
+
+	void ShapeBatch::begin(CommandBucket& bucket, std::uint32_t layer, GLuint program) {
+		if (target != &bucket || targetLayer != layer || targetProgram != program) {
+			flush();
+		}
+		target = &bucket;
+		targetLayer = layer;
+		targetProgram = program;
+	}
+
+	std::uint16_t ShapeBatch::reserve(std::size_t vertexCount) {
+		// every shape goes through here, without begin() it has nowhere to go
+		assert(target != nullptr && "ShapeBatch: shape added before begin()");
+		if (vertices.size() + vertexCount > MAX_BATCH_VERTICES) {
+			flush();
+		}
+		return static_cast<std::uint16_t>(vertices.size());
+	}
+
+	void ShapeBatch::quad(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d, bool disc, std::uint32_t colour) {
+		std::uint16_t base = reserve(4);
+		// half float 1.0 and -1.0, 0 is 0 in both formats
+		const std::uint16_t plus = disc ? 0x3c00u : 0u;
+		const std::uint16_t minus = disc ? 0xbc00u : 0u;
+		vertices.push_back(ShapeVertex{ a.x, a.y, minus, minus, colour });
+		vertices.push_back(ShapeVertex{ b.x, b.y, plus, minus, colour });
+		vertices.push_back(ShapeVertex{ c.x, c.y, plus, plus, colour });
+		vertices.push_back(ShapeVertex{ d.x, d.y, minus, plus, colour });
+		const std::uint16_t quadIndices[6] = { 0, 1, 2, 2, 3, 0 };
+		for (std::uint16_t index : quadIndices) {
+			indices.push_back(static_cast<std::uint16_t>(base + index));
+		}
+	}
+
+	void ShapeBatch::circle(const Vec2& centre, float radius, std::uint32_t colour) {
+		quad(centre + Vec2(-radius, -radius), centre + Vec2(radius, -radius),
+			centre + Vec2(radius, radius), centre + Vec2(-radius, radius), true, colour);
+	}
+
+	void ShapeBatch::box(const Vec2& centre, const Vec2& halfExtents, float angle, std::uint32_t colour) {
+		Vec2 axisX = Vec2(std::cos(angle), std::sin(angle)) * halfExtents.x;
+		Vec2 axisY = perp(Vec2(std::cos(angle), std::sin(angle))) * halfExtents.y;
+		quad(centre - axisX - axisY, centre + axisX - axisY, centre + axisX + axisY, centre - axisX + axisY, false, colour);
+	}
+
+	void ShapeBatch::capsule(const Vec2& a, const Vec2& b, float radius, std::uint32_t colour) {
+		Vec2 along = b - a;
+		float segmentLength = length(along);
+		// the caps overlap the body, with alpha below 1 the overlap shows
+		if (segmentLength > 0.0f) {
+			Vec2 side = perp(along * (radius / segmentLength));
+			quad(a - side, b - side, b + side, a + side, false, colour);
+		}
+		circle(a, radius, colour);
+		circle(b, radius, colour);
+	}
+
+	void ShapeBatch::polygon(const Vec2* points, std::size_t count, std::uint32_t colour) {
+		if (count < 3 || count > MAX_BATCH_VERTICES) {
+			return;
+		}
+		std::uint16_t base = reserve(count);
+		for (std::size_t i = 0; i < count; i++) {
+			vertices.push_back(ShapeVertex{ points[i].x, points[i].y, 0, 0, colour });
+		}
+		// fan from the first point, fine for convex polygons
+		for (std::size_t i = 1; i + 1 < count; i++) {
+			indices.push_back(base);
+			indices.push_back(static_cast<std::uint16_t>(base + i));
+			indices.push_back(static_cast<std::uint16_t>(base + i + 1));
+		}
+	}
+
+	void ShapeBatch::line(const Vec2& a, const Vec2& b, float width, std::uint32_t colour) {
+		Vec2 along = b - a;
+		float segmentLength = length(along);
+		if (segmentLength <= 0.0f) {
+			return;
+		}
+		Vec2 side = perp(along * (0.5f * width / segmentLength));
+		quad(a - side, b - side, b + side, a + side, false, colour);
+	}
+
+	void ShapeBatch::bindVertices(const DrawCommand& command) {
+		const ShapeBatch* batch = static_cast<const ShapeBatch*>(command.userData);
+		const GLintptr offset = static_cast<GLintptr>(command.userValue);
+		glState().bindBuffer(GL_ARRAY_BUFFER, batch->vertexStream.buffer());
+		batch->format.apply(offset);
+		// the disc edge is antialiased through alpha
+		glState().setEnabled(GL_BLEND, true);
+		glState().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	void ShapeBatch::flush() {
+		if (target == nullptr) {
+			// shapes added without begin(), counted so the loss shows in release builds
+			stats.dropped += indices.size() / 3;
+		}
+		if (indices.empty() || target == nullptr) {
+			vertices.clear();
+			indices.clear();
+			return;
+		}
+		GLintptr vertexOffset = 0;
+		GLintptr indexOffset = 0;
+		ShapeVertex* vertexTarget = vertexStream.allocateArray<ShapeVertex>(vertices.size(), vertexOffset);
+		std::uint16_t* indexTarget = indexStream.allocateArray<std::uint16_t>(indices.size(), indexOffset);
+		if (vertexTarget == nullptr || indexTarget == nullptr) {
+			// a partial allocation is left unused until the frame ends
+			stats.dropped += indices.size() / 3;
+			vertices.clear();
+			indices.clear();
+			return;
+		}
+		std::memcpy(vertexTarget, vertices.data(), vertices.size() * sizeof(ShapeVertex));
+		std::memcpy(indexTarget, indices.data(), indices.size() * sizeof(std::uint16_t));
+		vertexStream.unmap();
+		indexStream.unmap();
+		DrawCommand& command = target->add(makeSortKey(targetLayer, targetProgram, 0, vao));
+		command.program = targetProgram;
+		command.vao = vao;
+		command.indexType = GL_UNSIGNED_SHORT;
+		command.count = static_cast<GLsizei>(indices.size());
+		command.indexOffset = indexOffset;
+		command.prepare = &ShapeBatch::bindVertices;
+		command.userData = this;
+		command.userValue = static_cast<std::uint64_t>(vertexOffset);
+		stats.vertices += vertices.size();
+		stats.indices += indices.size();
+		stats.flushes++;
+		vertices.clear();
+		indices.clear();
+	}
+
+	void ShapeBatch::endFrame() {
+		vertexStream.endFrame();
+		indexStream.endFrame();
+		target = nullptr;
+	}
+
+}
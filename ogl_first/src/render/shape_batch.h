@@ -0,0 +1,87 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// batch renderer for 2d shapes (circles, boxes, capsules, polygons, lines) -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "physics/vec2.h"
+#include "render/command_bucket.h"
+#include "render/stream_buffer.h"
+#include "render/vertex_format.h"
+
+namespace psix {
+
+	// local is the position inside a disc in [-1, 1] as half floats, solid
+	// shapes use 0 so the same fragment shader draws both. 16 bytes
+	struct ShapeVertex {
+		float x, y;
+		std::uint16_t localX, localY;
+		std::uint32_t colour;	// rgba8, see packColour
+	};
+
+	struct ShapeBatchStats {
+		std::size_t vertices = 0;
+		std::size_t indices = 0;
+		std::size_t flushes = 0;
+		std::size_t dropped = 0;	// triangles lost because the stream budget ran out or begin() was missing
+	};
+
+	// shapes are tessellated on the cpu into one vertex and index stream. a
+	// flush uploads them through the stream buffers and records one indexed draw,
+	// it happens when the 16 bit indices run out, the program changes or at
+	// the end of the frame. circles are a quad with an analytic disc in the
+	// fragment shader (shape.frag) instead of a triangle fan.
+	//
+	// per frame: beginFrame() -> begin() -> shapes... -> flush() -> submit of
+	// the bucket -> endFrame(). a shape without begin() asserts in debug builds
+	// and is counted as dropped otherwise
+
+	class ShapeBatch {
+	public:
+		static constexpr std::size_t MAX_BATCH_VERTICES = 65535;
+
+		ShapeBatch() = default;
+		~ShapeBatch() { destroy(); }
+		ShapeBatch(const ShapeBatch&) = delete;
+		ShapeBatch& operator=(const ShapeBatch&) = delete;
+		// needs a current gl context, the sizes are the budget of one frame
+		void init(std::size_t vertexBytes = 2 << 20, std::size_t indexBytes = 1 << 20);
+		void destroy();
+		void beginFrame();
+		// following shapes are drawn with the program into the bucket, a
+		// different program flushes what was batched so far
+		void begin(CommandBucket& bucket, std::uint32_t layer, GLuint program);
+		void circle(const Vec2& centre, float radius, std::uint32_t colour);
+		// angle in radians around the centre
+		void box(const Vec2& centre, const Vec2& halfExtents, float angle, std::uint32_t colour);
+		void capsule(const Vec2& a, const Vec2& b, float radius, std::uint32_t colour);
+		// convex, in either winding order
+		void polygon(const Vec2* points, std::size_t count, std::uint32_t colour);
+		void line(const Vec2& a, const Vec2& b, float width, std::uint32_t colour);
+		void flush();
+		// after the bucket holding the draws has been submitted
+		void endFrame();
+		const ShapeBatchStats& lastFrameStats() const { return stats; }
+	private:
+		// makes room for the vertices of one shape, flushing if needed
+		std::uint16_t reserve(std::size_t vertexCount);
+		void quad(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d, bool disc, std::uint32_t colour);
+		static void bindVertices(const DrawCommand& command);
+
+		GLuint vao = 0;
+		VertexFormat format;
+		StreamBuffer vertexStream;
+		StreamBuffer indexStream;
+		std::vector<ShapeVertex> vertices;
+		std::vector<std::uint16_t> indices;
+		CommandBucket* target = nullptr;
+		std::uint32_t targetLayer = 0;
+		GLuint targetProgram = 0;
+		ShapeBatchStats stats;
+	};
+
+}
@@ -0,0 +1,113 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// ring buffer for data written by the cpu every frame, guarded by fences -->
+
+#include "render/stream_buffer.h"
+#include "core/stopwatch.h"
+#include "render/gl_state.h"
+
+namespace psix {
+
+	void StreamBuffer::init(GLenum target, std::size_t regionBytes, int framesInFlight) {
+		bufferTarget = target;
+		regionSize = (regionBytes + 255) & ~static_cast<std::size_t>(255);
+		frameCount = framesInFlight < 1 ? 1 : (framesInFlight > MAX_FRAMES ? MAX_FRAMES : framesInFlight);
+		frame = 0;
+		glGenBuffers(1, &bufferObject);
+		glState().bindBuffer(GL_COPY_WRITE_BUFFER, bufferObject);
+		// allocated once, only ever written through unsynchronized maps
+		glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(regionSize * frameCount), nullptr, GL_STREAM_DRAW);
+	}
+
+	void StreamBuffer::destroy() {
+		if (bufferObject == 0) {
+			return;
+		}
+		if (mapped != nullptr) {
+			unmap();
+		}
+		for (GLsync& fence : fences) {
+			if (fence != nullptr) {
+				glDeleteSync(fence);
+				fence = nullptr;
+			}
+		}
+		glDeleteBuffers(1, &bufferObject);
+		glState().deleted(GlObject::Buffer, bufferObject);
+		bufferObject = 0;
+	}
+
+	void StreamBuffer::beginFrame() {
+		stats = StreamStats();
+		used = 0;
+		mapStart = 0;
+		GLsync& fence = fences[frame];
+		if (fence == nullptr) {
+			return;
+		}
+		// the first wait flushes so the fence is guaranteed to signal, after that
+		// poll with a 1 ms timeout
+		Stopwatch waitWatch;
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		for (;;) {
+			GLenum result = glClientWaitSync(fence, flags, 1000000);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+				break;
+			}
+			flags = 0;
+		}
+		stats.fenceWaitMs = waitWatch.elapsedMs();
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	StreamAllocation StreamBuffer::allocate(std::size_t bytes, std::size_t alignment) {
+		StreamAllocation allocation;
+		std::size_t aligned = (used + alignment - 1) & ~(alignment - 1);
+		if (bytes == 0 || aligned + bytes > regionSize) {
+			stats.failedAllocations++;
+			return allocation;
+		}
+		if (mapped == nullptr) {
+			// the rest of the region is not read by any command in flight: the
+			// fence was waited on and earlier ranges of this frame lie below used
+			const std::size_t regionBase = static_cast<std::size_t>(frame) * regionSize;
+			glState().bindBuffer(GL_COPY_WRITE_BUFFER, bufferObject);
+			void* pointer = glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(regionBase + aligned), static_cast<GLsizeiptr>(regionSize - aligned),
+				GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+			if (pointer == nullptr) {
+				stats.failedAllocations++;
+				return allocation;
+			}
+			mapped = static_cast<unsigned char*>(pointer);
+			mapStart = aligned;
+		}
+		allocation.data = mapped + (aligned - mapStart);
+		allocation.offset = static_cast<GLintptr>(static_cast<std::size_t>(frame) * regionSize + aligned);
+		allocation.size = bytes;
+		used = aligned + bytes;
+		stats.bytesWritten += bytes;
+		return allocation;
+	}
+
+	void StreamBuffer::unmap() {
+		if (mapped == nullptr) {
+			return;
+		}
+		glState().bindBuffer(GL_COPY_WRITE_BUFFER, bufferObject);
+		if (used > mapStart) {
+			glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(used - mapStart));
+		}
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		mapped = nullptr;
+	}
+
+	void StreamBuffer::endFrame() {
+		unmap();
+		if (used > 0) {
+			fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+		frame = (frame + 1) % frameCount;
+	}
+
+}
@@ -0,0 +1,81 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// ring buffer for data written by the cpu every frame, guarded by fences -->
+
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+namespace psix {
+
+	// a range handed out for this frame, data is null when the frame region is full
+
+	struct StreamAllocation {
+		void* data = nullptr;
+		GLintptr offset = 0;	// from the start of the buffer, for attribute pointers and draws
+		std::size_t size = 0;
+	};
+
+	struct StreamStats {
+		std::size_t bytesWritten = 0;
+		std::size_t failedAllocations = 0;
+		double fenceWaitMs = 0.0;	// time blocked on the gpu at the start of the frame
+	};
+
+	// the buffer storage is created once and split into one region per frame in
+	// flight. a frame maps its region unsynchronized (the fence of the frame that
+	// used it last has already been waited on), bump allocates from it and unmaps
+	// before the draws. the driver never has to synchronize or reallocate.
+	//
+	// per frame: beginFrame() -> allocate()... -> unmap() -> draws -> endFrame()
+	//
+	// mapping goes through GL_COPY_WRITE_BUFFER so it never touches the bindings
+	// of a vao, the target is the one the draws bind the buffer to
+
+	class StreamBuffer {
+	public:
+		static constexpr int MAX_FRAMES = 4;
+
+		StreamBuffer() = default;
+		~StreamBuffer() { destroy(); }
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+		// needs a current gl context, regionBytes is the budget of a single frame
+		// and framesInFlight at most MAX_FRAMES
+		void init(GLenum target, std::size_t regionBytes, int framesInFlight = 3);
+		// frees the gl objects, has to run while the context is still alive
+		void destroy();
+		// waits until the gpu is done with the region of this frame, the first
+		// allocation maps it
+		void beginFrame();
+		StreamAllocation allocate(std::size_t bytes, std::size_t alignment = 16);
+		template <typename T>
+		T* allocateArray(std::size_t count, GLintptr& offset) {
+			StreamAllocation allocation = allocate(count * sizeof(T), alignof(T) < 16 ? 16 : alignof(T));
+			offset = allocation.offset;
+			return static_cast<T*>(allocation.data);
+		}
+		// flushes the written bytes, has to happen before the draws that read them.
+		// allocating again in the same frame maps the rest of the region
+		void unmap();
+		// fences the region, the gpu commands reading it have been issued
+		void endFrame();
+		GLuint buffer() const { return bufferObject; }
+		GLenum target() const { return bufferTarget; }
+		bool isMapped() const { return mapped != nullptr; }
+		const StreamStats& lastFrameStats() const { return stats; }
+	private:
+		GLuint bufferObject = 0;
+		GLenum bufferTarget = GL_ARRAY_BUFFER;
+		std::size_t regionSize = 0;
+		int frameCount = 0;
+		int frame = 0;					// region of the current frame
+		GLsync fences[MAX_FRAMES] = {};
+		unsigned char* mapped = nullptr;
+		std::size_t used = 0;			// bytes allocated in the current region
+		std::size_t mapStart = 0;		// region offset the mapping starts at
+		StreamStats stats;
+	};
+
+}
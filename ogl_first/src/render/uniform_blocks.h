@@ -0,0 +1,42 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// std140 uniform blocks shared by the shaders and their binding points -->
+
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+namespace psix {
+
+	// fixed binding points, every program binds its blocks by name to these
+
+	constexpr GLuint FRAME_BLOCK_BINDING = 0;
+	constexpr GLuint MATERIAL_BLOCK_BINDING = 1;
+
+	constexpr const char* FRAME_BLOCK_NAME = "FrameBlock";
+	constexpr const char* MATERIAL_BLOCK_NAME = "MaterialBlock";
+
+	// the structs mirror the glsl blocks member by member. std140 rules: a vec3
+	// is aligned like a vec4 and a float may fill its last component, vec4s and
+	// matrices start on 16 bytes, a block is rounded up to 16 bytes
+
+	// layout (std140) uniform FrameBlock { vec3 offsetColor; float time; vec2 viewport; };
+	struct alignas(16) FrameBlock {
+		float offsetColor[3];
+		float time;
+		float viewport[2];
+		float padding[2];
+	};
+
+	// layout (std140) uniform MaterialBlock { vec4 tint; };
+	struct alignas(16) MaterialBlock {
+		float tint[4];
+	};
+
+	static_assert(sizeof(FrameBlock) == 32, "FrameBlock has to match the std140 layout");
+	static_assert(offsetof(FrameBlock, time) == 12, "FrameBlock has to match the std140 layout");
+	static_assert(offsetof(FrameBlock, viewport) == 16, "FrameBlock has to match the std140 layout");
+	static_assert(sizeof(MaterialBlock) == 16, "MaterialBlock has to match the std140 layout");
+
+}
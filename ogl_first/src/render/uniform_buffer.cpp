@@ -0,0 +1,97 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// uniform buffer objects, whole blocks and sub-allocated per-material ranges -->
+
+#include "render/uniform_buffer.h"
+#include <cstring>
+#include "render/gl_state.h"
+#include "render/uniform_blocks.h"
+
+namespace psix {
+
+	void UniformBuffer::init(std::size_t bytes) {
+		bufferSize = bytes;
+		glGenBuffers(1, &bufferObject);
+		glState().bindBuffer(GL_UNIFORM_BUFFER, bufferObject);
+		glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	void UniformBuffer::destroy() {
+		if (bufferObject != 0) {
+			glDeleteBuffers(1, &bufferObject);
+			glState().deleted(GlObject::Buffer, bufferObject);
+			bufferObject = 0;
+		}
+	}
+
+	void UniformBuffer::update(const void* data, std::size_t bytes, std::size_t offset) {
+		glState().bindBuffer(GL_UNIFORM_BUFFER, bufferObject);
+		if (offset == 0 && bytes == bufferSize) {
+			glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_DYNAMIC_DRAW);
+		}
+		glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes), data);
+	}
+
+	void UniformArena::init(std::size_t capacity) {
+		GLint offsetAlignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+		alignment = offsetAlignment > 0 ? static_cast<std::size_t>(offsetAlignment) : 256;
+		shadow.assign(capacity, 0);
+		used = 0;
+		dirtyBegin = 0;
+		dirtyEnd = 0;
+		glGenBuffers(1, &bufferObject);
+		glState().bindBuffer(GL_UNIFORM_BUFFER, bufferObject);
+		glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	void UniformArena::destroy() {
+		if (bufferObject != 0) {
+			glDeleteBuffers(1, &bufferObject);
+			glState().deleted(GlObject::Buffer, bufferObject);
+			bufferObject = 0;
+		}
+	}
+
+	UniformSlot UniformArena::allocate(std::size_t bytes) {
+		UniformSlot slot;
+		// the alignment is a power of two on every driver we know of, but the
+		// spec does not promise it
+		std::size_t offset = (used + alignment - 1) / alignment * alignment;
+		if (bytes == 0 || offset + bytes > shadow.size()) {
+			return slot;
+		}
+		used = offset + bytes;
+		slot.offset = static_cast<std::uint32_t>(offset);
+		slot.size = static_cast<std::uint32_t>(bytes);
+		return slot;
+	}
+
+	void UniformArena::write(const UniformSlot& slot, const void* data) {
+		std::memcpy(shadow.data() + slot.offset, data, slot.size);
+		if (dirtyBegin == dirtyEnd) {
+			dirtyBegin = slot.offset;
+			dirtyEnd = slot.offset + slot.size;
+		}
+		else {
+			dirtyBegin = slot.offset < dirtyBegin ? slot.offset : dirtyBegin;
+			dirtyEnd = slot.offset + slot.size > dirtyEnd ? slot.offset + slot.size : dirtyEnd;
+		}
+	}
+
+	void UniformArena::upload() {
+		if (dirtyBegin == dirtyEnd) {
+			return;
+		}
+		glState().bindBuffer(GL_UNIFORM_BUFFER, bufferObject);
+		glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(dirtyBegin), static_cast<GLsizeiptr>(dirtyEnd - dirtyBegin), shadow.data() + dirtyBegin);
+		dirtyBegin = 0;
+		dirtyEnd = 0;
+	}
+
+	void bindUniformBlocks(ShaderProgram& program) {
+		program.bindUniformBlock(FRAME_BLOCK_NAME, FRAME_BLOCK_BINDING);
+		program.bindUniformBlock(MATERIAL_BLOCK_NAME, MATERIAL_BLOCK_BINDING);
+	}
+
+}
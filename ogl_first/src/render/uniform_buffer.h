@@ -0,0 +1,89 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// uniform buffer objects, whole blocks and sub-allocated per-material ranges -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "render/gl_state.h"
+#include "render/shader_program.h"
+
+namespace psix {
+
+	// one buffer holding a single block, e.g. the per-frame values. a full
+	// update orphans the storage so it never waits for the last frame's draws
+
+	class UniformBuffer {
+	public:
+		UniformBuffer() = default;
+		~UniformBuffer() { destroy(); }
+		UniformBuffer(const UniformBuffer&) = delete;
+		UniformBuffer& operator=(const UniformBuffer&) = delete;
+		// needs a current gl context
+		void init(std::size_t bytes);
+		// frees the buffer, has to run while the context is still alive
+		void destroy();
+		void update(const void* data, std::size_t bytes, std::size_t offset = 0);
+		template <typename T>
+		void update(const T& block) { update(&block, sizeof(T)); }
+		void bindBase(GLuint binding) const { glState().bindBufferBase(GL_UNIFORM_BUFFER, binding, bufferObject); }
+		GLuint buffer() const { return bufferObject; }
+		std::size_t size() const { return bufferSize; }
+	private:
+		GLuint bufferObject = 0;
+		std::size_t bufferSize = 0;
+	};
+
+	// a range of a UniformArena, offsets respect GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+	struct UniformSlot {
+		std::uint32_t offset = 0;
+		std::uint32_t size = 0;
+	};
+
+	// many small blocks (one per material) in one big buffer. writes go to a
+	// cpu copy, upload() sends the changed span with a single call and every
+	// draw selects its block with glBindBufferRange
+
+	class UniformArena {
+	public:
+		UniformArena() = default;
+		~UniformArena() { destroy(); }
+		UniformArena(const UniformArena&) = delete;
+		UniformArena& operator=(const UniformArena&) = delete;
+		// needs a current gl context
+		void init(std::size_t capacity);
+		void destroy();
+		// a slot of size 0 when the arena is full
+		UniformSlot allocate(std::size_t bytes);
+		void write(const UniformSlot& slot, const void* data);
+		template <typename T>
+		UniformSlot add(const T& block) {
+			UniformSlot slot = allocate(sizeof(T));
+			if (slot.size != 0) {
+				write(slot, &block);
+			}
+			return slot;
+		}
+		// sends everything written since the last upload
+		void upload();
+		void bind(GLuint binding, const UniformSlot& slot) const {
+			glState().bindBufferRange(GL_UNIFORM_BUFFER, binding, bufferObject, slot.offset, slot.size);
+		}
+		GLuint buffer() const { return bufferObject; }
+		std::size_t bytesUsed() const { return used; }
+	private:
+		GLuint bufferObject = 0;
+		std::size_t alignment = 256;
+		std::size_t used = 0;
+		std::vector<unsigned char> shadow;
+		std::size_t dirtyBegin = 0;
+		std::size_t dirtyEnd = 0;
+	};
+
+	// binds the blocks of the program that it knows by name to the fixed binding points
+	void bindUniformBlocks(ShaderProgram& program);
+
+}
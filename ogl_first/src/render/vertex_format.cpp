@@ -0,0 +1,198 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// compact vertex formats (half floats, normalized bytes, 10:10:10:2) and converters -->
+
+#include "render/vertex_format.h"
+#include <cmath>
+#include <cstring>
+
+namespace psix {
+
+	namespace {
+
+		struct FormatInfo {
+			GLint components;
+			GLenum type;
+			GLboolean normalized;
+			std::uint32_t size;
+		};
+
+		FormatInfo formatInfo(AttributeFormat format) {
+			switch (format) {
+			case AttributeFormat::Float1: return FormatInfo{ 1, GL_FLOAT, GL_FALSE, 4 };
+			case AttributeFormat::Float2: return FormatInfo{ 2, GL_FLOAT, GL_FALSE, 8 };
+			case AttributeFormat::Float3: return FormatInfo{ 3, GL_FLOAT, GL_FALSE, 12 };
+			case AttributeFormat::Float4: return FormatInfo{ 4, GL_FLOAT, GL_FALSE, 16 };
+			case AttributeFormat::Half2: return FormatInfo{ 2, GL_HALF_FLOAT, GL_FALSE, 4 };
+			case AttributeFormat::Half4: return FormatInfo{ 4, GL_HALF_FLOAT, GL_FALSE, 8 };
+			case AttributeFormat::UByte4Norm: return FormatInfo{ 4, GL_UNSIGNED_BYTE, GL_TRUE, 4 };
+			case AttributeFormat::Byte4Norm: return FormatInfo{ 4, GL_BYTE, GL_TRUE, 4 };
+			case AttributeFormat::Int1010102Norm: return FormatInfo{ 4, GL_INT_2_10_10_10_REV, GL_TRUE, 4 };
+			}
+			return FormatInfo{ 1, GL_FLOAT, GL_FALSE, 4 };
+		}
+
+		float clampUnit(float value, float low) {
+			return value < low ? low : (value > 1.0f ? 1.0f : value);
+		}
+
+		std::uint32_t snorm(float value, float scale, std::uint32_t mask) {
+			std::int32_t scaled = static_cast<std::int32_t>(std::lround(clampUnit(value, -1.0f) * scale));
+			return static_cast<std::uint32_t>(scaled) & mask;
+		}
+
+	}
+
+	std::uint16_t floatToHalf(float value) {
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		const std::uint32_t sign = (bits >> 16) & 0x8000u;
+		const std::uint32_t exponent = (bits >> 23) & 0xffu;
+		std::uint32_t mantissa = bits & 0x7fffffu;
+		if (exponent == 0xffu) {
+			// infinity stays infinity, nan keeps a mantissa bit set
+			return static_cast<std::uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0u));
+		}
+		const std::int32_t halfExponent = static_cast<std::int32_t>(exponent) - 127 + 15;
+		if (halfExponent >= 31) {
+			return static_cast<std::uint16_t>(sign | 0x7c00u);
+		}
+		if (halfExponent <= 0) {
+			// subnormal half or zero
+			if (halfExponent < -10) {
+				return static_cast<std::uint16_t>(sign);
+			}
+			mantissa |= 0x800000u;
+			const std::uint32_t shift = static_cast<std::uint32_t>(14 - halfExponent);
+			std::uint32_t half = mantissa >> shift;
+			const std::uint32_t remainder = mantissa & ((1u << shift) - 1u);
+			const std::uint32_t halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (half & 1u) != 0)) {
+				half++;
+			}
+			return static_cast<std::uint16_t>(sign | half);
+		}
+		std::uint32_t half = (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+		const std::uint32_t remainder = mantissa & 0x1fffu;
+		// a carry out of the mantissa correctly bumps the exponent, up to infinity
+		if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0)) {
+			half++;
+		}
+		return static_cast<std::uint16_t>(sign | half);
+	}
+
+	float halfToFloat(std::uint16_t half) {
+		const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+		std::uint32_t exponent = (half >> 10) & 0x1fu;
+		std::uint32_t mantissa = half & 0x3ffu;
+		std::uint32_t bits;
+		if (exponent == 0x1fu) {
+			bits = sign | 0x7f800000u | (mantissa << 13);
+		}
+		else if (exponent != 0) {
+			bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		}
+		else if (mantissa == 0) {
+			bits = sign;
+		}
+		else {
+			// normalize the subnormal
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400u) == 0) {
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+		}
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	std::uint32_t packUnorm4x8(float x, float y, float z, float w) {
+		auto channel = [](float value) {
+			return static_cast<std::uint32_t>(clampUnit(value, 0.0f) * 255.0f + 0.5f);
+		};
+		return channel(x) | (channel(y) << 8) | (channel(z) << 16) | (channel(w) << 24);
+	}
+
+	std::uint32_t packSnorm4x8(float x, float y, float z, float w) {
+		return snorm(x, 127.0f, 0xffu) | (snorm(y, 127.0f, 0xffu) << 8) | (snorm(z, 127.0f, 0xffu) << 16) | (snorm(w, 127.0f, 0xffu) << 24);
+	}
+
+	std::uint32_t packSnorm1010102(float x, float y, float z, float w) {
+		return snorm(x, 511.0f, 0x3ffu) | (snorm(y, 511.0f, 0x3ffu) << 10) | (snorm(z, 511.0f, 0x3ffu) << 20) | (snorm(w, 1.0f, 0x3u) << 30);
+	}
+
+	std::uint32_t attributeSize(AttributeFormat format) {
+		return formatInfo(format).size;
+	}
+
+	VertexFormat& VertexFormat::add(GLuint location, AttributeFormat format) {
+		if (count < MAX_ATTRIBUTES) {
+			attributes[count++] = VertexAttribute{ location, format, vertexStride };
+			vertexStride += attributeSize(format);
+		}
+		return *this;
+	}
+
+	void VertexFormat::enable() const {
+		for (int i = 0; i < count; i++) {
+			glEnableVertexAttribArray(attributes[i].location);
+		}
+	}
+
+	void VertexFormat::apply(GLintptr offset) const {
+		for (int i = 0; i < count; i++) {
+			const VertexAttribute& attribute = attributes[i];
+			FormatInfo info = formatInfo(attribute.format);
+			glVertexAttribPointer(attribute.location, info.components, info.type, info.normalized,
+				static_cast<GLsizei>(vertexStride), (void*)(offset + attribute.offset));
+		}
+	}
+
+	void VertexFormat::packVertices(const SourceAttribute* sources, std::size_t vertexCount, void* out) const {
+		unsigned char* vertex = static_cast<unsigned char*>(out);
+		for (std::size_t v = 0; v < vertexCount; v++, vertex += vertexStride) {
+			for (int i = 0; i < count; i++) {
+				const float* in = sources[i].data + v * sources[i].stride;
+				unsigned char* target = vertex + attributes[i].offset;
+				const AttributeFormat format = attributes[i].format;
+				switch (format) {
+				case AttributeFormat::Float1:
+				case AttributeFormat::Float2:
+				case AttributeFormat::Float3:
+				case AttributeFormat::Float4:
+					std::memcpy(target, in, attributeSize(format));
+					break;
+				case AttributeFormat::Half2:
+				case AttributeFormat::Half4: {
+					std::uint16_t halves[4];
+					const int components = format == AttributeFormat::Half2 ? 2 : 4;
+					for (int c = 0; c < components; c++) {
+						halves[c] = floatToHalf(in[c]);
+					}
+					std::memcpy(target, halves, components * sizeof(std::uint16_t));
+					break;
+				}
+				case AttributeFormat::UByte4Norm: {
+					std::uint32_t packed = packUnorm4x8(in[0], in[1], in[2], in[3]);
+					std::memcpy(target, &packed, sizeof(packed));
+					break;
+				}
+				case AttributeFormat::Byte4Norm: {
+					std::uint32_t packed = packSnorm4x8(in[0], in[1], in[2], in[3]);
+					std::memcpy(target, &packed, sizeof(packed));
+					break;
+				}
+				case AttributeFormat::Int1010102Norm: {
+					std::uint32_t packed = packSnorm1010102(in[0], in[1], in[2], in[3]);
+					std::memcpy(target, &packed, sizeof(packed));
+					break;
+				}
+				}
+			}
+		}
+	}
+
+}
@@ -0,0 +1,77 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// compact vertex formats (half floats, normalized bytes, 10:10:10:2) and converters -->
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+
+namespace psix {
+
+	enum class AttributeFormat : std::uint8_t {
+		Float1,
+		Float2,
+		Float3,
+		Float4,
+		Half2,			// GL_HALF_FLOAT, 4 bytes
+		Half4,			// GL_HALF_FLOAT, 8 bytes
+		UByte4Norm,		// colours, 0..255 read as 0..1
+		Byte4Norm,		// -127..127 read as -1..1
+		Int1010102Norm	// normals, signed 10 bits per xyz and 2 bits of w
+	};
+
+	struct VertexAttribute {
+		GLuint location;
+		AttributeFormat format;
+		std::uint32_t offset;
+	};
+
+	// ieee 754 binary16, rounded to nearest even, out of range values become infinity
+	std::uint16_t floatToHalf(float value);
+	float halfToFloat(std::uint16_t half);
+	// red in the lowest byte, matches GL_UNSIGNED_BYTE with 4 components
+	std::uint32_t packUnorm4x8(float x, float y, float z, float w);
+	std::uint32_t packSnorm4x8(float x, float y, float z, float w);
+	// x in the lowest 10 bits, matches GL_INT_2_10_10_10_REV
+	std::uint32_t packSnorm1010102(float x, float y, float z, float w = 0.0f);
+
+	inline std::uint32_t packColour(float red, float green, float blue, float alpha = 1.0f) {
+		return packUnorm4x8(red, green, blue, alpha);
+	}
+
+	// full precision input for packVertices, component i of vertex v is read
+	// from data[v * stride + i]
+	struct SourceAttribute {
+		const float* data;
+		std::size_t stride;		// in floats
+	};
+
+	// the attributes of one interleaved vertex buffer, offsets are assigned in
+	// the order the attributes are added and kept 4 byte aligned
+
+	class VertexFormat {
+	public:
+		static constexpr int MAX_ATTRIBUTES = 8;
+
+		VertexFormat& add(GLuint location, AttributeFormat format);
+		std::uint32_t stride() const { return vertexStride; }
+		int attributeCount() const { return count; }
+		const VertexAttribute& attribute(int index) const { return attributes[index]; }
+		// enables the attributes on the bound vao
+		void enable() const;
+		// points the attributes at the vertices that start at offset in the bound array buffer
+		void apply(GLintptr offset = 0) const;
+		// converts count vertices, source i feeds attribute i, out needs stride() * count bytes
+		void packVertices(const SourceAttribute* sources, std::size_t vertexCount, void* out) const;
+	private:
+		VertexAttribute attributes[MAX_ATTRIBUTES];
+		int count = 0;
+		std::uint32_t vertexStride = 0;
+	};
+
+	// bytes one attribute of the format takes
+	std::uint32_t attributeSize(AttributeFormat format);
+
+}
@@ -0,0 +1,12 @@
+// uniform blocks shared by every program, bound to the fixed binding points
+// of uniform_blocks.h (the layouts there have to match)
+layout (std140) uniform FrameBlock
+{
+	vec3 offsetColor;
+	float time;
+	vec2 viewport;
+};
+layout (std140) uniform MaterialBlock
+{
+	vec4 tint;
+};
\ No newline at end of file
@@ -1,9 +1,9 @@
 #version 330 core
+#include "blocks.glsl"
 in vec3 vertexColor;
 out vec4 FragColor;
-uniform vec3 ofstclr;
 
 void main()
 {
-	FragColor = vec4(vertexColor + ofstclr, 1.0);
+	FragColor = vec4((vertexColor + offsetColor) * tint.rgb, tint.a);
 }
\ No newline at end of file
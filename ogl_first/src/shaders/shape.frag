@@ -0,0 +1,17 @@
+#version 330 core
+in vec2 local;
+in vec4 shapeColor;
+out vec4 FragColor;
+
+// circles are quads with local running from -1 to 1, the disc is cut out
+// here with a one pixel wide smooth edge. solid shapes have local = 0
+void main()
+{
+	float radius = length(local);
+	float edge = max(fwidth(radius), 0.0001);
+	float coverage = 1.0 - smoothstep(1.0 - edge, 1.0, radius);
+	if (coverage <= 0.0) {
+		discard;
+	}
+	FragColor = vec4(shapeColor.rgb, shapeColor.a * coverage);
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aLocal;
+layout (location = 2) in vec4 aColor;
+out vec2 local;
+out vec4 shapeColor;
+void main()
+{
+	gl_Position = vec4(aPos, 0.0, 1.0);
+	local = aLocal;
+	shapeColor = aColor;
+}
\ No newline at end of file
@@ -1,10 +1,27 @@
 #version 330 core
+// variants, set through ShaderDefines:
+// INSTANCED      per instance offset, scale and colour from locations 2 and 3
+// VERTEX_COLOUR  the mesh colour at location 1 is multiplied in
 layout (location = 0) in vec3 aPos;
+#ifdef VERTEX_COLOUR
 layout (location = 1) in vec3 aColor;
+#endif
+#ifdef INSTANCED
+// per instance: xy is the offset, z the scale
+layout (location = 2) in vec3 aInstance;
+layout (location = 3) in vec3 aInstanceColor;
+#endif
 out vec3 vertexColor;
-uniform float positionModifier;
 void main() 
 {
-	gl_Position = vec4(aPos.x + positionModifier, aPos.y, aPos.z, 1.0);	
-	vertexColor = vec3(positionModifier, aPos.x, aPos.y);
-}
+#ifdef INSTANCED
+	gl_Position = vec4(aPos.xy * aInstance.z + aInstance.xy, aPos.z, 1.0);
+	vertexColor = aInstanceColor;
+#else
+	gl_Position = vec4(aPos, 1.0);
+	vertexColor = vec3(1.0);
+#endif
+#ifdef VERTEX_COLOUR
+	vertexColor *= aColor;
+#endif
+}
\ No newline at end of file
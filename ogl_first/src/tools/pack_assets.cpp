@@ -0,0 +1,142 @@
+// Github Repo: https://github.com/titan3755/psix-gl
+// Author: titan3755
+// build step that packs asset files into one blob with a hashed table of contents -->
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "core/hash.h"
+
+// usage: psix_pack_assets <output.inc> <root directory> <file or directory>...
+//
+// writes a c++ include for core/asset_pack.h. the names in the table are the
+// paths relative to the root with '/' separators, directories are packed
+// recursively. the output is only rewritten when it changes, so an unchanged
+// pack does not trigger a rebuild
+
+namespace {
+
+	struct PackedFile {
+		std::string name;
+		std::uint64_t hash = 0;
+		std::string data;
+		std::size_t offset = 0;
+	};
+
+	// every asset starts 16 byte aligned and is followed by a 0, text assets
+	// can be used as c strings
+	constexpr std::size_t ASSET_ALIGNMENT = 16;
+
+	bool readFile(const std::filesystem::path& path, std::string& data) {
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream.is_open()) {
+			return false;
+		}
+		std::ostringstream contents;
+		contents << stream.rdbuf();
+		data = contents.str();
+		return true;
+	}
+
+	bool addFile(const std::filesystem::path& root, const std::filesystem::path& path, std::vector<PackedFile>& files) {
+		PackedFile file;
+		file.name = std::filesystem::relative(path, root).generic_string();
+		if (!readFile(path, file.data)) {
+			std::fprintf(stderr, "pack_assets: can not read %s\n", path.string().c_str());
+			return false;
+		}
+		file.hash = psix::hashString(file.name);
+		files.push_back(file);
+		return true;
+	}
+
+	std::string generate(const std::vector<PackedFile>& files, std::size_t blobSize) {
+		std::ostringstream out;
+		out << "// generated by psix_pack_assets, do not edit -->\n";
+		out << "// " << files.size() << " assets, " << blobSize << " bytes\n\n";
+		out << "namespace psix {\n\n\tnamespace embedded {\n\n";
+		out << "\t\tinline constexpr std::size_t ASSET_COUNT = " << files.size() << ";\n\n";
+		out << "\t\talignas(" << ASSET_ALIGNMENT << ") inline constexpr unsigned char BLOB[] = {";
+		std::vector<unsigned char> blob(blobSize > 0 ? blobSize : 1, 0);
+		for (const PackedFile& file : files) {
+			std::copy(file.data.begin(), file.data.end(), blob.begin() + static_cast<std::ptrdiff_t>(file.offset));
+		}
+		for (std::size_t i = 0; i < blob.size(); i++) {
+			out << (i % 16 == 0 ? "\n\t\t\t" : " ") << static_cast<unsigned>(blob[i]) << ",";
+		}
+		out << "\n\t\t};\n\n";
+		// sorted by hash for the binary search, an empty pack keeps one unused entry
+		out << "\t\tinline constexpr AssetEntry TOC[] = {\n";
+		for (const PackedFile& file : files) {
+			char hash[32];
+			std::snprintf(hash, sizeof(hash), "0x%016llxull", static_cast<unsigned long long>(file.hash));
+			out << "\t\t\t{ " << hash << ", " << file.offset << ", " << file.data.size() << ", \"" << file.name << "\" },\n";
+		}
+		if (files.empty()) {
+			out << "\t\t\t{ 0, 0, 0, \"\" },\n";
+		}
+		out << "\t\t};\n\n\t}\n\n}\n";
+		return out.str();
+	}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::fprintf(stderr, "usage: psix_pack_assets <output.inc> <root directory> <file or directory>...\n");
+		return 1;
+	}
+	const std::filesystem::path output(argv[1]);
+	const std::filesystem::path root(argv[2]);
+	std::vector<PackedFile> files;
+	for (int i = 3; i < argc; i++) {
+		std::filesystem::path path(argv[i]);
+		if (std::filesystem::is_directory(path)) {
+			std::vector<std::filesystem::path> found;
+			for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(path)) {
+				if (entry.is_regular_file()) {
+					found.push_back(entry.path());
+				}
+			}
+			// directory order differs between file systems, the pack must not
+			std::sort(found.begin(), found.end());
+			for (const std::filesystem::path& file : found) {
+				if (!addFile(root, file, files)) {
+					return 1;
+				}
+			}
+		}
+		else if (!addFile(root, path, files)) {
+			return 1;
+		}
+	}
+	std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) { return a.hash < b.hash; });
+	std::size_t blobSize = 0;
+	for (std::size_t i = 0; i < files.size(); i++) {
+		if (i > 0 && files[i].hash == files[i - 1].hash) {
+			std::fprintf(stderr, "pack_assets: %s and %s have the same hash, rename one\n", files[i - 1].name.c_str(), files[i].name.c_str());
+			return 1;
+		}
+		files[i].offset = blobSize;
+		blobSize += files[i].data.size() + 1;
+		blobSize = (blobSize + ASSET_ALIGNMENT - 1) / ASSET_ALIGNMENT * ASSET_ALIGNMENT;
+	}
+	std::string generated = generate(files, blobSize);
+	std::string existing;
+	if (readFile(output, existing) && existing == generated) {
+		return 0;
+	}
+	std::filesystem::create_directories(output.parent_path());
+	std::ofstream stream(output, std::ios::binary | std::ios::trunc);
+	stream << generated;
+	if (!stream) {
+		std::fprintf(stderr, "pack_assets: can not write %s\n", output.string().c_str());
+		return 1;
+	}
+	std::printf("pack_assets: %zu assets, %zu bytes -> %s\n", files.size(), blobSize, output.string().c_str());
+	return 0;
+}